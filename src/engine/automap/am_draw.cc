@@ -51,6 +51,41 @@ extern cvar::BoolVar am_fulldraw;
 extern cvar::BoolVar am_ssect;
 extern cvar::BoolVar r_texturecombiner;
 
+extern dword statdrawcalls;
+
+//
+// LINE AND TRIANGLE BATCHING
+//
+// Lines and thing markers are collected and drawn with one call each,
+// flushed before anything else is drawn over them.
+//
+// The linedefs themselves are kept in a buffer that is built once per
+// level, two vertices per line. Each frame only checks which lines had
+// their flags or special changed, so only lines that were just seen or
+// triggered get recolored.
+//
+
+typedef struct {
+    int         flags;
+    short       special;
+    rcolor      color;
+} amlinestate_t;
+
+static amlinestate_t    *amlinestate = NULL;
+static vtx_t            *amlinevtx = NULL;
+static dword            *amlineindices = NULL;
+static int              amnumlines = 0;
+static int              amnumindices = 0;
+static int              amlinemode = -1;
+static rbuffer          amlinebuffer = 0;
+
+static vtx_t            *amlinebatch = NULL;
+static int              amnumbatchlines = 0;
+static int              ammaxbatchlines = 0;
+
+static int              amnumtris = 0;
+static dboolean         amtrisolid = false;
+
 //
 // AM_BeginDraw
 //
@@ -90,6 +125,8 @@ void AM_BeginDraw(angle_t view, fixed_t x, fixed_t y) {
 //
 
 void AM_EndDraw(void) {
+    AM_FlushDraw();
+
     dglPopMatrix();
     dglDepthRange(0.0f, 1.0f);
 
@@ -114,15 +151,14 @@ static dboolean DL_ProcessAutomap(vtxlist_t* vl, int* drawcount) {
     fixed_t ty;
     vtx_t *v;
     int j;
-    int count;
     subsector_t* sub;
 
     sub     = (subsector_t*)vl->data;
     leaf    = &leafs[sub->leaf];
-    count   = *drawcount;
+    v       = dglBatchVertex(sub->numleafs);
 
     for(j = 0; j < sub->numleafs - 2; j++) {
-        dglTriangle(count, count + 1 + j, count + 2 + j);
+        dglTriangle(0, 1 + j, 2 + j);
     }
 
     tx = (leaf->vertex->x >> 6) & ~(FRACUNIT - 1);
@@ -165,8 +201,6 @@ static dboolean DL_ProcessAutomap(vtxlist_t* vl, int* drawcount) {
         color -= D_RGBA(0, 0, 0, 0xBF);
     }
 
-    v = &drawVertex[count];
-
     dglSetVertexColor(v, color, sub->numleafs);
 
     //
@@ -183,11 +217,9 @@ static dboolean DL_ProcessAutomap(vtxlist_t* vl, int* drawcount) {
 
         v[j].tu = F2D3D((vertex->x >> 6) - tx);
         v[j].tv = -F2D3D((vertex->y >> 6) - ty);
-
-        count++;
     }
 
-    *drawcount = count;
+    *drawcount += sub->numleafs;
 
     return true;
 }
@@ -274,30 +306,245 @@ void AM_DrawLeafs(float scale) {
     DL_ProcessDrawList(DLT_AMAP, DL_ProcessAutomap);
 }
 
+//
+// AM_FlushLines
+//
+
+static void AM_FlushLines(void) {
+    if(!amnumbatchlines) {
+        return;
+    }
+
+    dglDisable(GL_TEXTURE_2D);
+    dglSetVertex(amlinebatch);
+    dglDrawArrays(GL_LINES, 0, amnumbatchlines * 2);
+    dglEnable(GL_TEXTURE_2D);
+
+    if(devparm) {
+        statdrawcalls++;
+    }
+
+    amnumbatchlines = 0;
+}
+
+//
+// AM_FlushTriangles
+//
+
+static void AM_FlushTriangles(void) {
+    if(!amnumtris) {
+        return;
+    }
+
+    if(r_fillmode) {
+        dglPolygonMode(GL_FRONT_AND_BACK, (amtrisolid == 1) ? GL_LINE : GL_FILL);
+    }
+
+    dglDisable(GL_TEXTURE_2D);
+    dglEndBatch();
+    dglEnable(GL_TEXTURE_2D);
+
+    if(r_fillmode) {
+        dglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
+
+    amnumtris = 0;
+}
+
+//
+// AM_FlushDraw
+// Draws any lines and triangles that are still batched
+//
+
+void AM_FlushDraw(void) {
+    AM_FlushLines();
+    AM_FlushTriangles();
+}
+
+//
+// AM_BuildMapLines
+//
+
+static void AM_BuildMapLines(void) {
+    vtx_t *v;
+    int i;
+
+    //
+    // freeing the level clears these pointers,
+    // which is what makes the next level build again
+    //
+    amlinestate = (amlinestate_t*)Z_Calloc(numlines * sizeof(amlinestate_t), PU_LEVEL, &amlinestate);
+    amlinevtx = (vtx_t*)Z_Calloc(numlines * 2 * sizeof(vtx_t), PU_LEVEL, &amlinevtx);
+    amlineindices = (dword*)Z_Calloc(numlines * 2 * sizeof(dword), PU_LEVEL, &amlineindices);
+
+    amnumlines = numlines;
+    amnumindices = 0;
+    amlinemode = -1;
+
+    for(i = 0; i < numlines; i++) {
+        v = &amlinevtx[i * 2];
+
+        v[0].x = F2D3D(lines[i].v1->x);
+        v[0].y = F2D3D(lines[i].v1->y);
+        v[1].x = F2D3D(lines[i].v2->x);
+        v[1].y = F2D3D(lines[i].v2->y);
+    }
+
+    if(GLAD_GL_ARB_vertex_buffer_object) {
+        if(!amlinebuffer) {
+            dglGenBuffersARB(1, &amlinebuffer);
+        }
+
+        dglBindBufferARB(GL_ARRAY_BUFFER_ARB, amlinebuffer);
+        dglBufferDataARB(GL_ARRAY_BUFFER_ARB, numlines * 2 * sizeof(vtx_t),
+                         amlinevtx, GL_DYNAMIC_DRAW_ARB);
+        dglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    }
+}
+
+//
+// AM_UpdateMapLines
+// Recolors lines whose state changed. mode holds whatever else
+// the colors depend on, all lines are checked again when it changes.
+//
+
+static void AM_UpdateMapLines(int mode, rcolor (*linecolor)(line_t*)) {
+    amlinestate_t *state;
+    line_t *l;
+    rcolor color;
+    dboolean all;
+    int first;
+    int last;
+    int i;
+
+    all = (mode != amlinemode);
+    amlinemode = mode;
+
+    first = amnumlines;
+    last = -1;
+
+    for(i = 0; i < amnumlines; i++) {
+        l = &lines[i];
+        state = &amlinestate[i];
+
+        if(!all && state->flags == l->flags && state->special == l->special) {
+            continue;
+        }
+
+        state->flags = l->flags;
+        state->special = l->special;
+
+        color = linecolor(l);
+
+        if(color == state->color) {
+            continue;
+        }
+
+        state->color = color;
+        dglSetVertexColor(&amlinevtx[i * 2], color, 2);
+
+        first = MIN(first, i);
+        last = MAX(last, i);
+    }
+
+    if(last < first) {
+        return;
+    }
+
+    if(amlinebuffer) {
+        dglBindBufferARB(GL_ARRAY_BUFFER_ARB, amlinebuffer);
+        dglBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first * 2 * sizeof(vtx_t),
+                            (last - first + 1) * 2 * sizeof(vtx_t), &amlinevtx[first * 2]);
+        dglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    }
+
+    //
+    // lines that aren't drawn have no color
+    //
+    amnumindices = 0;
+
+    for(i = 0; i < amnumlines; i++) {
+        if(amlinestate[i].color) {
+            amlineindices[amnumindices++] = i * 2;
+            amlineindices[amnumindices++] = i * 2 + 1;
+        }
+    }
+}
+
+//
+// AM_DrawMapLines
+// linecolor returns 0 for lines that aren't drawn
+//
+
+void AM_DrawMapLines(float scale, int mode, rcolor (*linecolor)(line_t*)) {
+    if(amlinevtx == NULL) {
+        if(!numlines) {
+            return;
+        }
+
+        AM_BuildMapLines();
+    }
+
+    AM_UpdateMapLines(mode, linecolor);
+
+    if(!amnumindices) {
+        return;
+    }
+
+    AM_FlushDraw();
+
+    dglPushMatrix();
+    dglTranslatef(0, 0, -(scale*2));
+    dglDisable(GL_TEXTURE_2D);
+
+    if(amlinebuffer) {
+        dglSetVertexBuffer(amlinebuffer);
+    }
+    else {
+        dglSetVertex(amlinevtx);
+    }
+
+    dglDrawRangeElements(GL_LINES, 0, amnumlines * 2 - 1, amnumindices,
+                         GL_UNSIGNED_INT, amlineindices);
+
+    if(amlinebuffer) {
+        dglSetVertexBuffer(0);
+    }
+
+    dglEnable(GL_TEXTURE_2D);
+    dglPopMatrix();
+
+    if(devparm) {
+        statdrawcalls++;
+    }
+}
+
 //
 // AM_DrawLine
 //
 
 void AM_DrawLine(int x1, int x2, int y1, int y2, float scale, rcolor c) {
-    vtx_t v[2];
+    vtx_t *v;
+
+    AM_FlushTriangles();
+
+    if(amnumbatchlines == ammaxbatchlines) {
+        ammaxbatchlines = MAX(ammaxbatchlines * 2, 256);
+        amlinebatch = (vtx_t*)Z_Realloc(amlinebatch, ammaxbatchlines * 2 * sizeof(vtx_t), PU_STATIC, NULL);
+    }
+
+    v = &amlinebatch[amnumbatchlines * 2];
 
     v[0].x = F2D3D(x1);
-    v[0].z = F2D3D(y1);
+    v[0].y = F2D3D(y1);
     v[1].x = F2D3D(x2);
-    v[1].z = F2D3D(y2);
+    v[1].y = F2D3D(y2);
 
-    v[0].y = v[1].y = (scale*2);
+    v[0].z = v[1].z = -(scale*2);
 
     dglSetVertexColor(v, c, 2);
 
-    dglDisable(GL_TEXTURE_2D);
-    dglBegin(GL_LINES);
-    dglColor4ub(v[0].r, v[0].g, v[0].b, v[0].a);
-    dglVertex3f(v[0].x, v[0].z, -v[0].y);
-    dglColor4ub(v[1].r, v[1].g, v[1].b, v[1].a);
-    dglVertex3f(v[1].x, v[1].z, -v[1].y);
-    dglEnd();
-    dglEnable(GL_TEXTURE_2D);
+    amnumbatchlines++;
 }
 
 //
@@ -306,6 +553,7 @@ void AM_DrawLine(int x1, int x2, int y1, int y2, float scale, rcolor c) {
 
 void AM_DrawTriangle(mobj_t* mobj, float scale, dboolean solid, byte r, byte g, byte b) {
     vtx_t tri[3];
+    vtx_t *v;
     fixed_t x;
     fixed_t y;
     angle_t angle;
@@ -343,19 +591,27 @@ void AM_DrawTriangle(mobj_t* mobj, float scale, dboolean solid, byte r, byte g,
         return;
     }
 
-    if(r_fillmode) {
-        dglPolygonMode(GL_FRONT_AND_BACK, (solid == 1) ? GL_LINE : GL_FILL);
+    AM_FlushLines();
+
+    //
+    // the polygon mode is set for the whole batch
+    //
+    if(amnumtris && amtrisolid != solid) {
+        AM_FlushTriangles();
+    }
+
+    if(!amnumtris) {
+        dglBeginBatch();
+        amtrisolid = solid;
     }
 
-    dglSetVertex(tri);
+    v = dglBatchVertex(3);
+    v[0] = tri[0];
+    v[1] = tri[1];
+    v[2] = tri[2];
     dglTriangle(0, 1, 2);
-    dglDisable(GL_TEXTURE_2D);
-    dglDrawGeometry(3, tri);
-    dglEnable(GL_TEXTURE_2D);
 
-    if(r_fillmode) {
-        dglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    }
+    amnumtris++;
 
     if(devparm) {
         vertCount += 3;
@@ -400,6 +656,11 @@ void AM_DrawSprite(mobj_t* thing, float scale) {
         return;
     }
     else {
+        //
+        // sprites go over whatever was batched before them
+        //
+        AM_FlushDraw();
+
         //
         // setup sprite data
         //
@@ -737,89 +737,103 @@ static void AM_DrawNodes(void) {
 }
 
 //
-// AM_DrawWalls
-// Determines visible lines, draws them.
-// This is LineDef based, not LineSeg based.
+// AM_LineColor
+// Returns 0 if the line isn't drawn
 //
 
-void AM_DrawWalls(void) {
-    int i;
-    int x1, x2, y1, y2;
-
-    for(i = 0; i < numlines; i++) {
-        line_t *l;
+static rcolor AM_LineColor(line_t *l) {
+    //
+    // 20120208 villsa - re-ordered flag checks to match original game
+    //
 
-        l = &lines[i];
+    if(l->flags & ML_DONTDRAW) {
+        return 0;
+    }
 
-        x1 = l->v1->x;
-        y1 = l->v1->y;
-        x2 = l->v2->x;
-        y2 = l->v2->y;
+    if((l->flags & ML_MAPPED) || *am_fulldraw || plr->powers[pw_allmap] || amCheating) {
+        rcolor color = D_RGBA(0x8A, 0x5C, 0x30, 0xFF);  // default color
 
         //
-        // 20120208 villsa - re-ordered flag checks to match original game
+        // check for cheats
         //
-
-        if(l->flags & ML_DONTDRAW) {
-            continue;
+        if((plr->powers[pw_allmap] || amCheating) && !(l->flags & ML_MAPPED)) {
+            color = D_RGBA(0x80, 0x80, 0x80, 0xFF);
         }
-
-        if((l->flags & ML_MAPPED) || *am_fulldraw || plr->powers[pw_allmap] || amCheating) {
-            rcolor color = D_RGBA(0x8A, 0x5C, 0x30, 0xFF);  // default color
-
-            //
-            // check for cheats
-            //
-            if((plr->powers[pw_allmap] || amCheating) && !(l->flags & ML_MAPPED)) {
-                color = D_RGBA(0x80, 0x80, 0x80, 0xFF);
-            }
-            //
-            // check for secret line
-            //
-            else if(l->flags & ML_SECRET) {
-                color = D_RGBA(0xA4, 0x00, 0x00, 0xFF);
-            }
+        //
+        // check for secret line
+        //
+        else if(l->flags & ML_SECRET) {
+            color = D_RGBA(0xA4, 0x00, 0x00, 0xFF);
+        }
+        //
+        // handle special line
+        //
+        else if(l->special && !(l->flags & ML_HIDEAUTOMAPTRIGGER)) {
             //
-            // handle special line
+            // draw colored doors based on key requirement
             //
-            else if(l->special && !(l->flags & ML_HIDEAUTOMAPTRIGGER)) {
-                //
-                // draw colored doors based on key requirement
-                //
-                if(am_showkeycolors) {
-                    if(l->special & MLU_RED) {
-                        color = D_RGBA(0xFF, 0x00, 0x00, 0xFF);
-                    }
-                    else if(l->special & MLU_BLUE) {
-                        color = D_RGBA(0x00, 0x00, 0xFF, 0xFF);
-                    }
-                    else if(l->special & MLU_YELLOW) {
-                        color = D_RGBA(0xFF, 0xFF, 0x00, 0xFF);
-                    }
-                    else {
-                        //
-                        // change color to green to avoid confusion with yellow key doors
-                        //
-                        color = D_RGBA(0x00, 0xCC, 0x00, 0xFF);
-                    }
+            if(am_showkeycolors) {
+                if(l->special & MLU_RED) {
+                    color = D_RGBA(0xFF, 0x00, 0x00, 0xFF);
+                }
+                else if(l->special & MLU_BLUE) {
+                    color = D_RGBA(0x00, 0x00, 0xFF, 0xFF);
+                }
+                else if(l->special & MLU_YELLOW) {
+                    color = D_RGBA(0xFF, 0xFF, 0x00, 0xFF);
                 }
                 else {
                     //
-                    // default color for special lines
+                    // change color to green to avoid confusion with yellow key doors
                     //
-                    color = D_RGBA(0xCC, 0xCC, 0x00, 0xFF);
+                    color = D_RGBA(0x00, 0xCC, 0x00, 0xFF);
                 }
             }
-            //
-            // solid wall?
-            //
-            else if(!(l->flags & ML_TWOSIDED)) {
-                color = D_RGBA(0xA4, 0x00, 0x00, 0xFF);
+            else {
+                //
+                // default color for special lines
+                //
+                color = D_RGBA(0xCC, 0xCC, 0x00, 0xFF);
             }
-
-            AM_DrawLine(x1, x2, y1, y2, scale, color);
         }
+        //
+        // solid wall?
+        //
+        else if(!(l->flags & ML_TWOSIDED)) {
+            color = D_RGBA(0xA4, 0x00, 0x00, 0xFF);
+        }
+
+        return color;
     }
+
+    return 0;
+}
+
+//
+// AM_DrawWalls
+// Determines visible lines, draws them.
+// This is LineDef based, not LineSeg based.
+//
+
+void AM_DrawWalls(void) {
+    int mode = 0;
+
+    //
+    // everything besides the lines themselves that the colors depend on
+    //
+    if(*am_fulldraw) {
+        mode |= 1;
+    }
+
+    if(plr->powers[pw_allmap] || amCheating) {
+        mode |= 2;
+    }
+
+    if(am_showkeycolors) {
+        mode |= 4;
+    }
+
+    AM_DrawMapLines(scale, mode, AM_LineColor);
 }
 
 //
@@ -1019,6 +1033,8 @@ void AM_Drawer(void) {
         AM_drawThings();
     }
 
+    AM_FlushDraw();
+
     if(plr->artifacts) {
         int x = 280;
 
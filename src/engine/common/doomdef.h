@@ -254,6 +254,7 @@ enum {
     GF_ALLOWCHEATS      = (1 << 7),
     GF_FRIENDLYFIRE     = (1 << 8),
     GF_KEEPITEMS        = (1 << 9),
+    GF_PVSSIGHT         = (1 << 10),
 };
 
 // 20120209 villsa - compatibility flags
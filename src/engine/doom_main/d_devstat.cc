@@ -36,10 +36,15 @@
 #include "s_sound.h"
 #include "d_englsh.h"
 #include "r_drawlist.h"
+#include "gl_texstream.h"
+#include "gl_texture.h"
+#include "gl_gputimer.h"
+#include "gl_renderscale.h"
 
 static dboolean showstats = true;
 
-extern word statindice;
+extern dword statindice;
+extern dword statdrawcalls;
 
 extern cvar::BoolVar v_mlook;
 extern cvar::BoolVar v_mlookinvert;
@@ -83,11 +88,18 @@ void D_DeveloperDisplay(void) {
     fixed_t px, py, pz, pa, pp;
     int y = 8;
     mobj_t* mo;
+    int rescount, resevicted;
+    size_t resbytes;
+    float framemean, framedev;
+    float scale;
+    int i;
 
     if(!showstats) {
         glBindCalls = 0;
         vertCount = 0;
         statindice = 0;
+        statdrawcalls = 0;
+        spriteDrawCalls = 0;
 
         return;
     }
@@ -140,6 +152,11 @@ void D_DeveloperDisplay(void) {
     if(gamestate == GS_LEVEL) {
         ST_DrawFPS(y);
         y+=16;
+
+        I_GetFrameStats(&framemean, &framedev);
+        sevclr = framedev >= 2.0f ? YELLOW : WHITE;
+        Draw_Text(0, y, sevclr, 0.35f, false, "Frame Time: %.2fms +/- %.2fms", framemean, framedev);
+        y+=16;
     }
 
 
@@ -173,12 +190,41 @@ void D_DeveloperDisplay(void) {
     Draw_Text(0, y, WHITE, 0.35f, false, "Draw Indices: %i", statindice);
     y+=16;
 
+    sevclr = statdrawcalls >= 500 ? YELLOW : WHITE;
+    Draw_Text(0, y, sevclr, 0.35f, false, "Draw Calls: %i", statdrawcalls);
+    y+=16;
+
+    Draw_Text(0, y, WHITE, 0.35f, false, "Streaming Textures: %i", GL_TextureStreamPending());
+    y+=16;
+
+    GL_GetTextureResidency(&rescount, &resbytes, &resevicted);
+    sevclr = resevicted ? YELLOW : WHITE;
+    Draw_Text(0, y, sevclr, 0.35f, false, "Resident Textures: %i (%i kb), %i evicted", rescount, (int)(resbytes >> 10), resevicted);
+    y+=16;
+
     if(gamestate == GS_LEVEL && !automapactive) {
         Draw_Text(0, y, WHITE, 0.35f, false, "PlayerView Render Time: %ims", renderTic);
         y+=16;
 
         Draw_Text(0, y, WHITE, 0.35f, false, "Sprite Render Time: %ims", spriteRenderTic);
         y+=16;
+
+        Draw_Text(0, y, WHITE, 0.35f, false, "Sprite Draw Calls: %i", spriteDrawCalls);
+        y+=16;
+
+        scale = GL_GetRenderScale();
+        sevclr = scale < 1.0f ? YELLOW : WHITE;
+        Draw_Text(0, y, sevclr, 0.35f, false, "Render Scale: %.2f (%ix%i)", scale,
+                  (int)(video_width * scale + 0.5f), (int)(video_height * scale + 0.5f));
+        y+=16;
+    }
+
+    if(GL_GPUTimersActive()) {
+        for(i = 0; i < NUMGPUPASSES; i++) {
+            Draw_Text(0, y, WHITE, 0.35f, false, "GPU %s: %.3fms",
+                      GL_GPUPassName((gpupass_t)i), GL_GPUPassTime((gpupass_t)i));
+            y+=16;
+        }
     }
 
     Draw_Text(0, y, WHITE, 0.35f, false, "Active Sounds: %i", S_GetActiveSounds());
@@ -194,6 +240,8 @@ void D_DeveloperDisplay(void) {
     glBindCalls = 0;
     vertCount = 0;
     statindice = 0;
+    statdrawcalls = 0;
+    spriteDrawCalls = 0;
 }
 
 //
@@ -60,8 +60,17 @@
 #include "r_wipe.h"
 #include "g_controls.h"
 #include "g_demo.h"
+#include "g_timedemo.h"
+#include "g_simdemo.h"
+#include "m_profile.h"
+#include "gl_capture.h"
+#include "gl_gputimer.h"
+#include "gl_readback.h"
+#include "gl_renderscale.h"
 #include "p_saveg.h"
 #include "gl_draw.h"
+#include "gl_texstream.h"
+#include "gl_texture.h"
 #include "core/log/logger.hh"
 #include "config.hh"
 
@@ -207,12 +216,25 @@ int GetLowTic(void);
 dboolean PlayersInGame(void);
 
 static void D_DrawInterface(void) {
+    GL_BeginGPUPass(GPU_HUD);
+
+    // text is batched for the whole pass, and flushed
+    // before anything that has to be drawn over it
+    Draw_BeginBatch();
+
     if(menuactive) {
         M_Drawer();
     }
 
+    Draw_FlushBatch();
+    M_ProfileDrawGraph();
+
+    Draw_FlushBatch();
     CON_Draw();
 
+    Draw_FlushBatch();
+    GL_EndGPUPass();
+
     if(devparm) {
         D_DeveloperDisplay();
     }
@@ -224,24 +246,107 @@ static void D_DrawInterface(void) {
     if(paused) {
         Draw_BigText(-1, 64, WHITE, STRPAUSED);
     }
+
+    Draw_EndBatch();
 }
 
 static void D_FinishDraw(void) {
     // send out any new accumulation
     NetUpdate();
 
+    // upload textures that finished decoding this frame
+    if(usingGL) {
+        GL_UpdateTextureStream();
+        GL_UpdateTextureResidency();
+    }
+
+    // screenshots and captured frames are read back before the frame is presented
+    if(usingGL) {
+        GL_IssueReadbacks();
+        GL_CaptureFrame();
+    }
+
     // normal update
     Video->end_frame();
 
+    if(usingGL) {
+        GL_UpdateGPUTimers();
+        GL_UpdateRenderScale();
+        GL_UpdateReadbacks();
+    }
+
+    if(timingdemo) {
+        G_TimeDemoFrame();
+    }
+
+    M_ProfileFrame();
+
     if(i_interpolateframes) {
         I_EndDisplay();
     }
 }
 
+//
+// D_DrawFrame
+// Nothing is drawn with the null video backend, but
+// frames are still presented so timedemos keep counting
+//
+
+static void D_DrawFrame(void (*draw)(void), int action) {
+    if(usingGL) {
+        if(WIPE_Active()) {
+            WIPE_Drawer();
+        }
+        else if(draw && !action) {
+            draw();
+        }
+        D_DrawInterface();
+    }
+
+    D_FinishDraw();
+}
+
+//
+// D_RunWipe
+// Plays out a wipe started by the loop that just ended. Game tics
+// aren't run until it is done, so the next screen doesn't start
+// unseen, but everything else is.
+//
+
+static void D_RunWipe(void) {
+    while(WIPE_Active()) {
+        PROFILE_ZONE("D_RunWipe");
+        dboolean stepped;
+
+        NetUpdate();
+
+        stepped = WIPE_Ticker();
+
+        if(!WIPE_Active()) {
+            break;
+        }
+
+        // the timedemo clock only moves when a frame is drawn
+        if(i_interpolateframes ? I_StartDisplay() : (stepped || timingdemo)) {
+            S_UpdateSounds();
+            D_DrawFrame(NULL, 0);
+        }
+        else {
+            I_WaitFrame();
+        }
+
+        Z_FreeAlloca();
+    }
+}
+
 int D_MiniLoop(void (*start)(void), void (*stop)(void),
                void (*draw)(void), dboolean(*tick)(void)) {
     int action = gameaction = ga_nothing;
 
+    if(simdemo) {
+        return G_SimDemoLoop(start, stop, tick);
+    }
+
     if(start) {
         start();
     }
@@ -255,6 +360,7 @@ int D_MiniLoop(void (*start)(void), void (*stop)(void),
         int availabletics = 0;
         int counts = 0;
         int keyplayer = -1;
+        PROFILE_ZONE("D_MiniLoop");
 
         windowpause = (menuactive ? true : false);
 
@@ -269,11 +375,7 @@ int D_MiniLoop(void (*start)(void), void (*stop)(void),
             renderinframe = true;
 
             if(I_StartDisplay()) {
-                if(draw && !action) {
-                    draw();
-                }
-                D_DrawInterface();
-                D_FinishDraw();
+                D_DrawFrame(draw, action);
             }
 
             renderinframe = false;
@@ -362,11 +464,7 @@ int D_MiniLoop(void (*start)(void), void (*stop)(void),
                 renderinframe = true;
 
                 if(I_StartDisplay()) {
-                    if(draw && !action) {
-                        draw();
-                    }
-                    D_DrawInterface();
-                    D_FinishDraw();
+                    D_DrawFrame(draw, action);
                 }
 
                 renderinframe = false;
@@ -379,7 +477,9 @@ int D_MiniLoop(void (*start)(void), void (*stop)(void),
                 goto drawframe;
             }
 
-            I_Sleep(1);
+            if(!timingdemo) {
+                I_WaitFrame();
+            }
         }
 
         // run the count * ticdup dics
@@ -443,11 +543,7 @@ int D_MiniLoop(void (*start)(void), void (*stop)(void),
             }
         }
 
-        if(draw && !action) {
-            draw();
-        }
-        D_DrawInterface();
-        D_FinishDraw();
+        D_DrawFrame(draw, action);
 
     freealloc:
 
@@ -461,6 +557,8 @@ int D_MiniLoop(void (*start)(void), void (*stop)(void),
         stop();
     }
 
+    D_RunWipe();
+
     return action;
 }
 
@@ -519,7 +617,7 @@ static void Title_Stop(void) {
     allowclearmenu = true;
 
     WIPE_FadeScreen(8);
-    S_StopMusic();
+    WIPE_OnFinish(S_StopMusic);
 }
 
 //
@@ -963,6 +1061,80 @@ static int D_CheckDemo(void) {
         return 1;
     }
 
+    p = M_CheckParm("-timedemo");
+    if(p && p < myargc-1) {
+        int frames = 1;
+        int f = M_CheckParm("-timedemoframes");
+
+        if(f && f < myargc-1) {
+            frames = datoi(myargv[f+1]);
+        }
+
+        G_TimeDemo(myargv[p+1], frames);
+        return 1;
+    }
+
+    // renders every frame of a demo out to a video stream
+    p = M_CheckParm("-capturedemo");
+    if(p && p < myargc-1) {
+        char *name = (char*)"capture.y4m";
+        char *ext;
+        int fps = 60;
+        int frames;
+        int f;
+        dboolean ppm;
+
+        if((f = M_CheckParm("-captureout")) && f < myargc-1) {
+            name = myargv[f+1];
+        }
+
+        if((f = M_CheckParm("-capturefps")) && f < myargc-1) {
+            fps = datoi(myargv[f+1]);
+        }
+
+        // frames are spread evenly over each tic
+        frames = MAX(fps / TICRATE, 1);
+
+        if((f = M_CheckParm("-captureformat")) && f < myargc-1) {
+            ppm = !dstricmp(myargv[f+1], "ppm");
+        }
+        else {
+            ppm = (ext = dstrrchr(name, '.')) && !dstricmp(ext, ".ppm");
+        }
+
+        if(!GL_BeginCapture(name, frames, ppm)) {
+            I_Error("D_CheckDemo: Couldn't start capturing to %s", name);
+        }
+
+        G_TimeDemo(myargv[p+1], frames);
+        return 1;
+    }
+
+    // standard benchmark using the demos in the rom
+    p = M_CheckParm("-benchdemo");
+    if(p) {
+        char lump[9] = "DEMO1LMP";
+        int frames = 1;
+        int f = M_CheckParm("-timedemoframes");
+
+        if(p < myargc-1 && myargv[p+1][0] >= '1' && myargv[p+1][0] <= '3') {
+            lump[4] = myargv[p+1][0];
+        }
+
+        if(f && f < myargc-1) {
+            frames = datoi(myargv[f+1]);
+        }
+
+        G_TimeDemo(lump, frames);
+        return 1;
+    }
+
+    p = M_CheckParm("-simdemo");
+    if(p && p < myargc-1) {
+        G_SimDemo(myargv[p+1]);
+        return 1;
+    }
+
     return 0;
 }
 
@@ -977,6 +1149,7 @@ namespace imp {
 [[noreturn]]
 void D_DoomMain(void) {
     devparm = M_CheckParm("-devparm");
+    simdemo = M_CheckParm("-simdemo");
 
     {
         log::info("Init " sBLUEB("Console variables") "...");
@@ -1022,6 +1195,7 @@ void D_DoomMain(void) {
 
         I_Printf("M_Init: Init miscellaneous info.\n");
         M_Init();
+        M_ProfileInit();
 
         I_Printf("R_Init: Init DOOM refresh daemon.\n");
         R_Init();
@@ -1041,8 +1215,10 @@ void D_DoomMain(void) {
         I_Printf("ST_Init: Init status bar.\n");
         ST_Init();
 
-        I_Printf("GL_Init: Init OpenGL\n");
-        GL_Init();
+        if(Video->has_opengl()) {
+            I_Printf("GL_Init: Init OpenGL\n");
+            GL_Init();
+        }
 
         g_native_ui->console_show(false);
 
@@ -32,11 +32,13 @@
 #include "m_menu.h"
 #include "i_system.h"
 #include "g_game.h"
+#include "g_timedemo.h"
 #include "doomdef.h"
 #include "doomstat.h"
 #include "tables.h"
 #include "m_misc.h"
 #include "con_console.h"
+#include "m_profile.h"
 #include "SDL.h"
 
 #define FEATURE_MULTIPLAYER 1
@@ -86,6 +88,11 @@ dboolean renderinframe = false;
 static int GetAdjustedTime(void) {
     int time_ms;
 
+    // a timedemo only advances the tic clock, milliseconds stay real
+    if(timingdemo) {
+        return I_GetTime();
+    }
+
     time_ms = I_GetTimeMS();
 
     if(net_cl_new_sync) {
@@ -106,6 +113,7 @@ static int GetAdjustedTime(void) {
 int gametime = 0;
 
 void NetUpdate(void) {
+    PROFILE_ZONE("NetUpdate");
     int nowtime;
     int newtics;
     int i;
@@ -33,6 +33,10 @@
 #include "p_tick.h"
 #include "g_local.h"
 #include "g_demo.h"
+#include "g_timedemo.h"
+#include "g_simdemo.h"
+#include "g_romdemo.h"
+#include "i_system.h"
 #include "m_misc.h"
 #include "m_random.h"
 #include "con_console.h"
@@ -55,6 +59,30 @@ dboolean        singledemo      = false;    // quit after playing a demo from cm
 dboolean        endDemo;
 dboolean        iwadDemo        = false;
 
+static char     demosyncname[256];
+static uint32   demosynchash;
+static int      demostarttic;
+
+typedef struct {
+    uint32      hash;       // G_DemoChecksum of the demo as stored
+    int         map;
+    int         tics;
+    int         kills;
+    int         items;
+    int         secrets;
+    fixed_t     x;
+    fixed_t     y;
+    fixed_t     z;
+    int         health;
+} demosync_t;
+
+// How each demo ended on a known good build. Rows are the line printed
+// by G_DemoSyncCheck for a demo with no entry, after checking that
+// playback really followed the recording. A live run never adds to this.
+static const demosync_t demosyncs[] = {
+    { 0 }
+};
+
 extern int      starttime;
 
 //
@@ -207,6 +235,21 @@ void G_RecordDemo(const char* name) {
     G_CheckDemoStatus();
 }
 
+//
+// G_DemoChecksum
+//
+
+static uint32 G_DemoChecksum(const byte *data, size_t size) {
+    uint32 hash = 2166136261u;
+    size_t i;
+
+    for(i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
 //
 // G_PlayDemo
 //
@@ -214,12 +257,26 @@ void G_RecordDemo(const char* name) {
 void G_PlayDemo(const char* name) {
     int i;
     int p;
+    int length;
     char filename[256];
 
     gameaction = ga_nothing;
     endDemo = false;
 
     p = M_CheckParm("-playdemo");
+    if(!p) {
+        p = M_CheckParm("-timedemo");
+    }
+    if(!p) {
+        p = M_CheckParm("-simdemo");
+    }
+
+    // demo lumps can be played by name as well
+    if(p && p < myargc-1 && wad::exists(myargv[p+1])) {
+        name = myargv[p+1];
+        p = 0;
+    }
+
     if(p && p < myargc-1) {
         // 20120107 bkw: add .lmp extension if missing.
         if(dstrrchr(myargv[p+1], '.')) {
@@ -230,21 +287,49 @@ void G_PlayDemo(const char* name) {
         }
 
         CON_DPrintf("--------Reading demo %s--------\n", filename);
-        if(M_ReadFile(filename, &demobuffer) == -1) {
+        if((length = M_ReadFile(filename, &demobuffer)) == -1) {
             gameaction = ga_exitdemo;
             return;
         }
 
         demo_p = demobuffer;
+        demosynchash = G_DemoChecksum(demobuffer, length);
+        dstrcpy(demosyncname, filename);
     }
     else {
+        size_t size;
+
         if (!wad::exists(name)) {
             gameaction = ga_exitdemo;
             return;
         }
 
         CON_DPrintf("--------Playing demo %s--------\n", name);
-        demobuffer = demo_p = reinterpret_cast<byte*>(wad::open(name)->read_bytes_ccompat());
+        demobuffer = demo_p = reinterpret_cast<byte*>(wad::open(name)->read_bytes_ccompat(size));
+        demosynchash = G_DemoChecksum(demobuffer, size);
+
+        // the cartridge demos are stored as raw controller input
+        if(size < 4 || strncmp((char*)demo_p, "DM64", 4)) {
+            byte *converted;
+
+            // converted input may not follow the original route, so the
+            // title screen only plays demos that were recorded here
+            if(iwadDemo) {
+                delete[] demobuffer;
+                demobuffer = demo_p = NULL;
+                gameaction = ga_exitdemo;
+                return;
+            }
+
+            converted = G_ConvertRomDemo(name, demo_p, size);
+
+            if(converted) {
+                delete[] demobuffer;
+                demobuffer = demo_p = converted;
+            }
+        }
+
+        dstrncpy(demosyncname, name, sizeof(demosyncname) - 1);
     }
     
     if(strncmp((char*)demo_p, "DM64", 4)) {
@@ -308,10 +393,68 @@ void G_PlayDemo(const char* name) {
     usergame = false;
     demoplayback = true;
 
+    demostarttic = gametic;
+
     G_RunGame();
     iwadDemo = false;
 }
 
+//
+// G_DemoSyncCheck
+// Compares the state the demo ended in against the known good
+// result for it, matched by the checksum of the demo data
+//
+
+static void G_DemoSyncCheck(void) {
+    player_t *player = &players[consoleplayer];
+    const demosync_t *ref;
+    demosync_t sync;
+
+    if(!player->mo) {
+        return;
+    }
+
+    sync.hash = demosynchash;
+    sync.map = gamemap;
+    sync.tics = gametic - demostarttic;
+    sync.kills = player->killcount;
+    sync.items = player->itemcount;
+    sync.secrets = player->secretcount;
+    sync.x = player->mo->x;
+    sync.y = player->mo->y;
+    sync.z = player->mo->z;
+    sync.health = player->health;
+
+    for(ref = demosyncs; ref->hash; ref++) {
+        if(ref->hash == sync.hash) {
+            break;
+        }
+    }
+
+    if(!ref->hash) {
+        CON_Warnf("demo sync: no known result for %s, playback is unverified\n", demosyncname);
+        CON_Printf(WHITE, "    { 0x%08x, %i, %i, %i, %i, %i, %i, %i, %i, %i },\n", sync.hash, sync.map,
+                   sync.tics, sync.kills, sync.items, sync.secrets, sync.x, sync.y, sync.z, sync.health);
+        return;
+    }
+
+    if(sync.map == ref->map && sync.tics == ref->tics &&
+            sync.kills == ref->kills && sync.items == ref->items && sync.secrets == ref->secrets &&
+            sync.x == ref->x && sync.y == ref->y && sync.z == ref->z && sync.health == ref->health) {
+        CON_Printf(WHITE, "demo sync: ok\n");
+        return;
+    }
+
+    CON_Warnf("demo sync: %s DESYNCED, results are not comparable\n", demosyncname);
+    CON_Warnf("  map %02d, expected %02d\n", sync.map, ref->map);
+    CON_Warnf("  %i tics, expected %i\n", sync.tics, ref->tics);
+    CON_Warnf("  kills %i items %i secrets %i, expected %i %i %i\n",
+              sync.kills, sync.items, sync.secrets, ref->kills, ref->items, ref->secrets);
+    CON_Warnf("  position %i %i %i, expected %i %i %i\n",
+              F2INT(sync.x), F2INT(sync.y), F2INT(sync.z), F2INT(ref->x), F2INT(ref->y), F2INT(ref->z));
+    CON_Warnf("  health %i, expected %i\n", sync.health, ref->health);
+}
+
 //
 // G_CheckDemoStatus
 // Called after a death or level completion to allow demos to be cleaned up
@@ -329,6 +472,21 @@ dboolean G_CheckDemoStatus(void) {
     }
 
     if(demoplayback) {
+        dboolean benchmark = (timingdemo || simdemo);
+
+        if(timingdemo) {
+            G_TimeDemoFinish();
+        }
+
+        if(simdemo) {
+            G_SimDemoFinish();
+        }
+
+        // benchmark numbers are worthless if the demo went off course
+        if(benchmark) {
+            G_DemoSyncCheck();
+        }
+
         if(singledemo) {
             I_Quit();
         }
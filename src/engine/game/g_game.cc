@@ -57,6 +57,8 @@
 #include "g_local.h"
 #include "m_password.h"
 #include "g_demo.h"
+#include "g_timedemo.h"
+#include "m_profile.h"
 
 #define DCLICK_TIME     20
 
@@ -149,6 +151,7 @@ cvar::BoolVar sv_friendlyfire  = false;
 cvar::BoolVar sv_keepitems     = false;
 cvar::BoolVar p_allowjump      = false;
 cvar::BoolVar p_autoaim        = true;
+cvar::BoolVar sv_pvssight      = false;
 cvar::BoolVar compat_collision = true;
 cvar::BoolVar compat_mobjpass  = true;
 cvar::BoolVar compat_limitpain = true;
@@ -917,6 +920,9 @@ static void G_SetGameFlags(void) {
     if (p_autoaim)
          gameflags |= GF_ALLOWAUTOAIM;
 
+    if (sv_pvssight)
+        gameflags |= GF_PVSSIGHT;
+
     if (compat_collision)
         compatflags |= COMPATF_COLLISION;
 
@@ -997,6 +1003,10 @@ void G_DoLoadLevel(bool spawn_mobjs = true) {
     // clear cmd building stuff
     G_ClearInput();
     sendpause = sendsave = paused = false;
+
+    if(timingdemo) {
+        G_TimeDemoLevelStart();
+    }
 }
 
 
@@ -1076,6 +1086,7 @@ dboolean G_Responder(event_t* ev) {
 //
 
 void G_Ticker(void) {
+    PROFILE_ZONE("G_Ticker");
     int         i;
     int         buf;
     ticcmd_t*   cmd;
@@ -1643,6 +1654,7 @@ void G_Init(void) {
         (sv_keepitems,     "sv_KeepItems",     "TODO")
         (p_allowjump,      "p_AllowJump",      "TODO")
         (p_autoaim,        "p_AutoAim",        "TODO")
+        (sv_pvssight,      "sv_PVSSight",      "Reject sight checks with the map's potentially visible set")
         (compat_collision, "compat_Collision", "TODO")
         (compat_mobjpass,  "compat_MobjPass",  "TODO")
         (compat_limitpain, "compat_LimitPain", "TODO")
@@ -1654,6 +1666,7 @@ void G_Init(void) {
     sv_keepitems.set_callback(G_SetGameFlagsCvarCallback);
     p_allowjump.set_callback(G_SetGameFlagsCvarCallback);
     p_autoaim.set_callback(G_SetGameFlagsCvarCallback);
+    sv_pvssight.set_callback(G_SetGameFlagsCvarCallback);
     compat_collision.set_callback(G_SetGameFlagsCvarCallback);
     compat_mobjpass.set_callback(G_SetGameFlagsCvarCallback);
     compat_limitpain.set_callback(G_SetGameFlagsCvarCallback);
@@ -0,0 +1,304 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Nintendo 64 demo lumps.
+//    The cartridge demos are raw controller reads: the player's button
+//    layout and stick sensitivity, followed by one big endian word per
+//    tic holding the pad buttons and the analog stick. They are turned
+//    into ticcmds the same way G_BuildTiccmd handles the keyboard and
+//    a gamepad, and wrapped in a regular DM64 header so the normal
+//    playback code can run them.
+//
+//-----------------------------------------------------------------------------
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "d_event.h"
+#include "g_demo.h"
+#include "g_romdemo.h"
+#include "z_zone.h"
+#include "con_console.h"
+
+extern fixed_t forwardmove[2];
+extern fixed_t sidemove[2];
+extern fixed_t angleturn[20];
+
+#define SLOWTURNTICS        10
+
+#define PAD_START           0x10000000
+
+#define ROMSTICKMAX         80      // stick deflection at full speed
+#define ROMSTICKDEADZONE    8
+#define ROMMAXSENSITIVITY   100
+
+// order of the button layout stored in the demo header
+enum {
+    ROMBT_RIGHT,
+    ROMBT_LEFT,
+    ROMBT_FORWARD,
+    ROMBT_BACK,
+    ROMBT_ATTACK,
+    ROMBT_USE,
+    ROMBT_MAP,
+    ROMBT_SPEED,
+    ROMBT_STRAFE,
+    ROMBT_STRAFELEFT,
+    ROMBT_STRAFERIGHT,
+    ROMBT_WEAPONBACKWARD,
+    ROMBT_WEAPONFORWARD,
+    NUMROMBUTTONS
+};
+
+#define ROMDEMOHEADER       (NUMROMBUTTONS + 1)
+
+// the cartridge picks the map and skill for each demo
+static const struct {
+    const char  *name;
+    int         map;
+    skill_t     skill;
+} romdemos[] = {
+    { "DEMO1LMP",   3,  sk_medium },
+    { "DEMO2LMP",   9,  sk_medium },
+    { "DEMO3LMP",   17, sk_medium }
+};
+
+//
+// G_RomDemoWord
+//
+
+static uint32 G_RomDemoWord(const byte *p) {
+    return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+//
+// G_RomDemoStick
+//
+
+static int G_RomDemoStick(int value) {
+    if(value > -ROMSTICKDEADZONE && value < ROMSTICKDEADZONE) {
+        return 0;
+    }
+
+    return MAX(MIN(value, ROMSTICKMAX), -ROMSTICKMAX);
+}
+
+//
+// G_RomDemoTiccmd
+//
+
+static void G_RomDemoTiccmd(ticcmd_t *cmd, uint32 pad, uint32 oldpad,
+                            const uint32 *layout, int sensitivity, int *turnheld) {
+    int speed;
+    int forward;
+    int side;
+    int stickx;
+    int sticky;
+
+    dmemset(cmd, 0, sizeof(ticcmd_t));
+
+    speed = (pad & layout[ROMBT_SPEED]) ? 1 : 0;
+    stickx = G_RomDemoStick((signed char)((pad >> 8) & 0xff));
+    sticky = G_RomDemoStick((signed char)(pad & 0xff));
+
+    forward = side = 0;
+
+    if((pad & layout[ROMBT_LEFT]) || (pad & layout[ROMBT_RIGHT])) {
+        (*turnheld)++;
+    }
+    else {
+        *turnheld = 0;
+    }
+
+    if(*turnheld >= SLOWTURNTICS) {
+        *turnheld = SLOWTURNTICS-1;
+    }
+
+    if(pad & layout[ROMBT_STRAFE]) {
+        if(pad & layout[ROMBT_RIGHT]) {
+            side += sidemove[speed];
+        }
+        if(pad & layout[ROMBT_LEFT]) {
+            side -= sidemove[speed];
+        }
+
+        side += stickx * sidemove[speed] / ROMSTICKMAX;
+    }
+    else {
+        if(pad & layout[ROMBT_RIGHT]) {
+            cmd->angleturn -= angleturn[*turnheld + (speed ? SLOWTURNTICS : 0)] << 2;
+        }
+        if(pad & layout[ROMBT_LEFT]) {
+            cmd->angleturn += angleturn[*turnheld + (speed ? SLOWTURNTICS : 0)] << 2;
+        }
+
+        cmd->angleturn -= stickx * (8 + 8 * sensitivity / ROMMAXSENSITIVITY);
+    }
+
+    forward += sticky * forwardmove[speed] / ROMSTICKMAX;
+
+    if(pad & layout[ROMBT_FORWARD]) {
+        forward += forwardmove[speed];
+    }
+    if(pad & layout[ROMBT_BACK]) {
+        forward -= forwardmove[speed];
+    }
+    if(pad & layout[ROMBT_STRAFERIGHT]) {
+        side += sidemove[speed];
+    }
+    if(pad & layout[ROMBT_STRAFELEFT]) {
+        side -= sidemove[speed];
+    }
+
+    // -128 would read back as the end of demo marker
+    cmd->forwardmove = MAX(MIN(forward, 127), -127);
+    cmd->sidemove = MAX(MIN(side, 127), -127);
+
+    if(pad & layout[ROMBT_ATTACK]) {
+        cmd->buttons |= BT_ATTACK;
+    }
+
+    if(pad & layout[ROMBT_USE]) {
+        cmd->buttons |= BT_USE;
+    }
+
+    // weapons change once per press
+    if((pad & ~oldpad) & layout[ROMBT_WEAPONFORWARD]) {
+        cmd->buttons |= BT_CHANGE;
+        cmd->buttons2 |= BT2_NEXTWEAP;
+    }
+    else if((pad & ~oldpad) & layout[ROMBT_WEAPONBACKWARD]) {
+        cmd->buttons |= BT_CHANGE;
+        cmd->buttons2 |= BT2_PREVWEAP;
+    }
+}
+
+//
+// G_ConvertRomDemo
+// Returns a DM64 demo, or NULL if name isn't one of the cartridge demos
+//
+
+byte *G_ConvertRomDemo(const char *name, const byte *data, size_t size) {
+    uint32 layout[NUMROMBUTTONS];
+    uint32 pad;
+    uint32 oldpad;
+    int sensitivity;
+    int turnheld;
+    int numtics;
+    int demo;
+    int flags;
+    int i;
+    byte *buffer;
+    byte *p;
+
+    for(demo = 0; demo < (int)(sizeof(romdemos) / sizeof(romdemos[0])); demo++) {
+        if(!dstricmp(name, romdemos[demo].name)) {
+            break;
+        }
+    }
+
+    if(demo == (int)(sizeof(romdemos) / sizeof(romdemos[0]))) {
+        return NULL;
+    }
+
+    if(size < ROMDEMOHEADER * 4) {
+        CON_Warnf("G_ConvertRomDemo: %s is too short\n", name);
+        return NULL;
+    }
+
+    for(i = 0; i < NUMROMBUTTONS; i++) {
+        layout[i] = G_RomDemoWord(data + i * 4);
+    }
+
+    sensitivity = MAX(MIN((int)G_RomDemoWord(data + NUMROMBUTTONS * 4), ROMMAXSENSITIVITY), 0);
+    numtics = (int)(size / 4) - ROMDEMOHEADER;
+
+    buffer = p = (byte*)Z_Malloc(32 + MAXPLAYERS + numtics * 8 + 1, PU_STATIC, 0);
+
+    *p++ = 'D';
+    *p++ = 'M';
+    *p++ = '6';
+    *p++ = '4';
+    *p++ = '\0';
+
+    *p++ = romdemos[demo].skill;
+    *p++ = romdemos[demo].map;
+    *p++ = 0;   // deathmatch
+    *p++ = 0;   // respawnparm
+    *p++ = 0;   // respawnitem
+    *p++ = 0;   // fastparm
+    *p++ = 0;   // nomonsters
+    *p++ = 0;   // consoleplayer
+
+    // rngseed
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+
+    // always use the defaults so every installation plays the same game
+    flags = GF_ALLOWAUTOAIM;
+    *p++ = (byte)((flags >> 24) & 0xff);
+    *p++ = (byte)((flags >> 16) & 0xff);
+    *p++ = (byte)((flags >>  8) & 0xff);
+    *p++ = (byte)( flags        & 0xff);
+
+    flags = COMPATF_COLLISION|COMPATF_MOBJPASS|COMPATF_LIMITPAIN|COMPATF_REACHITEMS;
+    *p++ = (byte)((flags >> 24) & 0xff);
+    *p++ = (byte)((flags >> 16) & 0xff);
+    *p++ = (byte)((flags >>  8) & 0xff);
+    *p++ = (byte)( flags        & 0xff);
+
+    for(i = 0; i < MAXPLAYERS; i++) {
+        *p++ = (i == 0);
+    }
+
+    oldpad = 0;
+    turnheld = 0;
+
+    for(i = 0; i < numtics; i++) {
+        ticcmd_t cmd;
+
+        pad = G_RomDemoWord(data + (ROMDEMOHEADER + i) * 4);
+
+        // recording was stopped with the start button
+        if(pad & PAD_START) {
+            break;
+        }
+
+        G_RomDemoTiccmd(&cmd, pad, oldpad, layout, sensitivity, &turnheld);
+        oldpad = pad;
+
+        *p++ = cmd.forwardmove;
+        *p++ = cmd.sidemove;
+        *p++ = cmd.angleturn & 0xff;
+        *p++ = (cmd.angleturn >> 8) & 0xff;
+        *p++ = cmd.pitch & 0xff;
+        *p++ = (cmd.pitch >> 8) & 0xff;
+        *p++ = cmd.buttons;
+        *p++ = cmd.buttons2;
+    }
+
+    *p++ = DEMOMARKER;
+
+    CON_DPrintf("G_ConvertRomDemo: %s, %i tics on map %02d\n", name, i, romdemos[demo].map);
+
+    return buffer;
+}
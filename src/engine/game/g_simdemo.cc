@@ -0,0 +1,206 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Playsim benchmark.
+//    Plays a demo back through G_Ticker alone. Nothing is drawn, no
+//    sound is played and the loop never waits on the clock, so the
+//    only thing measured is the game simulation itself. Video, OpenGL
+//    and audio are never initialized, which lets it run on machines
+//    without a display.
+//
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "g_local.h"
+#include "g_demo.h"
+#include "g_simdemo.h"
+#include "i_system.h"
+#include "p_local.h"
+#include "p_spec.h"
+#include "p_macros.h"
+#include "p_tick.h"
+#include "z_zone.h"
+#include "con_console.h"
+
+extern cvar::BoolVar i_interpolateframes;
+
+dboolean simdemo = false;
+
+typedef std::chrono::steady_clock simclock_t;
+
+static const char *simstatnames[NUMSIMSTATS] = {
+    "P_RunThinkers",
+    "P_ScanSights",
+    "P_RunMobjs",
+    "P_UpdateSpecials",
+    "P_RunMacros"
+};
+
+static simclock_t::duration simstats[NUMSIMSTATS];
+static simclock_t::duration simtictime;
+static simclock_t::time_point simstart;
+static int simtics;
+static bool oldinterpolate;
+static void (*oldplaysim)(void);
+
+static void G_SimDemoPlaysim(void);
+
+//
+// G_SimDemo
+// Only returns if the demo couldn't be started
+//
+
+void G_SimDemo(const char* name) {
+    int i;
+
+    singledemo = true;
+
+    // interpolation only matters to the renderer
+    oldinterpolate = *i_interpolateframes;
+    i_interpolateframes = false;
+
+    oldplaysim = P_RunPlaysim;
+    P_RunPlaysim = G_SimDemoPlaysim;
+
+    for(i = 0; i < NUMSIMSTATS; i++) {
+        simstats[i] = simclock_t::duration::zero();
+    }
+
+    simtictime = simclock_t::duration::zero();
+    simtics = 0;
+    simstart = simclock_t::now();
+
+    G_PlayDemo(name);
+
+    CON_Warnf("G_SimDemo: couldn't play %s\n", name);
+    I_Quit();
+}
+
+//
+// G_SimDemoLoop
+// Stands in for D_MiniLoop, running tics back to back
+//
+
+int G_SimDemoLoop(void (*start)(void), void (*stop)(void), dboolean(*tick)(void)) {
+    int action = gameaction = ga_nothing;
+
+    if(start) {
+        start();
+    }
+
+    while(!action) {
+        auto tictime = simclock_t::now();
+
+        G_Ticker();
+
+        if(tick) {
+            action = tick();
+        }
+
+        if(gameaction != ga_nothing) {
+            action = gameaction;
+        }
+
+        gametic++;
+
+        simtictime += simclock_t::now() - tictime;
+        simtics++;
+
+        Z_FreeAlloca();
+    }
+
+    gamestate = GS_NONE;
+
+    if(stop) {
+        stop();
+    }
+
+    return action;
+}
+
+//
+// G_SimDemoRun
+// Times one of the playsim subsystems
+//
+
+static void G_SimDemoRun(simstat_t stat, void (*func)(void)) {
+    auto start = simclock_t::now();
+
+    func();
+    simstats[stat] += simclock_t::now() - start;
+}
+
+//
+// G_SimDemoPlaysim
+// Stands in for P_RunPlaysim while the benchmark runs
+//
+
+static void G_SimDemoPlaysim(void) {
+    G_SimDemoRun(SIM_RUNTHINKERS, P_RunThinkers);
+    G_SimDemoRun(SIM_SCANSIGHTS, P_ScanSights);
+    G_SimDemoRun(SIM_RUNMOBJS, P_RunMobjs);
+    G_SimDemoRun(SIM_UPDATESPECIALS, P_UpdateSpecials);
+    G_SimDemoRun(SIM_RUNMACROS, P_RunMacros);
+}
+
+//
+// G_SimDemoFinish
+//
+
+void G_SimDemoFinish(void) {
+    std::chrono::duration<double> total = simclock_t::now() - simstart;
+    std::chrono::duration<double, std::milli> tictime = simtictime;
+    std::chrono::duration<double, std::milli> other = simtictime;
+    int i;
+
+    if(!simdemo) {
+        return;
+    }
+
+    simdemo = false;
+    i_interpolateframes = oldinterpolate;
+    P_RunPlaysim = oldplaysim;
+
+    CON_Printf(WHITE, "simdemo: %i tics in %.3f seconds (%.3f seconds simulating)\n",
+               simtics, total.count(), tictime.count() / 1000.0);
+
+    if(!simtics || tictime.count() <= 0.0) {
+        return;
+    }
+
+    CON_Printf(WHITE, "  %.1f tics/sec, %.2fx realtime\n",
+               simtics * 1000.0 / tictime.count(), (simtics * 1000.0 / tictime.count()) / TICRATE);
+
+    for(i = 0; i < NUMSIMSTATS; i++) {
+        std::chrono::duration<double, std::milli> ms = simstats[i];
+
+        other -= ms;
+
+        CON_Printf(WHITE, "  %-17s %10.3f ms %8.2f us/tic %6.2f%%\n", simstatnames[i],
+                   ms.count(), ms.count() * 1000.0 / simtics, ms.count() * 100.0 / tictime.count());
+    }
+
+    CON_Printf(WHITE, "  %-17s %10.3f ms %8.2f us/tic %6.2f%%\n", "other",
+               other.count(), other.count() * 1000.0 / simtics, other.count() * 100.0 / tictime.count());
+}
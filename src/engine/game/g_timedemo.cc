@@ -0,0 +1,254 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Timedemo benchmark.
+//    Plays a demo back with the game clock driven by rendered frames
+//    instead of real time, so every recorded tic is run and drawn as
+//    fast as the machine allows. Frame times are collected and
+//    summarized when the demo ends.
+//
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "g_local.h"
+#include "g_demo.h"
+#include "g_timedemo.h"
+#include "i_system.h"
+#include "m_misc.h"
+#include "con_console.h"
+#include "gl_capture.h"
+#include "system/ivideo.hh"
+
+extern cvar::BoolVar i_interpolateframes;
+extern cvar::BoolVar v_vsync;
+
+dboolean timingdemo = false;
+
+typedef std::chrono::steady_clock timedemoclock_t;
+
+typedef struct {
+    float   ms;
+    int     tic;
+} demoframe_t;
+
+static std::vector<demoframe_t> demoframes;
+static timedemoclock_t::time_point timedemostart;
+static timedemoclock_t::time_point timedemolast;
+static dboolean timedemohavelast;
+static int timedemostarttic;
+static int timedemoframespertic;
+static bool oldinterpolate;
+
+// histogram bucket upper bounds in ms, the last one catches everything else
+static const float histbuckets[] = { 2.0f, 4.0f, 8.0f, 16.7f, 33.3f, 50.0f, 100.0f };
+#define NUMHISTBUCKETS  ((int)(sizeof(histbuckets) / sizeof(histbuckets[0])) + 1)
+
+//
+// G_TimeDemo
+// Plays back a demo as a benchmark. framespertic > 1 renders
+// interpolated frames in between tics.
+//
+
+void G_TimeDemo(const char* name, int framespertic) {
+    timingdemo = true;
+    singledemo = true;
+
+    timedemoframespertic = MAX(framespertic, 1);
+    demoframes.clear();
+    demoframes.reserve(TICRATE * 60 * timedemoframespertic);
+
+    // in between frames only exist with interpolation, and without
+    // it D_MiniLoop draws exactly one frame for each tic
+    oldinterpolate = *i_interpolateframes;
+    i_interpolateframes = (timedemoframespertic > 1);
+
+    imp::Video->set_vsync(false);
+    I_SetTimeDemo(timedemoframespertic);
+
+    timedemostart = timedemoclock_t::now();
+    timedemostarttic = gametic;
+    timedemohavelast = false;
+
+    G_PlayDemo(name);
+}
+
+//
+// G_TimeDemoLevelStart
+// Level loading isn't part of any frame
+//
+
+void G_TimeDemoLevelStart(void) {
+    timedemohavelast = false;
+}
+
+//
+// G_TimeDemoFrame
+// Called after every frame has been presented
+//
+
+void G_TimeDemoFrame(void) {
+    auto now = timedemoclock_t::now();
+
+    if(timedemohavelast) {
+        std::chrono::duration<float, std::milli> elapsed = now - timedemolast;
+        demoframe_t frame;
+
+        frame.ms = elapsed.count();
+        frame.tic = gametic;
+        demoframes.push_back(frame);
+    }
+
+    timedemolast = now;
+    timedemohavelast = true;
+
+    I_TimeDemoFrame();
+}
+
+//
+// G_TimeDemoLows
+// Average frame time of the slowest fraction of frames
+//
+
+static float G_TimeDemoLows(const std::vector<float> &sorted, float fraction) {
+    size_t count = MAX((size_t)(sorted.size() * fraction), (size_t)1);
+    double total = 0;
+    size_t i;
+
+    for(i = 0; i < count; i++) {
+        total += sorted[sorted.size() - 1 - i];
+    }
+
+    return (float)(total / count);
+}
+
+//
+// G_TimeDemoWriteCSV
+//
+
+static void G_TimeDemoWriteCSV(const char *name) {
+    FILE *f;
+    size_t i;
+
+    if(!(f = fopen(name, "w"))) {
+        CON_Warnf("Couldn't write %s\n", name);
+        return;
+    }
+
+    fprintf(f, "frame,tic,ms\n");
+
+    for(i = 0; i < demoframes.size(); i++) {
+        fprintf(f, "%u,%i,%.4f\n", (unsigned int)i, demoframes[i].tic, demoframes[i].ms);
+    }
+
+    fclose(f);
+    CON_Printf(WHITE, "Frame times written to %s\n", name);
+}
+
+//
+// G_TimeDemoFinish
+// Restores the real clock and prints the results
+//
+
+void G_TimeDemoFinish(void) {
+    std::chrono::duration<double> total = timedemoclock_t::now() - timedemostart;
+    std::vector<float> sorted;
+    int hist[NUMHISTBUCKETS];
+    double frametotal = 0;
+    float low1, low01;
+    int tics;
+    int i;
+    int p;
+
+    if(!timingdemo) {
+        return;
+    }
+
+    timingdemo = false;
+
+    GL_EndCapture();
+    I_SetTimeDemo(0);
+    imp::Video->set_vsync(*v_vsync);
+    i_interpolateframes = oldinterpolate;
+
+    tics = gametic - timedemostarttic;
+
+    CON_Printf(WHITE, "timedemo: %i tics, %i frames in %.3f seconds\n",
+               tics, (int)demoframes.size(), total.count());
+
+    if(demoframes.empty()) {
+        return;
+    }
+
+    dmemset(hist, 0, sizeof(hist));
+    sorted.reserve(demoframes.size());
+
+    for(const auto &frame : demoframes) {
+        sorted.push_back(frame.ms);
+        frametotal += frame.ms;
+
+        for(i = 0; i < NUMHISTBUCKETS - 1; i++) {
+            if(frame.ms < histbuckets[i]) {
+                break;
+            }
+        }
+
+        hist[i]++;
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+
+    low1 = G_TimeDemoLows(sorted, 0.01f);
+    low01 = G_TimeDemoLows(sorted, 0.001f);
+
+    CON_Printf(WHITE, "  average:  %8.2f fps (%.3f ms)\n",
+               1000.0 * demoframes.size() / frametotal, frametotal / demoframes.size());
+    CON_Printf(WHITE, "  1%% low:   %8.2f fps (%.3f ms)\n", 1000.0f / low1, low1);
+    CON_Printf(WHITE, "  0.1%% low: %8.2f fps (%.3f ms)\n", 1000.0f / low01, low01);
+    CON_Printf(WHITE, "  min/max:  %.3f / %.3f ms\n", sorted.front(), sorted.back());
+
+    for(i = 0; i < NUMHISTBUCKETS; i++) {
+        char bar[41];
+        int len = (int)((double)hist[i] * 40 / demoframes.size() + 0.5);
+
+        for(p = 0; p < len; p++) {
+            bar[p] = '#';
+        }
+
+        bar[len] = 0;
+
+        if(i < NUMHISTBUCKETS - 1) {
+            CON_Printf(WHITE, "  < %5.1f ms: %6i %s\n", histbuckets[i], hist[i], bar);
+        }
+        else {
+            CON_Printf(WHITE, "  >=%5.1f ms: %6i %s\n", histbuckets[i - 1], hist[i], bar);
+        }
+    }
+
+    p = M_CheckParm("-timedemocsv");
+    if(p && p < myargc-1) {
+        G_TimeDemoWriteCSV(myargv[p+1]);
+    }
+}
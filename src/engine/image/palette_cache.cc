@@ -1,3 +1,4 @@
+#include <mutex>
 #include <unordered_map>
 
 #include "palette_cache.hh"
@@ -16,6 +17,7 @@ using HashMap = std::unordered_map<Key, T, Hash, KeyEq>;
 
 namespace {
   HashMap<String, Palette> palettes_;
+  std::mutex palettes_mutex_;
 
   Palette default_palette_()
   {
@@ -34,6 +36,8 @@ namespace {
 
 Palette cache::palette(StringView name)
 {
+    std::lock_guard<std::mutex> lock { palettes_mutex_ };
+
     std::string sname { name };
     auto it = palettes_.find(sname);
     if (it != palettes_.cend())
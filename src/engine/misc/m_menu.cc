@@ -4666,6 +4666,9 @@ static void M_DrawCursor(int x, int y) {
         float factor;
         float scale;
 
+        // keep the cursor on top of any batched menu text
+        Draw_FlushBatch();
+
         scale = ((m_cursorscale + 25.0f) / 100.0f);
         gfxIdx = GL_BindGfxTexture("CURSOR", true);
         factor = (((float)SCREENHEIGHT * video_ratio) / (float)video_width) / scale;
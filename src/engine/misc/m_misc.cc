@@ -40,6 +40,7 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#include <filesystem>
 #include <fstream>
 #include <algorithm>
 
@@ -49,6 +50,7 @@
 #include "z_zone.h"
 #include "g_local.h"
 #include "p_saveg.h"
+#include "gl_readback.h"
 
 //
 // M_CheckParm
@@ -282,33 +284,56 @@ void M_LoadDefaults(void) {
 }
 
 //
-// M_ScreenShot
+// M_NextScreenShot
+// The directory is only scanned for the first screenshot,
+// after that the number just counts up
 //
 
-void M_ScreenShot(void) {
-    String name;
-    int     shotnum=0;
+static int M_NextScreenShot(void) {
+    static int nextshot = -1;
 
-    while(shotnum < 1000) {
-        name = fmt::format("sshot{:03d}.png", shotnum);
-        std::ifstream f(name, std::ios_base::binary);
+    if(nextshot < 0) {
+        std::error_code ec;
 
-        if (!f.is_open())
-            break;
+        nextshot = 0;
 
-        shotnum++;
+        for(const auto &entry : std::filesystem::directory_iterator(".", ec)) {
+            auto name = entry.path().filename().string();
+
+            if(name.size() == 12 && !name.compare(0, 5, "sshot") && !name.compare(8, 4, ".png") &&
+                    isdigit(name[5]) && isdigit(name[6]) && isdigit(name[7])) {
+                nextshot = MAX(nextshot, datoi(name.c_str() + 5) + 1);
+            }
+        }
     }
 
+    return nextshot++;
+}
+
+//
+// M_ScreenShot
+// The image is read back and saved in the background
+//
+
+void M_ScreenShot(void) {
+    String  name;
+    int     shotnum;
+
+    shotnum = M_NextScreenShot();
+
     if(shotnum >= 1000) {
         return;
     }
 
-    std::ofstream file(name, std::ios_base::binary);
+    name = fmt::format("sshot{:03d}.png", shotnum);
+
+    GL_ReadScreenAsync([name](Image &image) -> String {
+        std::ofstream file(name, std::ios_base::binary);
 
-    auto image = GL_GetScreenBuffer(0, 0, video_width, video_height);
-    image.save(file, ImageFormat::png);
+        image.save(file, ImageFormat::png);
 
-    log::info("Saved Screenshot {}", name);
+        return fmt::format("Saved Screenshot {}", name);
+    });
 }
 
 //
@@ -320,9 +345,7 @@ void M_ScreenShot(void) {
 int M_CacheThumbNail(byte** data) {
     char* tbn;
 
-    auto image = GL_GetScreenBuffer(0, 0, video_width, video_height);
-    // image.align(1);
-    image.scale(128, 128);
+    auto image = GL_ReadScreenThumbnail(128, 128);
 
     tbn = new char[SAVEGAMETBSIZE];
 
@@ -0,0 +1,487 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Scoped zone profiler.
+//    Every thread that enters a zone gets its own ring buffer of
+//    finished zones, timed with a monotonic nanosecond clock.
+//    "captureprofile" saves a number of frames as a Chrome trace
+//    (chrome://tracing or ui.perfetto.dev) and "profilegraph" draws
+//    the last few seconds of frames as a stacked bar graph.
+//
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "m_profile.h"
+#include "i_system.h"
+#include "con_console.h"
+#include "g_actions.h"
+#include "gl_main.h"
+#include "gl_draw.h"
+#include "dgl.h"
+
+#define PROFILE_RINGSIZE    65536   // zones per thread, power of two
+#define PROFILE_GRAPHFRAMES 128
+#define PROFILE_GRAPHZONES  8
+
+typedef struct {
+    const char  *name;
+    uint64      start;
+    uint64      end;
+    int         depth;
+} profileevent_t;
+
+typedef struct {
+    std::string             name;
+    int                     tid;
+    int                     depth;
+    std::atomic<uint64>     count;
+    std::mutex              lock;       // held while writing or copying events
+    profileevent_t          events[PROFILE_RINGSIZE];
+} profilethread_t;
+
+typedef struct {
+    float   total;
+    float   zones[PROFILE_GRAPHZONES];
+} profileframe_t;
+
+std::atomic<bool> profileactive(false);
+
+static std::mutex                       profilemutex;
+static std::vector<profilethread_t*>    profilethreads;
+static thread_local profilethread_t     *profilethread = NULL;
+
+static profilethread_t  *mainthread = NULL;
+static uint64           lastframe = 0;
+static uint64           lastframecount = 0;
+
+// capture state, only touched by the main thread
+static int              capturerequest = 0;
+static int              captureframes = 0;
+static uint64           capturestart = 0;
+static std::vector<uint64> capturecounts;
+static std::string      capturefile;
+
+// rolling graph
+static dboolean         showgraph = false;
+static const char       *graphnames[PROFILE_GRAPHZONES];
+static int              numgraphnames = 0;
+static profileframe_t   graphframes[PROFILE_GRAPHFRAMES];
+static int              graphhead = 0;
+
+static const rcolor graphcolors[PROFILE_GRAPHZONES] = {
+    D_RGBA(0xff, 0x50, 0x50, 0xc0),
+    D_RGBA(0x50, 0xff, 0x50, 0xc0),
+    D_RGBA(0x50, 0x80, 0xff, 0xc0),
+    D_RGBA(0xff, 0xff, 0x50, 0xc0),
+    D_RGBA(0xff, 0x50, 0xff, 0xc0),
+    D_RGBA(0x50, 0xff, 0xff, 0xc0),
+    D_RGBA(0xff, 0xa0, 0x40, 0xc0),
+    D_RGBA(0xa0, 0xa0, 0xff, 0xc0)
+};
+
+//
+// M_ProfileClock
+//
+
+static uint64 M_ProfileClock(void) {
+    return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//
+// M_ProfileThread
+// Ring buffers are never freed, threads that exit
+// keep their zones around for the next capture
+//
+
+static profilethread_t *M_ProfileThread(void) {
+    if(!profilethread) {
+        std::lock_guard<std::mutex> lock(profilemutex);
+
+        profilethread = new profilethread_t;
+        profilethread->tid = (int)profilethreads.size();
+        profilethread->name = profilethread->tid ? "thread " + std::to_string(profilethread->tid) : "main";
+        profilethread->depth = 0;
+        profilethread->count = 0;
+
+        profilethreads.push_back(profilethread);
+    }
+
+    return profilethread;
+}
+
+//
+// M_ProfileBegin
+//
+
+uint64 M_ProfileBegin(void) {
+    M_ProfileThread()->depth++;
+    return M_ProfileClock();
+}
+
+//
+// M_ProfileEnd
+//
+
+void M_ProfileEnd(const char *name, uint64 start) {
+    profilethread_t *thread = M_ProfileThread();
+    std::lock_guard<std::mutex> lock(thread->lock);
+    uint64 count = thread->count.load(std::memory_order_relaxed);
+    profileevent_t *ev = &thread->events[count & (PROFILE_RINGSIZE - 1)];
+
+    ev->name = name;
+    ev->start = start;
+    ev->end = M_ProfileClock();
+    ev->depth = --thread->depth;
+
+    thread->count.store(count + 1, std::memory_order_release);
+}
+
+//
+// M_ProfileThreadName
+// Shown as the track name in traces
+//
+
+void M_ProfileThreadName(const char *name) {
+    M_ProfileThread()->name = name;
+}
+
+//
+// M_ProfileSetActive
+//
+
+static void M_ProfileSetActive(void) {
+    profileactive = (showgraph || capturerequest || captureframes);
+}
+
+//
+// M_ProfileWriteTrace
+// Chrome trace event format, one complete ("X") event per zone.
+// Other threads keep writing into their rings, so the events are
+// copied out under the thread's lock before anything is printed.
+//
+
+static void M_ProfileWriteTrace(uint64 start, uint64 end) {
+    FILE *f;
+    dboolean first = true;
+    int numevents = 0;
+    std::vector<profileevent_t> events;
+    size_t t;
+
+    if(!(f = fopen(capturefile.c_str(), "w"))) {
+        CON_Warnf("Couldn't write %s\n", capturefile.c_str());
+        return;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    std::lock_guard<std::mutex> lock(profilemutex);
+
+    for(t = 0; t < profilethreads.size(); t++) {
+        profilethread_t *thread = profilethreads[t];
+        uint64 first_event = t < capturecounts.size() ? capturecounts[t] : 0;
+        uint64 count;
+        uint64 i;
+
+        events.clear();
+
+        {
+            std::lock_guard<std::mutex> threadlock(thread->lock);
+
+            count = thread->count.load(std::memory_order_relaxed);
+
+            if(count - first_event > PROFILE_RINGSIZE) {
+                CON_Warnf("captureprofile: %s overflowed, oldest zones dropped\n", thread->name.c_str());
+                first_event = count - PROFILE_RINGSIZE;
+            }
+
+            for(i = first_event; i < count; i++) {
+                events.push_back(thread->events[i & (PROFILE_RINGSIZE - 1)]);
+            }
+        }
+
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", thread->tid, thread->name.c_str());
+        first = false;
+
+        for(const auto &ev : events) {
+            if(ev.start < start || ev.end > end) {
+                continue;
+            }
+
+            fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}",
+                    ev.name, thread->tid, (ev.start - start) / 1000.0, (ev.end - ev.start) / 1000.0);
+            numevents++;
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+
+    CON_Printf(WHITE, "Profile with %i zones written to %s\n", numevents, capturefile.c_str());
+}
+
+//
+// M_ProfileStartCapture
+//
+
+static void M_ProfileStartCapture(uint64 now) {
+    size_t i;
+
+    captureframes = capturerequest;
+    capturerequest = 0;
+    capturestart = now;
+
+    std::lock_guard<std::mutex> lock(profilemutex);
+
+    capturecounts.resize(profilethreads.size());
+
+    for(i = 0; i < profilethreads.size(); i++) {
+        capturecounts[i] = profilethreads[i]->count.load(std::memory_order_acquire);
+    }
+}
+
+//
+// M_ProfileGraphFrame
+// Sums up the zones directly below the main loop
+//
+
+static void M_ProfileGraphFrame(uint64 now) {
+    profileframe_t *frame = &graphframes[graphhead];
+    uint64 count = mainthread->count.load(std::memory_order_relaxed);
+    uint64 i;
+    int j;
+
+    dmemset(frame, 0, sizeof(*frame));
+    frame->total = lastframe ? (now - lastframe) / 1000000.0f : 0;
+
+    if(count - lastframecount > PROFILE_RINGSIZE) {
+        lastframecount = count - PROFILE_RINGSIZE;
+    }
+
+    for(i = lastframecount; i < count; i++) {
+        const profileevent_t *ev = &mainthread->events[i & (PROFILE_RINGSIZE - 1)];
+
+        if(ev->depth != 1) {
+            continue;
+        }
+
+        for(j = 0; j < numgraphnames; j++) {
+            if(graphnames[j] == ev->name) {
+                break;
+            }
+        }
+
+        if(j == numgraphnames) {
+            if(numgraphnames == PROFILE_GRAPHZONES) {
+                continue;
+            }
+
+            graphnames[numgraphnames++] = ev->name;
+        }
+
+        frame->zones[j] += (ev->end - ev->start) / 1000000.0f;
+    }
+
+    graphhead = (graphhead + 1) & (PROFILE_GRAPHFRAMES - 1);
+}
+
+//
+// M_ProfileFrame
+// Called once per presented frame
+//
+
+void M_ProfileFrame(void) {
+    uint64 now;
+
+    if(!profileactive) {
+        lastframe = 0;
+        return;
+    }
+
+    now = M_ProfileClock();
+    mainthread = M_ProfileThread();
+
+    if(captureframes && --captureframes == 0) {
+        M_ProfileWriteTrace(capturestart, now);
+        M_ProfileSetActive();
+    }
+
+    if(capturerequest) {
+        M_ProfileStartCapture(now);
+    }
+
+    if(showgraph) {
+        M_ProfileGraphFrame(now);
+    }
+
+    lastframe = now;
+    lastframecount = mainthread->count.load(std::memory_order_relaxed);
+}
+
+//
+// M_ProfileDrawGraph
+// Newest frame on the right, the line marks 60 fps
+//
+
+void M_ProfileDrawGraph(void) {
+    const float scale = 0.35f;
+    const float height = 160.0f;
+    const float mspixel = height / 50.0f;
+    float x, y, bottom, left;
+    float avg[PROFILE_GRAPHZONES];
+    float avgtotal = 0;
+    int i;
+    int j;
+
+    if(!showgraph) {
+        return;
+    }
+
+    left = 8;
+    bottom = (SCREENHEIGHT / scale) - 16;
+
+    GL_SetOrthoScale(scale);
+    GL_SetOrtho(0);
+    GL_SetState(GLSTATE_BLEND, 1);
+    dglDisable(GL_TEXTURE_2D);
+
+    dglColor4ub(0, 0, 0, 128);
+    dglRectf(left, bottom - height, left + PROFILE_GRAPHFRAMES * 2, bottom);
+
+    dmemset(avg, 0, sizeof(avg));
+
+    for(i = 0; i < PROFILE_GRAPHFRAMES; i++) {
+        const profileframe_t *frame = &graphframes[(graphhead + i) & (PROFILE_GRAPHFRAMES - 1)];
+        float used = 0;
+
+        x = left + i * 2;
+        y = bottom;
+
+        for(j = 0; j < numgraphnames; j++) {
+            float h = MIN(frame->zones[j] * mspixel, y - (bottom - height));
+
+            dglColor4ubv((byte*)&graphcolors[j]);
+            dglRectf(x, y - h, x + 2, y);
+
+            y -= h;
+            used += frame->zones[j];
+            avg[j] += frame->zones[j];
+        }
+
+        // time not covered by any zone
+        if(frame->total > used) {
+            float h = MIN((frame->total - used) * mspixel, y - (bottom - height));
+
+            dglColor4ub(0x80, 0x80, 0x80, 0xc0);
+            dglRectf(x, y - h, x + 2, y);
+        }
+
+        avgtotal += frame->total;
+    }
+
+    dglColor4ub(0xff, 0xff, 0xff, 0xff);
+    dglBegin(GL_LINES);
+    dglVertex2f(left, bottom - 16.7f * mspixel);
+    dglVertex2f(left + PROFILE_GRAPHFRAMES * 2, bottom - 16.7f * mspixel);
+    dglEnd();
+
+    dglEnable(GL_TEXTURE_2D);
+    GL_SetState(GLSTATE_BLEND, 0);
+    GL_SetOrthoScale(1.0f);
+
+    x = left + PROFILE_GRAPHFRAMES * 2 + 8;
+    y = bottom - height;
+
+    Draw_Text((int)x, (int)y, WHITE, scale, false, "frame %.2fms", avgtotal / PROFILE_GRAPHFRAMES);
+    y += 16;
+
+    for(j = 0; j < numgraphnames; j++) {
+        Draw_Text((int)x, (int)y, graphcolors[j] | 0xff000000, scale, false, "%s %.2fms",
+                  graphnames[j], avg[j] / PROFILE_GRAPHFRAMES);
+        y += 16;
+    }
+}
+
+//
+// CMD_CaptureProfile
+//
+
+static CMD(CaptureProfile) {
+    char *path;
+
+    if(!param[0]) {
+        CON_Printf(WHITE, "Usage: captureprofile <frames> [file]\n");
+        return;
+    }
+
+    if(capturerequest || captureframes) {
+        CON_Printf(WHITE, "A profile is already being captured\n");
+        return;
+    }
+
+    if(param[1]) {
+        capturefile = param[1];
+    }
+    else if((path = I_GetUserFile("profile.json"))) {
+        capturefile = path;
+        free(path);
+    }
+    else {
+        capturefile = "profile.json";
+    }
+
+    capturerequest = MAX(datoi(param[0]), 1);
+    M_ProfileSetActive();
+
+    CON_Printf(WHITE, "Capturing %i frames\n", capturerequest);
+}
+
+//
+// CMD_ProfileGraph
+//
+
+static CMD(ProfileGraph) {
+    showgraph ^= 1;
+
+    numgraphnames = 0;
+    graphhead = 0;
+    dmemset(graphframes, 0, sizeof(graphframes));
+
+    M_ProfileSetActive();
+}
+
+//
+// M_ProfileInit
+//
+
+void M_ProfileInit(void) {
+    M_ProfileThread();
+
+    G_AddCommand("captureprofile", CMD_CaptureProfile, 0);
+    G_AddCommand("profilegraph", CMD_ProfileGraph, 0);
+}
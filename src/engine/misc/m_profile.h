@@ -0,0 +1,65 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __M_PROFILE_H__
+#define __M_PROFILE_H__
+
+#include <atomic>
+
+#include "doomtype.h"
+
+extern std::atomic<bool> profileactive;
+
+uint64  M_ProfileBegin(void);
+void    M_ProfileEnd(const char *name, uint64 start);
+void    M_ProfileThreadName(const char *name);
+void    M_ProfileFrame(void);
+void    M_ProfileDrawGraph(void);
+void    M_ProfileInit(void);
+
+//
+// Times the enclosing scope. Costs a single flag test
+// unless a capture or the graph is running. name must
+// be a string literal, only the pointer is kept.
+//
+
+class profilezone_t {
+    const char  *name;
+    uint64      start;
+
+public:
+    explicit profilezone_t(const char *zonename) :
+        name(zonename), start(profileactive.load(std::memory_order_relaxed) ? M_ProfileBegin() : 0) {}
+
+    ~profilezone_t() {
+        if(start) {
+            M_ProfileEnd(name, start);
+        }
+    }
+
+    profilezone_t(const profilezone_t&) = delete;
+    profilezone_t &operator=(const profilezone_t&) = delete;
+};
+
+#define PROFILE_CONCAT2(a, b)   a##b
+#define PROFILE_CONCAT(a, b)    PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(name)      profilezone_t PROFILE_CONCAT(profilezone_, __LINE__)(name)
+
+#endif
@@ -24,19 +24,31 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <stddef.h>
+
 #include "doomdef.h"
 #include "doomstat.h"
 #include "gl_main.h"
 #include "gl_texture.h"
 #include "con_console.h"
 #include "i_system.h"
+#include "z_zone.h"
+
+// indices and batched vertices start out with room for this many
+#define MININDICES      0x1000
 
-#define MAXINDICES  0x10000
+dword statindice = 0;
+dword statdrawcalls = 0;
 
-word statindice = 0;
+static dword indicecnt = 0;
+static dword maxindices = 0;
+static dword *drawIndices = NULL;
 
-static word indicecnt = 0;
-static word drawIndices[MAXINDICES];
+// while batching, indices from dglTriangle are offset by batchbase
+static dword batchbase = 0;
+static dword batchcount = 0;
+static dword maxbatch = 0;
+static vtx_t *batchVertex = NULL;
 
 extern cvar::BoolVar r_drawtris;
 
@@ -104,6 +116,29 @@ void dglSetVertex(vtx_t *vtx) {
     dgl_prevptr = vtx;
 }
 
+//
+// dglSetVertexBuffer
+// Reads vertices from a buffer object holding vtx_t's.
+// Set it back to 0 before using dglSetVertex again.
+//
+
+void dglSetVertexBuffer(rbuffer buffer) {
+#ifdef LOG_GLFUNC_CALLS
+    I_Printf("dglSetVertexBuffer(buffer=%u)\n", buffer);
+#endif
+
+    dglBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer);
+
+    if(buffer) {
+        dglTexCoordPointer(2, GL_FLOAT, sizeof(vtx_t), (void*)offsetof(vtx_t, tu));
+        dglVertexPointer(3, GL_FLOAT, sizeof(vtx_t), (void*)offsetof(vtx_t, x));
+        dglColorPointer(4, GL_UNSIGNED_BYTE, sizeof(vtx_t), (void*)offsetof(vtx_t, r));
+    }
+
+    // client pointers have to be set again either way
+    dgl_prevptr = NULL;
+}
+
 //
 // dglTriangle
 //
@@ -112,13 +147,14 @@ void dglTriangle(int v0, int v1, int v2) {
 #ifdef LOG_GLFUNC_CALLS
     I_Printf("dglTriangle(v0=%i, v1=%i, v2=%i)\n", v0, v1, v2);
 #endif
-    if(indicecnt + 3 >= MAXINDICES) {
-        I_Error("Triangle indice overflow");
+    if(indicecnt + 3 > maxindices) {
+        maxindices = MAX(maxindices * 2, MININDICES);
+        drawIndices = (dword*)Z_Realloc(drawIndices, maxindices * sizeof(dword), PU_STATIC, NULL);
     }
 
-    drawIndices[indicecnt++] = v0;
-    drawIndices[indicecnt++] = v1;
-    drawIndices[indicecnt++] = v2;
+    drawIndices[indicecnt++] = batchbase + v0;
+    drawIndices[indicecnt++] = batchbase + v1;
+    drawIndices[indicecnt++] = batchbase + v2;
 }
 
 //
@@ -130,15 +166,13 @@ void dglDrawGeometry(dword count, vtx_t *vtx) {
     I_Printf("dglDrawGeometry(count=0x%x, vtx=0x%p)\n", count, vtx);
 #endif
 
-    if(GLAD_GL_EXT_compiled_vertex_array) {
-        dglLockArraysEXT(0, count);
+    if(!indicecnt) {
+        return;
     }
 
-    dglDrawElements(GL_TRIANGLES, indicecnt, GL_UNSIGNED_SHORT, drawIndices);
-
-    if(GLAD_GL_EXT_compiled_vertex_array) {
-        dglUnlockArraysEXT();
-    }
+    // the range saves the driver from scanning the
+    // indices to find out how much of the arrays to read
+    dglDrawRangeElements(GL_TRIANGLES, 0, count - 1, indicecnt, GL_UNSIGNED_INT, drawIndices);
 
     if(r_drawtris) {
         dword j = 0;
@@ -162,15 +196,7 @@ void dglDrawGeometry(dword count, vtx_t *vtx) {
         dglPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         dglDepthRange(0.0f, 0.0f);
 
-        if(GLAD_GL_EXT_compiled_vertex_array) {
-            dglLockArraysEXT(0, count);
-        }
-
-        dglDrawElements(GL_TRIANGLES, indicecnt, GL_UNSIGNED_SHORT, drawIndices);
-
-        if(GLAD_GL_EXT_compiled_vertex_array) {
-            dglUnlockArraysEXT();
-        }
+        dglDrawRangeElements(GL_TRIANGLES, 0, count - 1, indicecnt, GL_UNSIGNED_INT, drawIndices);
 
         dglDepthRange(0.0f, 1.0f);
         dglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -184,11 +210,70 @@ void dglDrawGeometry(dword count, vtx_t *vtx) {
 
     if(devparm) {
         statindice += indicecnt;
+        statdrawcalls++;
     }
 
     indicecnt = 0;
 }
 
+//
+// dglBeginBatch
+// Collects geometry from any number of callers that share
+// the same state, so that it can all be drawn at once
+//
+
+void dglBeginBatch(void) {
+#ifdef LOG_GLFUNC_CALLS
+    I_Printf("dglBeginBatch\n");
+#endif
+    batchbase = 0;
+    batchcount = 0;
+    indicecnt = 0;
+}
+
+//
+// dglBatchVertex
+// Returns room for count vertices. dglTriangle indices that follow are
+// relative to the returned vertices. The pointer is only good until the
+// next call, as the batch moves when it grows.
+//
+
+vtx_t *dglBatchVertex(dword count) {
+#ifdef LOG_GLFUNC_CALLS
+    I_Printf("dglBatchVertex(count=0x%x)\n", count);
+#endif
+    if(batchcount + count > maxbatch) {
+        while(batchcount + count > maxbatch) {
+            maxbatch = MAX(maxbatch * 2, MININDICES);
+        }
+
+        batchVertex = (vtx_t*)Z_Realloc(batchVertex, maxbatch * sizeof(vtx_t), PU_STATIC, NULL);
+    }
+
+    batchbase = batchcount;
+    batchcount += count;
+
+    return &batchVertex[batchbase];
+}
+
+//
+// dglEndBatch
+//
+
+void dglEndBatch(void) {
+#ifdef LOG_GLFUNC_CALLS
+    I_Printf("dglEndBatch\n");
+#endif
+    batchbase = 0;
+
+    if(batchcount) {
+        dglSetVertex(batchVertex);
+        dglDrawGeometry(batchcount, batchVertex);
+    }
+
+    batchcount = 0;
+}
+
 //
 // dglViewFrustum
 //
@@ -42,8 +42,12 @@ void dglLogError(const char *message, const char *file, int line);
 //
 
 void dglSetVertex(vtx_t *vtx);
+void dglSetVertexBuffer(rbuffer buffer);
 void dglTriangle(int v0, int v1, int v2);
 void dglDrawGeometry(dword count, vtx_t *vtx);
+void dglBeginBatch(void);
+vtx_t *dglBatchVertex(dword count);
+void dglEndBatch(void);
 void dglViewFrustum(int width, int height, rfloat fovy, rfloat znear);
 void dglSetVertexColor(vtx_t *v, rcolor c, word count);
 void dglGetColorf(rcolor color, float* argb);
@@ -124,6 +128,7 @@ void dglTexCombReplaceAlpha(GLenum t);
 #define dglDrawBuffer(mode) glDrawBuffer(mode)
 #define dglDrawElements(mode, count, type, indices) glDrawElements(mode, count, type, indices)
 #define dglDrawPixels(width, height, format, type, pixels) glDrawPixels(width, height, format, type, pixels)
+#define dglDrawRangeElements(mode, start, end, count, type, indices) glDrawRangeElements(mode, start, end, count, type, indices)
 #define dglEdgeFlag(flag) glEdgeFlag(flag)
 #define dglEdgeFlagPointer(stride, pointer) glEdgeFlagPointer(stride, pointer)
 #define dglEdgeFlagv(flag) glEdgeFlagv(flag)
@@ -470,5 +475,58 @@ void dglTexCombReplaceAlpha(GLenum t);
 #define dglGetBufferParameterivARB(target, pname, params) glGetBufferParameterivARB(target, pname, params)
 #define dglGetBufferPointervARB(target, pname, params) glGetBufferPointervARB(target, pname, params)
 
+//
+// GL_EXT_framebuffer_object
+//
+
+#define dglIsRenderbufferEXT(renderbuffer) glIsRenderbufferEXT(renderbuffer)
+#define dglBindRenderbufferEXT(target, renderbuffer) glBindRenderbufferEXT(target, renderbuffer)
+#define dglDeleteRenderbuffersEXT(n, renderbuffers) glDeleteRenderbuffersEXT(n, renderbuffers)
+#define dglGenRenderbuffersEXT(n, renderbuffers) glGenRenderbuffersEXT(n, renderbuffers)
+#define dglRenderbufferStorageEXT(target, internalformat, width, height) glRenderbufferStorageEXT(target, internalformat, width, height)
+#define dglGetRenderbufferParameterivEXT(target, pname, params) glGetRenderbufferParameterivEXT(target, pname, params)
+#define dglIsFramebufferEXT(framebuffer) glIsFramebufferEXT(framebuffer)
+#define dglBindFramebufferEXT(target, framebuffer) glBindFramebufferEXT(target, framebuffer)
+#define dglDeleteFramebuffersEXT(n, framebuffers) glDeleteFramebuffersEXT(n, framebuffers)
+#define dglGenFramebuffersEXT(n, framebuffers) glGenFramebuffersEXT(n, framebuffers)
+#define dglCheckFramebufferStatusEXT(target) glCheckFramebufferStatusEXT(target)
+#define dglFramebufferTexture2DEXT(target, attachment, textarget, texture, level) glFramebufferTexture2DEXT(target, attachment, textarget, texture, level)
+#define dglFramebufferRenderbufferEXT(target, attachment, renderbuffertarget, renderbuffer) glFramebufferRenderbufferEXT(target, attachment, renderbuffertarget, renderbuffer)
+#define dglGetFramebufferAttachmentParameterivEXT(target, attachment, pname, params) glGetFramebufferAttachmentParameterivEXT(target, attachment, pname, params)
+#define dglGenerateMipmapEXT(target) glGenerateMipmapEXT(target)
+
+//
+// GL_ARB_occlusion_query
+//
+
+#define dglGenQueriesARB(n, ids) glGenQueriesARB(n, ids)
+#define dglDeleteQueriesARB(n, ids) glDeleteQueriesARB(n, ids)
+#define dglIsQueryARB(id) glIsQueryARB(id)
+#define dglBeginQueryARB(target, id) glBeginQueryARB(target, id)
+#define dglEndQueryARB(target) glEndQueryARB(target)
+#define dglGetQueryivARB(target, pname, params) glGetQueryivARB(target, pname, params)
+#define dglGetQueryObjectivARB(id, pname, params) glGetQueryObjectivARB(id, pname, params)
+#define dglGetQueryObjectuivARB(id, pname, params) glGetQueryObjectuivARB(id, pname, params)
+
+//
+// GL_ARB_timer_query
+//
+
+#define dglQueryCounter(id, target) glQueryCounter(id, target)
+#define dglGetQueryObjecti64v(id, pname, params) glGetQueryObjecti64v(id, pname, params)
+#define dglGetQueryObjectui64v(id, pname, params) glGetQueryObjectui64v(id, pname, params)
+
+//
+// GL_ARB_sync
+//
+
+#define dglFenceSync(condition, flags) glFenceSync(condition, flags)
+#define dglIsSync(sync) glIsSync(sync)
+#define dglDeleteSync(sync) glDeleteSync(sync)
+#define dglClientWaitSync(sync, flags, timeout) glClientWaitSync(sync, flags, timeout)
+#define dglWaitSync(sync, flags, timeout) glWaitSync(sync, flags, timeout)
+#define dglGetInteger64v(pname, data) glGetInteger64v(pname, data)
+#define dglGetSynciv(sync, pname, bufSize, length, values) glGetSynciv(sync, pname, bufSize, length, values)
+
 #endif // __DGL_H__
 
@@ -0,0 +1,452 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Offline frame capture.
+//    Every presented frame is written out as raw video, either as a
+//    YUV4MPEG2 stream or as a run of binary PPM images, to a file or
+//    to a command's standard input. Frames are read into a pair of
+//    pixel buffer objects in turn, so the previous frame is copied out
+//    while the GPU is still reading the current one, and encoding and
+//    writing happen on a worker thread.
+//
+//-----------------------------------------------------------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+
+#include "doomdef.h"
+#include "gl_main.h"
+#include "gl_capture.h"
+#include "con_console.h"
+#include "dgl.h"
+#include "core/cvar.hh"
+
+#ifdef _WIN32
+#define popen   _popen
+#define pclose  _pclose
+#define CAPTUREPIPEMODE "wb"
+#else
+#define CAPTUREPIPEMODE "w"
+#endif
+
+// frames that may wait on the writer before rendering stalls
+#define CAPTUREQUEUE    4
+
+extern int video_width;
+extern int video_height;
+
+extern cvar::BoolVar r_dynamicres;
+
+static FILE             *capturefile = NULL;
+static dboolean         capturepipe;
+static dboolean         captureppm;
+static int              capturewidth;
+static int              captureheight;
+static int              captureframes;
+static int              capturebuffers;
+static rbuffer          capturepbo[2];
+static bool             olddynamicres;
+static std::atomic<bool> captureerror(false);
+
+static std::mutex               capturemutex;
+static std::condition_variable  capturecond;
+static std::condition_variable  capturefreecond;
+static std::deque<byte*>        capturequeue;
+static std::vector<byte*>       capturefree;
+
+//
+// Queued frames are still written if the game
+// exits in the middle of a capture
+//
+
+static struct captureworker_t {
+    std::thread thread;
+    bool quit = false;
+
+    void stop() {
+        if(!thread.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(capturemutex);
+            quit = true;
+        }
+
+        capturecond.notify_all();
+        thread.join();
+        quit = false;
+    }
+
+    ~captureworker_t() {
+        stop();
+
+        if(capturefile) {
+            if(capturepipe) {
+                pclose(capturefile);
+            }
+            else {
+                fclose(capturefile);
+            }
+        }
+    }
+} captureworker;
+
+//
+// CaptureWriteY4M
+// Full range BT.601, with chroma averaged over 2x2 blocks
+//
+
+static dboolean CaptureWriteY4M(const byte *rgb, std::vector<byte> &yuv) {
+    size_t lumasize = (size_t)capturewidth * captureheight;
+    size_t chromasize = lumasize / 4;
+    size_t pitch = (size_t)capturewidth * 3;
+    byte *luma, *cb, *cr;
+    int x, y;
+
+    yuv.resize(lumasize + chromasize * 2);
+    luma = yuv.data();
+    cb = luma + lumasize;
+    cr = cb + chromasize;
+
+    // rows come from OpenGL bottom up
+    for(y = 0; y < captureheight; y++) {
+        const byte *src = rgb + pitch * (captureheight - 1 - y);
+
+        for(x = 0; x < capturewidth; x++, src += 3) {
+            *luma++ = (byte)((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+        }
+    }
+
+    for(y = 0; y < captureheight; y += 2) {
+        const byte *row0 = rgb + pitch * (captureheight - 1 - y);
+        const byte *row1 = row0 - pitch;
+
+        for(x = 0; x < capturewidth; x += 2, row0 += 6, row1 += 6) {
+            int r = row0[0] + row0[3] + row1[0] + row1[3];
+            int g = row0[1] + row0[4] + row1[1] + row1[4];
+            int b = row0[2] + row0[5] + row1[2] + row1[5];
+
+            *cb++ = (byte)MIN((-43 * r - 85 * g + 128 * b + 512 * 256 + 512) >> 10, 255);
+            *cr++ = (byte)MIN((128 * r - 107 * g - 21 * b + 512 * 256 + 512) >> 10, 255);
+        }
+    }
+
+    return fwrite("FRAME\n", 1, 6, capturefile) == 6 &&
+           fwrite(yuv.data(), 1, yuv.size(), capturefile) == yuv.size();
+}
+
+//
+// CaptureWritePPM
+//
+
+static dboolean CaptureWritePPM(const byte *rgb) {
+    size_t pitch = (size_t)capturewidth * 3;
+    int y;
+
+    if(fprintf(capturefile, "P6\n%i %i\n255\n", capturewidth, captureheight) < 0) {
+        return false;
+    }
+
+    for(y = captureheight - 1; y >= 0; y--) {
+        if(fwrite(rgb + pitch * y, 1, pitch, capturefile) != pitch) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//
+// CaptureWorker
+//
+
+static void CaptureWorker(void) {
+    std::vector<byte> yuv;
+
+    for(;;) {
+        byte *frame;
+        dboolean ok;
+
+        {
+            std::unique_lock<std::mutex> lock(capturemutex);
+
+            capturecond.wait(lock, [] { return captureworker.quit || !capturequeue.empty(); });
+
+            if(capturequeue.empty()) {
+                return;
+            }
+
+            frame = capturequeue.front();
+            capturequeue.pop_front();
+        }
+
+        // keep draining the queue after an error so rendering never blocks
+        if(!captureerror) {
+            ok = captureppm ? CaptureWritePPM(frame) : CaptureWriteY4M(frame, yuv);
+
+            if(!ok) {
+                captureerror = true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(capturemutex);
+            capturefree.push_back(frame);
+        }
+
+        capturefreecond.notify_one();
+    }
+}
+
+//
+// CaptureGetBuffer
+// Waits for the writer when it has fallen too far behind
+//
+
+static byte *CaptureGetBuffer(void) {
+    std::unique_lock<std::mutex> lock(capturemutex);
+    byte *frame;
+
+    if(capturefree.empty() && capturebuffers < CAPTUREQUEUE) {
+        capturebuffers++;
+        return new byte[(size_t)capturewidth * captureheight * 3];
+    }
+
+    capturefreecond.wait(lock, [] { return !capturefree.empty(); });
+
+    frame = capturefree.back();
+    capturefree.pop_back();
+
+    return frame;
+}
+
+//
+// CaptureQueueBuffer
+//
+
+static void CaptureQueueBuffer(byte *frame) {
+    {
+        std::lock_guard<std::mutex> lock(capturemutex);
+        capturequeue.push_back(frame);
+    }
+
+    capturecond.notify_one();
+}
+
+//
+// CaptureQueuePBO
+// Copies a finished frame out of a pixel buffer object
+//
+
+static void CaptureQueuePBO(rbuffer pbo) {
+    const byte *src;
+
+    dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, pbo);
+
+    if((src = (const byte*)dglMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB))) {
+        byte *frame = CaptureGetBuffer();
+
+        dmemcpy(frame, src, (size_t)capturewidth * captureheight * 3);
+        dglUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+        CaptureQueueBuffer(frame);
+    }
+
+    dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+}
+
+//
+// GL_BeginCapture
+// Opens the output, a name starting with '|' is run as a command.
+// Frames are written at framespertic * TICRATE per second.
+//
+
+dboolean GL_BeginCapture(const char *name, int framespertic, dboolean ppm) {
+    if(!usingGL) {
+        CON_Warnf("Frame capture needs OpenGL\n");
+        return false;
+    }
+
+    if(capturefile) {
+        GL_EndCapture();
+    }
+
+    if(name[0] == '|') {
+#ifndef _WIN32
+        // let a failed write report the error instead of killing us
+        signal(SIGPIPE, SIG_IGN);
+#endif
+        capturefile = popen(name + 1, CAPTUREPIPEMODE);
+        capturepipe = true;
+    }
+    else {
+        capturefile = fopen(name, "wb");
+        capturepipe = false;
+    }
+
+    if(!capturefile) {
+        CON_Warnf("Couldn't open %s for frame capture\n", name);
+        return false;
+    }
+
+    captureppm = ppm;
+    captureframes = 0;
+    captureerror = false;
+
+    // 4:2:0 chroma needs even dimensions
+    capturewidth = ppm ? video_width : (video_width & ~1);
+    captureheight = ppm ? video_height : (video_height & ~1);
+
+    if(!ppm) {
+        fprintf(capturefile, "YUV4MPEG2 W%i H%i F%i:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n",
+                capturewidth, captureheight, framespertic * TICRATE);
+    }
+
+    if(GLAD_GL_ARB_pixel_buffer_object && GLAD_GL_ARB_vertex_buffer_object) {
+        int i;
+
+        dglGenBuffersARB(2, capturepbo);
+
+        for(i = 0; i < 2; i++) {
+            dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, capturepbo[i]);
+            dglBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, (size_t)capturewidth * captureheight * 3,
+                             NULL, GL_STREAM_READ_ARB);
+        }
+
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+    }
+
+    // the resolution has to stay put for the output to be reproducible
+    olddynamicres = *r_dynamicres;
+    r_dynamicres = false;
+
+    captureworker.thread = std::thread(CaptureWorker);
+
+    CON_Printf(WHITE, "Capturing %ix%i at %i fps to %s\n",
+               capturewidth, captureheight, framespertic * TICRATE, name);
+
+    return true;
+}
+
+//
+// GL_CaptureFrame
+// Called after a frame has been drawn, before it is presented.
+// The frame before it is handed to the writer at the same time.
+//
+
+void GL_CaptureFrame(void) {
+    int pack;
+
+    if(!capturefile) {
+        return;
+    }
+
+    if(captureerror) {
+        CON_Warnf("Frame capture stopped, the output couldn't be written\n");
+        GL_EndCapture();
+        return;
+    }
+
+    if(video_width < capturewidth || video_height < captureheight) {
+        CON_Warnf("Frame capture stopped, the screen resolution changed\n");
+        GL_EndCapture();
+        return;
+    }
+
+    dglGetIntegerv(GL_PACK_ALIGNMENT, &pack);
+    dglPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    if(capturepbo[0]) {
+        int cur = captureframes & 1;
+
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, capturepbo[cur]);
+        dglReadPixels(0, 0, capturewidth, captureheight, GL_RGB, GL_UNSIGNED_BYTE, 0);
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+        if(captureframes > 0) {
+            CaptureQueuePBO(capturepbo[cur ^ 1]);
+        }
+    }
+    else {
+        byte *frame = CaptureGetBuffer();
+
+        dglReadPixels(0, 0, capturewidth, captureheight, GL_RGB, GL_UNSIGNED_BYTE, frame);
+        CaptureQueueBuffer(frame);
+    }
+
+    dglPixelStorei(GL_PACK_ALIGNMENT, pack);
+
+    captureframes++;
+}
+
+//
+// GL_EndCapture
+// Writes out the last frame and waits for the writer to finish
+//
+
+void GL_EndCapture(void) {
+    if(!capturefile) {
+        return;
+    }
+
+    if(capturepbo[0]) {
+        if(captureframes > 0) {
+            CaptureQueuePBO(capturepbo[(captureframes - 1) & 1]);
+        }
+
+        dglDeleteBuffersARB(2, capturepbo);
+        capturepbo[0] = capturepbo[1] = 0;
+    }
+
+    captureworker.stop();
+
+    if(capturepipe) {
+        pclose(capturefile);
+    }
+    else {
+        fclose(capturefile);
+    }
+
+    capturefile = NULL;
+
+    for(auto frame : capturefree) {
+        delete[] frame;
+    }
+
+    capturefree.clear();
+    capturebuffers = 0;
+
+    r_dynamicres = olddynamicres;
+
+    if(captureerror) {
+        CON_Warnf("Frame capture failed after %i frames\n", captureframes);
+    }
+    else {
+        CON_Printf(WHITE, "%i frames captured\n", captureframes);
+    }
+}
+
@@ -33,22 +33,196 @@
 #include "gl_texture.h"
 #include "gl_draw.h"
 #include "r_main.h"
+#include "z_zone.h"
 
 //
-// Draw_GfxImage
+// 2D BATCHING
+//
+// Text and graphics quads are collected into runs that share a texture.
+// Outside of Draw_BeginBatch/Draw_EndBatch a run is drawn as soon as it
+// has been added. Inside, runs are kept in order until the batch is
+// flushed, so each one costs a single draw call no matter how many
+// strings went into it. Anything else drawn in the meantime ends up
+// underneath.
 //
 
-void Draw_GfxImage(int x, int y, const char* name, rcolor color, dboolean alpha) {
-    int gfxIdx = GL_BindGfxTexture(name, alpha);
+#define MAXDRAWRUNS     64
+
+typedef struct {
+    char        name[9];
+    dboolean    alpha;
+    dboolean    nearest;
+    int         first;
+    int         count;
+} drawrun_t;
+
+static drawrun_t    drawruns[MAXDRAWRUNS];
+static int          numdrawruns = 0;
+static vtx_t        *drawvtx = NULL;
+static int          numdrawvtx = 0;
+static int          maxdrawvtx = 0;
+static int          textbatch = 0;
+
+//
+// Draw_AddQuad
+// Coordinates are in unscaled screen units
+//
+
+static void Draw_AddQuad(const char *name, dboolean alpha, dboolean nearest,
+                         float x1, float y1, float x2, float y2,
+                         float tu1, float tv1, float tu2, float tv2, rcolor color) {
+    drawrun_t *run = numdrawruns ? &drawruns[numdrawruns - 1] : NULL;
+    vtx_t *v;
+
+    if(!run || run->alpha != alpha || run->nearest != nearest || dstrncmp(run->name, name, 8)) {
+        if(numdrawruns == MAXDRAWRUNS) {
+            Draw_FlushBatch();
+        }
+
+        run = &drawruns[numdrawruns++];
+        dstrncpy(run->name, name, 8);
+        run->name[8] = 0;
+        run->alpha = alpha;
+        run->nearest = nearest;
+        run->first = numdrawvtx;
+        run->count = 0;
+    }
+
+    if(numdrawvtx + 4 > maxdrawvtx) {
+        maxdrawvtx = MAX(maxdrawvtx * 2, 1024);
+        drawvtx = (vtx_t*)Z_Realloc(drawvtx, maxdrawvtx * sizeof(vtx_t), PU_STATIC, NULL);
+    }
+
+    v = &drawvtx[numdrawvtx];
+
+    v[0].x = x1;
+    v[0].y = y1;
+    v[0].tu = tu1;
+    v[0].tv = tv1;
+    v[1].x = x2;
+    v[1].y = y1;
+    v[1].tu = tu2;
+    v[1].tv = tv1;
+    v[2].x = x2;
+    v[2].y = y2;
+    v[2].tu = tu2;
+    v[2].tv = tv2;
+    v[3].x = x1;
+    v[3].y = y2;
+    v[3].tu = tu1;
+    v[3].tv = tv2;
+    v[0].z = v[1].z = v[2].z = v[3].z = 0.0f;
+
+    dglSetVertexColor(v, color, 4);
+
+    numdrawvtx += 4;
+    run->count += 4;
+
+    if(devparm) {
+        vertCount += 4;
+    }
+}
+
+//
+// Draw_FlushBatch
+// Draws every run collected so far
+//
 
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+void Draw_FlushBatch(void) {
+    float scale;
+    dboolean fill = false;
+    int i;
+    int j;
 
+    if(!numdrawruns) {
+        return;
+    }
+
+    scale = GL_GetOrthoScale();
+
+    GL_SetOrthoScale(1.0f);
+    GL_SetOrtho(0);
     GL_SetState(GLSTATE_BLEND, 1);
-    GL_SetupAndDraw2DQuad((float)x, (float)y,
-                          gfxwidth[gfxIdx], gfxheight[gfxIdx], 0, 1.0f, 0, 1.0f, color, 0);
+
+    if(!r_fillmode) {
+        dglEnable(GL_TEXTURE_2D);
+        dglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        r_fillmode = true;
+        fill = true;
+    }
+
+    for(i = 0; i < numdrawruns; i++) {
+        drawrun_t *run = &drawruns[i];
+        vtx_t *v = &drawvtx[run->first];
+
+        GL_BindGfxTexture(run->name, run->alpha);
+
+        dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
+        dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+
+        if(run->nearest) {
+            dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        }
+
+        dglSetVertex(v);
+
+        for(j = 0; j < run->count; j += 4) {
+            dglTriangle(j + 0, j + 1, j + 2);
+            dglTriangle(j + 0, j + 2, j + 3);
+        }
+
+        dglDrawGeometry(run->count, v);
+    }
+
+    GL_ResetViewport();
+
+    if(fill) {
+        dglDisable(GL_TEXTURE_2D);
+        dglPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        r_fillmode = false;
+    }
 
     GL_SetState(GLSTATE_BLEND, 0);
+    GL_SetOrthoScale(scale);
+
+    numdrawruns = 0;
+    numdrawvtx = 0;
+}
+
+//
+// Draw_BeginBatch
+//
+
+void Draw_BeginBatch(void) {
+    textbatch++;
+}
+
+//
+// Draw_EndBatch
+//
+
+void Draw_EndBatch(void) {
+    if(textbatch > 0 && --textbatch == 0) {
+        Draw_FlushBatch();
+    }
+}
+
+//
+// Draw_GfxImage
+//
+
+void Draw_GfxImage(int x, int y, const char* name, rcolor color, dboolean alpha) {
+    int gfxIdx = GL_BindGfxTexture(name, alpha);
+    float scale = GL_GetOrthoScale();
+
+    Draw_AddQuad(name, alpha, false, x * scale, y * scale,
+                 (x + gfxwidth[gfxIdx]) * scale, (y + gfxheight[gfxIdx]) * scale,
+                 0, 0, 1.0f, 1.0f, color);
+
+    if(!textbatch) {
+        Draw_FlushBatch();
+    }
 }
 
 //
@@ -107,8 +281,6 @@ void Draw_Sprite2D(int type, int rot, int frame, int x, int y,
 //
 //
 
-static vtx_t vtxstring[MAX_MESSAGE_SIZE];
-
 //
 // Draw_Text
 //
@@ -116,42 +288,26 @@ static vtx_t vtxstring[MAX_MESSAGE_SIZE];
 int Draw_Text(int x, int y, rcolor color, float scale,
               dboolean wrap, const char* string, ...) {
     int c;
-    int i;
-    int vi = 0;
     int    col;
     const float size = 0.03125f;
     float fcol, frow;
     int start = 0;
-    dboolean fill = false;
     char msg[MAX_MESSAGE_SIZE];
+    const char *text = string;
     va_list    va;
     const int ix = x;
 
-    va_start(va, string);
-    vsprintf(msg, string, va);
-    va_end(va);
-
-    GL_SetState(GLSTATE_BLEND, 1);
-
-    if(!r_fillmode) {
-        dglEnable(GL_TEXTURE_2D);
-        dglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        r_fillmode = true;
-        fill = true;
+    // most of the overlay is printed every frame, skip
+    // formatting for anything that doesn't need it
+    if(strchr(string, '%')) {
+        va_start(va, string);
+        vsnprintf(msg, sizeof(msg), string, va);
+        va_end(va);
+        text = msg;
     }
 
-    GL_BindGfxTexture("SFONT", true);
-
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
-
-    GL_SetOrthoScale(scale);
-    GL_SetOrtho(0);
-
-    dglSetVertex(vtxstring);
-
-    for(i = 0, vi = 0; i < dstrlen(msg); i++, vi += 4) {
-        c = toupper(msg[i]);
+    for(; *text; text++) {
+        c = toupper(*text);
         if(c == '\t') {
             while(x % 64) {
                 x++;
@@ -179,50 +335,19 @@ int Draw_Text(int x, int y, rcolor color, float scale,
             fcol = (col * size);
             frow = (start >= ST_FONTNUMSET) ? 0.5f : 0.0f;
 
-            vtxstring[vi + 0].x     = (float)x;
-            vtxstring[vi + 0].y     = (float)y;
-            vtxstring[vi + 0].tu    = fcol + 0.0015f;
-            vtxstring[vi + 0].tv    = frow + size;
-            vtxstring[vi + 1].x     = (float)x + ST_FONTWHSIZE;
-            vtxstring[vi + 1].y     = (float)y;
-            vtxstring[vi + 1].tu    = (fcol + size) - 0.0015f;
-            vtxstring[vi + 1].tv    = frow + size;
-            vtxstring[vi + 2].x     = (float)x + ST_FONTWHSIZE;
-            vtxstring[vi + 2].y     = (float)y + ST_FONTWHSIZE;
-            vtxstring[vi + 2].tu    = (fcol + size) - 0.0015f;
-            vtxstring[vi + 2].tv    = frow + 0.5f;
-            vtxstring[vi + 3].x     = (float)x;
-            vtxstring[vi + 3].y     = (float)y + ST_FONTWHSIZE;
-            vtxstring[vi + 3].tu    = fcol + 0.0015f;
-            vtxstring[vi + 3].tv    = frow + 0.5f;
-
-            dglSetVertexColor(vtxstring + vi, color, 4);
-
-            dglTriangle(vi + 0, vi + 1, vi + 2);
-            dglTriangle(vi + 0, vi + 2, vi + 3);
-
-            if(devparm) {
-                vertCount += 4;
-            }
-
-
+            Draw_AddQuad("SFONT", true, false,
+                         x * scale, y * scale,
+                         (x + ST_FONTWHSIZE) * scale, (y + ST_FONTWHSIZE) * scale,
+                         fcol + 0.0015f, frow + size,
+                         (fcol + size) - 0.0015f, frow + 0.5f, color);
         }
         x += ST_FONTWHSIZE;
     }
 
-    if(vi) {
-        dglDrawGeometry(vi, vtxstring);
-    }
-
-    GL_ResetViewport();
-
-    if(fill) {
-        dglDisable(GL_TEXTURE_2D);
-        dglPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        r_fillmode = false;
+    if(!textbatch) {
+        Draw_FlushBatch();
     }
 
-    GL_SetState(GLSTATE_BLEND, 0);
     GL_SetOrthoScale(1.0f);
 
     return x;
@@ -401,18 +526,14 @@ int Center_Text(const char* string) {
 int Draw_BigText(int x, int y, rcolor color, const char* string) {
     int c = 0;
     int i = 0;
-    int vi = 0;
     int index = 0;
-    float vx1 = 0.0f;
-    float vy1 = 0.0f;
-    float vx2 = 0.0f;
-    float vy2 = 0.0f;
     float tx1 = 0.0f;
     float tx2 = 0.0f;
     float ty1 = 0.0f;
     float ty2 = 0.0f;
     float smbwidth;
     float smbheight;
+    float scale;
     int pic;
 
     if(x <= -1) {
@@ -425,19 +546,9 @@ int Draw_BigText(int x, int y, rcolor color, const char* string) {
 
     smbwidth = (float)gfxwidth[pic];
     smbheight = (float)gfxheight[pic];
+    scale = GL_GetOrthoScale();
 
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
-
-    dglSetVertex(vtxstring);
-
-    GL_SetState(GLSTATE_BLEND, 1);
-    GL_SetOrtho(0);
-
-    for(i = 0, vi = 0; i < dstrlen(string); i++, vi += 4) {
-        vx1 = (float)x;
-        vy1 = (float)y;
-
+    for(i = 0; i < dstrlen(string); i++) {
         c = string[i];
         if(c == '\n' || c == '\t') {
             continue;    // villsa: safety check
@@ -509,56 +620,32 @@ int Draw_BigText(int x, int y, rcolor color, const char* string) {
                     index = SM_THERMO + 1;
                     break;
                 default:
+                    if(!textbatch) {
+                        Draw_FlushBatch();
+                    }
                     return 0;
                 }
             }
 
-            vx2 = vx1 + symboldata[index].w;
-            vy2 = vy1 - symboldata[index].h;
-
             tx1 = ((float)symboldata[index].x / smbwidth) + 0.001f;
             tx2 = (tx1 + (float)symboldata[index].w / smbwidth) - 0.002f;
 
             ty1 = ((float)symboldata[index].y / smbheight);
             ty2 = ty1 + (((float)symboldata[index].h / smbheight));
 
-            vtxstring[vi + 0].x     = vx1;
-            vtxstring[vi + 0].y     = vy1;
-            vtxstring[vi + 0].tu    = tx1;
-            vtxstring[vi + 0].tv    = ty2;
-            vtxstring[vi + 1].x     = vx2;
-            vtxstring[vi + 1].y     = vy1;
-            vtxstring[vi + 1].tu    = tx2;
-            vtxstring[vi + 1].tv    = ty2;
-            vtxstring[vi + 2].x     = vx2;
-            vtxstring[vi + 2].y     = vy2;
-            vtxstring[vi + 2].tu    = tx2;
-            vtxstring[vi + 2].tv    = ty1;
-            vtxstring[vi + 3].x     = vx1;
-            vtxstring[vi + 3].y     = vy2;
-            vtxstring[vi + 3].tu    = tx1;
-            vtxstring[vi + 3].tv    = ty1;
-
-            dglSetVertexColor(vtxstring + vi, color, 4);
-
-            dglTriangle(vi + 2, vi + 1, vi + 0);
-            dglTriangle(vi + 3, vi + 2, vi + 0);
-
-            if(devparm) {
-                vertCount += 4;
-            }
+            Draw_AddQuad("SYMBOLS", true, false,
+                         x * scale, (y - symboldata[index].h) * scale,
+                         (x + symboldata[index].w) * scale, y * scale,
+                         tx1, ty1, tx2, ty2, color);
 
             x += symboldata[index].w;
         }
     }
 
-    if(vi) {
-        dglDrawGeometry(vi, vtxstring);
+    if(!textbatch) {
+        Draw_FlushBatch();
     }
 
-    GL_ResetViewport();
-    GL_SetState(GLSTATE_BLEND, 0);
-
     return x;
 }
 
@@ -889,52 +976,39 @@ static const symboldata_t confontmap[256] = {
 float Draw_ConsoleText(float x, float y, rcolor color,
                        float scale, const char* string, ...) {
     int c = 0;
-    int i = 0;
-    int vi = 0;
-    float vx1 = 0.0f;
-    float vy1 = 0.0f;
-    float vx2 = 0.0f;
-    float vy2 = 0.0f;
     float tx1 = 0.0f;
     float tx2 = 0.0f;
     float ty1 = 0.0f;
     float ty2 = 0.0f;
     char msg[MAX_MESSAGE_SIZE];
+    const char *text = string;
     va_list    va;
     float width;
     float height;
+    float ortho;
     int pic;
 
-    va_start(va, string);
-    vsprintf(msg, string, va);
-    va_end(va);
+    if(strchr(string, '%')) {
+        va_start(va, string);
+        vsnprintf(msg, sizeof(msg), string, va);
+        va_end(va);
+        text = msg;
+    }
 
     pic = GL_BindGfxTexture("CONFONT", true);
 
     width = (float)gfxwidth[pic];
     height = (float)gfxheight[pic];
+    ortho = GL_GetOrthoScale();
 
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-    dglSetVertex(vtxstring);
-
-    GL_SetState(GLSTATE_BLEND, 1);
-    GL_SetOrtho(0);
-
-    for(i = 0, vi = 0; i < dstrlen(msg); i++, vi += 4) {
-        vx1 = x;
-        vy1 = y;
-
-        c = msg[i];
+    for(; *text; text++) {
+        c = (byte)*text;
         if(c == '\n' || c == '\t') {
             continue;    // villsa: safety check
         }
         else {
-            vx2 = vx1 + ((float)confontmap[c].w * scale);
-            vy2 = vy1 - ((float)confontmap[c].h * scale);
+            float w = (float)confontmap[c].w * scale;
+            float h = (float)confontmap[c].h * scale;
 
             tx1 = ((float)confontmap[c].x / width) + 0.001f;
             tx2 = (tx1 + (float)confontmap[c].w / width) - 0.002f;
@@ -942,43 +1016,17 @@ float Draw_ConsoleText(float x, float y, rcolor color,
             ty1 = ((float)confontmap[c].y / height);
             ty2 = ty1 + (((float)confontmap[c].h / height));
 
-            vtxstring[vi + 0].x     = vx1;
-            vtxstring[vi + 0].y     = vy1;
-            vtxstring[vi + 0].tu    = tx1;
-            vtxstring[vi + 0].tv    = ty2;
-            vtxstring[vi + 1].x     = vx2;
-            vtxstring[vi + 1].y     = vy1;
-            vtxstring[vi + 1].tu    = tx2;
-            vtxstring[vi + 1].tv    = ty2;
-            vtxstring[vi + 2].x     = vx2;
-            vtxstring[vi + 2].y     = vy2;
-            vtxstring[vi + 2].tu    = tx2;
-            vtxstring[vi + 2].tv    = ty1;
-            vtxstring[vi + 3].x     = vx1;
-            vtxstring[vi + 3].y     = vy2;
-            vtxstring[vi + 3].tu    = tx1;
-            vtxstring[vi + 3].tv    = ty1;
-
-            dglSetVertexColor(vtxstring + vi, color, 4);
-
-            dglTriangle(vi + 2, vi + 1, vi + 0);
-            dglTriangle(vi + 3, vi + 2, vi + 0);
-
-            if(devparm) {
-                vertCount += 4;
-            }
+            Draw_AddQuad("CONFONT", true, true,
+                         x * ortho, (y - h) * ortho, (x + w) * ortho, y * ortho,
+                         tx1, ty1, tx2, ty2, color);
 
-            x += ((float)confontmap[c].w * scale);
+            x += w;
         }
     }
 
-    if(vi) {
-        dglDrawGeometry(vi, vtxstring);
+    if(!textbatch) {
+        Draw_FlushBatch();
     }
 
-    GL_ResetViewport();
-    GL_SetState(GLSTATE_BLEND, 0);
-
     return x;
 }
-
@@ -60,6 +60,9 @@ int Draw_BigText(int x, int y, rcolor color, const char* string);
 void Draw_Number(int x, int y, int num, int type, rcolor c);
 float Draw_ConsoleText(float x, float y, rcolor color,
                        float scale, const char* string, ...);
+void Draw_BeginBatch(void);
+void Draw_EndBatch(void);
+void Draw_FlushBatch(void);
 
 #endif
 
@@ -0,0 +1,241 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    GPU time per render pass.
+//    Each pass is wrapped in GL_TIME_ELAPSED queries. Queries
+//    alternate between two sets, so the results read at the end
+//    of a frame are the ones issued a frame earlier and the CPU
+//    never waits on them. Results that still aren't ready are
+//    skipped rather than waited for.
+//
+//-----------------------------------------------------------------------------
+
+#include "doomdef.h"
+#include "gl_main.h"
+#include "gl_gputimer.h"
+#include "con_console.h"
+#include "dgl.h"
+#include "core/cvar.hh"
+
+// a pass can be drawn in a few separate pieces each frame
+#define MAXGPUSPANS     4
+
+extern cvar::IntVar r_gputimers;
+
+typedef enum {
+    GPUTIMER_UNCHECKED,
+    GPUTIMER_READY,
+    GPUTIMER_UNSUPPORTED
+} gputimerstate_t;
+
+static const char *gpupassnames[NUMGPUPASSES] = {
+    "sky",
+    "world",
+    "sprites",
+    "automap",
+    "hud",
+    "wipe"
+};
+
+static gputimerstate_t timerstate = GPUTIMER_UNCHECKED;
+static GLuint   gpuqueries[2][NUMGPUPASSES][MAXGPUSPANS];
+static int      gpuspans[2][NUMGPUPASSES];
+static int      gpubuffer = 0;
+static int      activepass = -1;
+static int      nestedpasses = 0;
+static float    gpupasstimes[NUMGPUPASSES];
+
+//
+// GL_InitGPUTimers
+// Timer queries may be advertised with a zero bit counter,
+// which means they can't actually be used
+//
+
+static dboolean GL_InitGPUTimers(void) {
+    GLint bits = 0;
+
+    if(!GLAD_GL_ARB_timer_query || !GLAD_GL_ARB_occlusion_query) {
+        CON_Warnf("r_GPUTimers: GL_ARB_timer_query isn't supported\n");
+        return false;
+    }
+
+    dglGetQueryivARB(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS_ARB, &bits);
+
+    if(bits <= 0) {
+        CON_Warnf("r_GPUTimers: GL_TIME_ELAPSED has no counter bits\n");
+        return false;
+    }
+
+    dglGenQueriesARB(2 * NUMGPUPASSES * MAXGPUSPANS, &gpuqueries[0][0][0]);
+    dmemset(gpuspans, 0, sizeof(gpuspans));
+    dmemset(gpupasstimes, 0, sizeof(gpupasstimes));
+
+    return true;
+}
+
+//
+// GL_GPUTimersActive
+//
+
+dboolean GL_GPUTimersActive(void) {
+    if(r_gputimers <= 0 || !usingGL) {
+        return false;
+    }
+
+    if(timerstate == GPUTIMER_UNCHECKED) {
+        timerstate = GL_InitGPUTimers() ? GPUTIMER_READY : GPUTIMER_UNSUPPORTED;
+    }
+
+    return timerstate == GPUTIMER_READY;
+}
+
+//
+// GL_BeginGPUPass
+// Elapsed time queries can't overlap, so a pass started
+// inside another one is counted as part of the outer pass
+//
+
+void GL_BeginGPUPass(gpupass_t pass) {
+    int *span;
+
+    if(activepass >= 0) {
+        nestedpasses++;
+        return;
+    }
+
+    if(!GL_GPUTimersActive()) {
+        return;
+    }
+
+    span = &gpuspans[gpubuffer][pass];
+
+    if(*span >= MAXGPUSPANS) {
+        return;
+    }
+
+    dglBeginQueryARB(GL_TIME_ELAPSED, gpuqueries[gpubuffer][pass][*span]);
+    (*span)++;
+
+    activepass = pass;
+}
+
+//
+// GL_EndGPUPass
+//
+
+void GL_EndGPUPass(void) {
+    if(nestedpasses) {
+        nestedpasses--;
+        return;
+    }
+
+    if(activepass < 0) {
+        return;
+    }
+
+    dglEndQueryARB(GL_TIME_ELAPSED);
+    activepass = -1;
+}
+
+//
+// GL_ReadGPUPass
+// Returns false if the results aren't in yet
+//
+
+static dboolean GL_ReadGPUPass(int buffer, int pass, float *ms) {
+    GLuint64 total = 0;
+    GLuint available = 0;
+    int i;
+
+    if(!gpuspans[buffer][pass]) {
+        *ms = 0;
+        return true;
+    }
+
+    // queries finish in order, so the last one being ready covers the rest
+    dglGetQueryObjectuivARB(gpuqueries[buffer][pass][gpuspans[buffer][pass] - 1],
+                            GL_QUERY_RESULT_AVAILABLE_ARB, &available);
+
+    if(!available) {
+        return false;
+    }
+
+    for(i = 0; i < gpuspans[buffer][pass]; i++) {
+        GLuint64 elapsed = 0;
+
+        dglGetQueryObjectui64v(gpuqueries[buffer][pass][i], GL_QUERY_RESULT_ARB, &elapsed);
+        total += elapsed;
+    }
+
+    *ms = (float)(total / 1000000.0);
+    return true;
+}
+
+//
+// GL_UpdateGPUTimers
+// Called once per frame after the frame has been presented
+//
+
+void GL_UpdateGPUTimers(void) {
+    dboolean resolved = false;
+    int i;
+
+    if(!GL_GPUTimersActive() || activepass >= 0) {
+        return;
+    }
+
+    gpubuffer ^= 1;
+
+    // whatever was issued a frame ago
+    for(i = 0; i < NUMGPUPASSES; i++) {
+        float ms;
+
+        if(GL_ReadGPUPass(gpubuffer, i, &ms)) {
+            gpupasstimes[i] = ms;
+            resolved = true;
+        }
+
+        gpuspans[gpubuffer][i] = 0;
+    }
+
+    if(resolved && r_gputimers >= 2) {
+        I_Printf("gpu: sky %.3f world %.3f sprites %.3f automap %.3f hud %.3f wipe %.3f ms\n",
+                 gpupasstimes[GPU_SKY], gpupasstimes[GPU_WORLD], gpupasstimes[GPU_SPRITES],
+                 gpupasstimes[GPU_AUTOMAP], gpupasstimes[GPU_HUD], gpupasstimes[GPU_WIPE]);
+    }
+}
+
+//
+// GL_GPUPassTime
+// In milliseconds, from the last frame that has resolved
+//
+
+float GL_GPUPassTime(gpupass_t pass) {
+    return gpupasstimes[pass];
+}
+
+//
+// GL_GPUPassName
+//
+
+const char *GL_GPUPassName(gpupass_t pass) {
+    return gpupassnames[pass];
+}
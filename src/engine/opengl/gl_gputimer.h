@@ -0,0 +1,43 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __GL_GPUTIMER_H__
+#define __GL_GPUTIMER_H__
+
+#include "doomtype.h"
+
+typedef enum {
+    GPU_SKY,
+    GPU_WORLD,
+    GPU_SPRITES,
+    GPU_AUTOMAP,
+    GPU_HUD,
+    GPU_WIPE,
+    NUMGPUPASSES
+} gpupass_t;
+
+void        GL_BeginGPUPass(gpupass_t pass);
+void        GL_EndGPUPass(void);
+void        GL_UpdateGPUTimers(void);
+dboolean    GL_GPUTimersActive(void);
+float       GL_GPUPassTime(gpupass_t pass);
+const char  *GL_GPUPassName(gpupass_t pass);
+
+#endif
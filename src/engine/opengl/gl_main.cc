@@ -152,7 +152,7 @@ dboolean GL_CheckExtension(const char *ext) {
 //
 
 void* GL_RegisterProc(const char *address) {
-    void *proc = SDL_GL_GetProcAddress(address);
+    void *proc = Video->gl_proc_address(address);
 
     if(!proc) {
         CON_Warnf("GL_RegisterProc: Failed to get proc address: %s", address);
@@ -551,9 +551,9 @@ static int GetVersionInt(const char* version) {
 
 void GL_Init(void) {
 #ifdef HAVE_GLBINDING_3
-    glbinding::initialize([](const char *proc) { return reinterpret_cast<glbinding::ProcAddress>(SDL_GL_GetProcAddress(proc)); });
+    glbinding::initialize([](const char *proc) { return reinterpret_cast<glbinding::ProcAddress>(Video->gl_proc_address(proc)); });
 #else
-    gladLoadGLLoader(SDL_GL_GetProcAddress);
+    gladLoadGLLoader([](const char *proc) { return Video->gl_proc_address(proc); });
 #endif
 
     gl_vendor = dglGetString(GL_VENDOR);
@@ -571,6 +571,8 @@ void GL_Init(void) {
         CON_Warnf("Not enough texture units supported...\n");
     }
 
+    Video->init_gl();
+
     GL_CalcViewSize();
 
     dglViewport(0, 0, video_width, video_height);
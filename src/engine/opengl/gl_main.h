@@ -33,9 +33,15 @@
 #include <glbinding/gl14ext/gl.h>
 
 constexpr bool GLAD_GL_ARB_multitexture               = true;
+constexpr bool GLAD_GL_ARB_occlusion_query            = true;
+constexpr bool GLAD_GL_ARB_pixel_buffer_object        = true;
+constexpr bool GLAD_GL_ARB_sync                       = true;
 constexpr bool GLAD_GL_ARB_texture_non_power_of_two   = true;
 constexpr bool GLAD_GL_ARB_texture_env_combine        = true;
+constexpr bool GLAD_GL_ARB_timer_query                = true;
+constexpr bool GLAD_GL_ARB_vertex_buffer_object       = true;
 constexpr bool GLAD_GL_EXT_compiled_vertex_array      = true;
+constexpr bool GLAD_GL_EXT_framebuffer_object         = true;
 constexpr bool GLAD_GL_EXT_texture_env_combine        = true;
 constexpr bool GLAD_GL_EXT_texture_filter_anisotropic = true;
 
@@ -0,0 +1,386 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Asynchronous screen readback.
+//    The screen is read into a pixel buffer object right before it is
+//    presented, and a fence marks when the copy has finished on the
+//    GPU. The buffer is only mapped once the fence has passed, so the
+//    CPU never waits on the pipeline. Rows are flipped while copying out
+//    of the buffer, and the resulting image is handed to a worker thread
+//    for encoding and writing.
+//
+//-----------------------------------------------------------------------------
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "doomdef.h"
+#include "gl_main.h"
+#include "gl_readback.h"
+#include "gl_texture.h"
+#include "dgl.h"
+#include "image/image.hh"
+
+extern int video_width;
+extern int video_height;
+
+// without fences, frames to wait before the buffer is mapped
+#define READBACKFRAMES  2
+
+typedef struct {
+    int                         width;
+    int                         height;
+    rbuffer                     pbo;
+    GLsync                      fence;
+    int                         frames;
+    std::unique_ptr<byte[]>     pixels;
+    std::vector<readbackjob_t>  jobs;
+} readback_t;
+
+typedef struct {
+    Image                       image;
+    std::vector<readbackjob_t>  jobs;
+} readbackwork_t;
+
+static std::vector<readbackjob_t>   queuedjobs;
+static std::deque<readback_t*>      pendingreads;
+
+static std::mutex                   readbackmutex;
+static std::condition_variable      readbackcond;
+static std::deque<readbackwork_t*>  readbackqueue;
+static std::deque<String>           readbackmessages;
+
+//
+// The worker finishes everything that was queued
+// before it is joined on exit
+//
+
+static struct readbackworker_t {
+    std::thread thread;
+    bool quit = false;
+
+    ~readbackworker_t() {
+        if(!thread.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(readbackmutex);
+            quit = true;
+        }
+
+        readbackcond.notify_all();
+        thread.join();
+    }
+} readbackworker;
+
+//
+// ReadbackWorker
+//
+
+static void ReadbackWorker(void) {
+    for(;;) {
+        readbackwork_t *work;
+
+        {
+            std::unique_lock<std::mutex> lock(readbackmutex);
+
+            readbackcond.wait(lock, [] { return readbackworker.quit || !readbackqueue.empty(); });
+
+            if(readbackqueue.empty()) {
+                return;
+            }
+
+            work = readbackqueue.front();
+            readbackqueue.pop_front();
+        }
+
+        for(auto &job : work->jobs) {
+            String message;
+
+            try {
+                message = job(work->image);
+            }
+            catch(const std::exception &e) {
+                message = e.what();
+            }
+
+            if(!message.empty()) {
+                std::lock_guard<std::mutex> lock(readbackmutex);
+                readbackmessages.push_back(std::move(message));
+            }
+        }
+
+        delete work;
+    }
+}
+
+//
+// GL_ReadScreenAsync
+// The next frame is read back right before it is presented
+//
+
+void GL_ReadScreenAsync(readbackjob_t job) {
+    if(!usingGL) {
+        return;
+    }
+
+    queuedjobs.push_back(std::move(job));
+}
+
+//
+// GL_IssueReadbacks
+// Called after a frame has been drawn, before it is presented
+//
+
+void GL_IssueReadbacks(void) {
+    readback_t *rb;
+    size_t size;
+    int pack;
+
+    if(queuedjobs.empty()) {
+        return;
+    }
+
+    rb = new readback_t;
+    rb->width = video_width;
+    rb->height = video_height;
+    rb->pbo = 0;
+    rb->fence = 0;
+    rb->frames = 0;
+    rb->jobs = std::move(queuedjobs);
+    queuedjobs.clear();
+
+    size = (size_t)rb->width * rb->height * 3;
+
+    dglGetIntegerv(GL_PACK_ALIGNMENT, &pack);
+    dglPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    if(GLAD_GL_ARB_pixel_buffer_object && GLAD_GL_ARB_vertex_buffer_object) {
+        dglGenBuffersARB(1, &rb->pbo);
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, rb->pbo);
+        dglBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, size, NULL, GL_STREAM_READ_ARB);
+        dglReadPixels(0, 0, rb->width, rb->height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+        if(GLAD_GL_ARB_sync) {
+            rb->fence = dglFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+    else {
+        rb->pixels.reset(new byte[size]);
+        dglReadPixels(0, 0, rb->width, rb->height, GL_RGB, GL_UNSIGNED_BYTE, rb->pixels.get());
+    }
+
+    dglPixelStorei(GL_PACK_ALIGNMENT, pack);
+
+    pendingreads.push_back(rb);
+}
+
+//
+// GL_ReadbackReady
+//
+
+static dboolean GL_ReadbackReady(readback_t *rb) {
+    if(!rb->pbo) {
+        return true;
+    }
+
+    if(rb->fence) {
+        GLenum status = dglClientWaitSync(rb->fence, 0, 0);
+
+        return status != GL_TIMEOUT_EXPIRED;
+    }
+
+    return ++rb->frames > READBACKFRAMES;
+}
+
+//
+// GL_CopyReadback
+// OpenGL rows go from the bottom up, images from the top down
+//
+
+static Image GL_CopyReadback(readback_t *rb) {
+    RgbImage image { (uint16)rb->width, (uint16)rb->height };
+    size_t pitch = (size_t)rb->width * 3;
+    const byte *src;
+    int y;
+
+    if(rb->pbo) {
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, rb->pbo);
+        src = (const byte*)dglMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+    }
+    else {
+        src = rb->pixels.get();
+    }
+
+    if(src) {
+        for(y = 0; y < rb->height; y++) {
+            dmemcpy(image.data_ptr() + image.pitch() * (rb->height - 1 - y), src + pitch * y, pitch);
+        }
+    }
+
+    if(rb->pbo) {
+        if(src) {
+            dglUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+        }
+
+        dglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+        dglDeleteBuffersARB(1, &rb->pbo);
+    }
+
+    if(rb->fence) {
+        dglDeleteSync(rb->fence);
+    }
+
+    return Image(std::move(image));
+}
+
+//
+// GL_UpdateReadbacks
+// Called once per frame after it has been presented
+//
+
+void GL_UpdateReadbacks(void) {
+    std::deque<String> messages;
+
+    while(!pendingreads.empty() && GL_ReadbackReady(pendingreads.front())) {
+        readback_t *rb = pendingreads.front();
+        readbackwork_t *work = new readbackwork_t;
+
+        pendingreads.pop_front();
+
+        work->image = GL_CopyReadback(rb);
+        work->jobs = std::move(rb->jobs);
+        delete rb;
+
+        if(!readbackworker.thread.joinable()) {
+            readbackworker.thread = std::thread(ReadbackWorker);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(readbackmutex);
+            readbackqueue.push_back(work);
+        }
+
+        readbackcond.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(readbackmutex);
+        messages.swap(readbackmessages);
+    }
+
+    for(auto &message : messages) {
+        I_Printf("%s\n", message.c_str());
+    }
+}
+
+//
+// GL_ReadScreenThumbnail
+// The screen is shrunk on the GPU by drawing a mipmapped copy of it
+// into a small framebuffer, so only the thumbnail has to be read back
+//
+
+Image GL_ReadScreenThumbnail(int width, int height) {
+    RgbImage image { (uint16)width, (uint16)height };
+    std::unique_ptr<byte[]> pixels;
+    dtexture screentex;
+    GLuint fbo;
+    GLuint color;
+    GLint prevfbo;
+    int padw, padh;
+    int pack;
+    int y;
+
+    if(!GLAD_GL_EXT_framebuffer_object) {
+        Image img = GL_GetScreenBuffer(0, 0, video_width, video_height);
+
+        img.scale(width, height);
+        return img;
+    }
+
+    if(GLAD_GL_ARB_texture_non_power_of_two) {
+        padw = video_width;
+        padh = video_height;
+    }
+    else {
+        padw = GL_PadTextureDims(video_width);
+        padh = GL_PadTextureDims(video_height);
+    }
+
+    GL_SetTextureUnit(0, true);
+
+    dglGenTextures(1, &screentex);
+    dglBindTexture(GL_TEXTURE_2D, screentex);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    dglTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, padw, padh, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+    dglCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, video_width, video_height);
+    dglGenerateMipmapEXT(GL_TEXTURE_2D);
+
+    dglGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prevfbo);
+
+    dglGenRenderbuffersEXT(1, &color);
+    dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, color);
+    dglRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, width, height);
+    dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+    dglGenFramebuffersEXT(1, &fbo);
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+    dglFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, color);
+
+    dglViewport(0, 0, width, height);
+    dglScissor(0, 0, width, height);
+
+    GL_SetState(GLSTATE_BLEND, 0);
+    GL_SetOrthoScale(1.0f); // force ortho mode to be set
+    GL_SetupAndDraw2DQuad(0, 0, SCREENWIDTH, SCREENHEIGHT, 0,
+                          (float)video_width / padw, (float)video_height / padh, 0, WHITE, true);
+    GL_SetOrthoScale(1.0f);
+
+    pixels.reset(new byte[width * height * 3]);
+
+    dglGetIntegerv(GL_PACK_ALIGNMENT, &pack);
+    dglPixelStorei(GL_PACK_ALIGNMENT, 1);
+    dglReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.get());
+    dglPixelStorei(GL_PACK_ALIGNMENT, pack);
+
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prevfbo);
+    dglDeleteFramebuffersEXT(1, &fbo);
+    dglDeleteRenderbuffersEXT(1, &color);
+    GL_UnloadTexture(&screentex);
+    GL_ResetTextures();
+
+    dglViewport(ViewWindowX, ViewWindowY, ViewWidth, ViewHeight);
+    dglScissor(ViewWindowX, ViewWindowY, ViewWidth, ViewHeight);
+
+    for(y = 0; y < height; y++) {
+        dmemcpy(image.data_ptr() + image.pitch() * (height - 1 - y), pixels.get() + width * 3 * y, width * 3);
+    }
+
+    return Image(std::move(image));
+}
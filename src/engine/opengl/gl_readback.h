@@ -0,0 +1,37 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __GL_READBACK_H__
+#define __GL_READBACK_H__
+
+#include <functional>
+
+#include "gl_main.h"
+
+// runs on the readback thread with the finished screen image,
+// whatever it returns is printed once it is done
+typedef std::function<String(Image&)> readbackjob_t;
+
+void        GL_ReadScreenAsync(readbackjob_t job);
+void        GL_IssueReadbacks(void);
+void        GL_UpdateReadbacks(void);
+Image       GL_ReadScreenThumbnail(int width, int height);
+
+#endif
@@ -0,0 +1,338 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Render scaling.
+//    The 3D view is drawn into an offscreen framebuffer at a fraction
+//    of the screen resolution and stretched back over the screen before
+//    the HUD, console and menus are drawn at full resolution.
+//    With r_DynamicRes the fraction follows the measured frame time,
+//    trading resolution for frame rate when the scene gets heavy.
+//
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+#include <math.h>
+
+#include "doomdef.h"
+#include "gl_main.h"
+#include "gl_texture.h"
+#include "gl_renderscale.h"
+#include "con_console.h"
+#include "dgl.h"
+#include "core/cvar.hh"
+
+// smallest scale r_RenderScaleMin can ask for
+#define MINRENDERSCALE      0.25f
+
+// largest change to the scale in a single step
+#define MAXSCALESTEP        0.1f
+
+// frames to wait after a step before the next one, so the
+// average has time to settle at the new resolution
+#define SCALECOOLDOWN       8
+
+// frame time must be this far off target before the scale changes
+#define SCALEHYSTERESIS     0.1f
+
+// longer frames are level loads or pauses and don't say anything
+// about rendering cost
+#define MAXFRAMESAMPLE      250.0f
+
+extern int video_width;
+extern int video_height;
+
+extern cvar::FloatVar r_renderscale;
+extern cvar::BoolVar r_dynamicres;
+extern cvar::FloatVar r_frametarget;
+extern cvar::FloatVar r_renderscalemin;
+extern cvar::BoolVar r_renderscalefilter;
+extern cvar::BoolVar r_fillmode;
+
+typedef enum {
+    RENDERSCALE_UNCHECKED,
+    RENDERSCALE_READY,
+    RENDERSCALE_UNSUPPORTED
+} renderscalestate_t;
+
+typedef std::chrono::steady_clock renderscaleclock_t;
+
+static renderscalestate_t scalestate = RENDERSCALE_UNCHECKED;
+static GLuint   scalefbo = 0;
+static dtexture scaletexture = 0;
+static GLuint   scaledepth = 0;
+static int      scalewidth = 0;
+static int      scaleheight = 0;
+static int      scalepadw = 0;
+static int      scalepadh = 0;
+
+// state saved between GL_BeginRenderScale and GL_EndRenderScale
+static dboolean scaleactive = false;
+static GLint    prevfbo = 0;
+static int      prevwindowx;
+static int      prevwindowy;
+static int      prevwidth;
+static int      prevheight;
+
+// dynamic resolution
+static float    dynamicscale = 1.0f;
+static float    avgframetime = 0.0f;
+static int      scalecooldown = 0;
+static dboolean viewrendered = false;
+static dboolean havelastframe = false;
+static renderscaleclock_t::time_point lastframe;
+
+//
+// GL_InitRenderScale
+// (Re)creates the framebuffer when the screen size changes.
+// It is always allocated at full size so changing the scale
+// never has to reallocate anything.
+//
+
+static dboolean GL_InitRenderScale(void) {
+    GLenum status;
+
+    if(scalestate == RENDERSCALE_UNSUPPORTED) {
+        return false;
+    }
+
+    if(scalestate == RENDERSCALE_READY &&
+            scalewidth == video_width && scaleheight == video_height) {
+        return true;
+    }
+
+    if(!GLAD_GL_EXT_framebuffer_object) {
+        CON_Warnf("r_RenderScale: GL_EXT_framebuffer_object isn't supported\n");
+        scalestate = RENDERSCALE_UNSUPPORTED;
+        return false;
+    }
+
+    if(!scalefbo) {
+        dglGenFramebuffersEXT(1, &scalefbo);
+        dglGenTextures(1, &scaletexture);
+        dglGenRenderbuffersEXT(1, &scaledepth);
+    }
+
+    scalewidth = video_width;
+    scaleheight = video_height;
+    scalepadw = GL_PadTextureDims(video_width);
+    scalepadh = GL_PadTextureDims(video_height);
+
+    GL_SetTextureUnit(0, true);
+    dglBindTexture(GL_TEXTURE_2D, scaletexture);
+    dglTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, scalepadw, scalepadh, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+    GL_ResetTextures();
+
+    dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, scaledepth);
+    dglRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, scalepadw, scalepadh);
+    dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+    dglGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prevfbo);
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, scalefbo);
+    dglFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, scaletexture, 0);
+    dglFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, scaledepth);
+
+    status = dglCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prevfbo);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+        CON_Warnf("r_RenderScale: framebuffer is incomplete (0x%x)\n", status);
+        scalestate = RENDERSCALE_UNSUPPORTED;
+        return false;
+    }
+
+    scalestate = RENDERSCALE_READY;
+    return true;
+}
+
+//
+// GL_GetRenderScale
+// Fraction of the screen resolution the 3D view is drawn at
+//
+
+float GL_GetRenderScale(void) {
+    float scale;
+
+    if(scalestate == RENDERSCALE_UNSUPPORTED) {
+        return 1.0f;
+    }
+
+    scale = r_dynamicres ? dynamicscale : *r_renderscale;
+
+    return MIN(MAX(scale, MINRENDERSCALE), 1.0f);
+}
+
+//
+// GL_BeginRenderScale
+// Redirects drawing into the scaled framebuffer. The view size
+// globals are shrunk to match, so everything that sets up a
+// viewport from them draws into the scaled area.
+//
+
+void GL_BeginRenderScale(void) {
+    float scale;
+
+    viewrendered = true;
+
+    if(!usingGL || (scale = GL_GetRenderScale()) >= 1.0f) {
+        return;
+    }
+
+    if(!GL_InitRenderScale()) {
+        return;
+    }
+
+    // headless video keeps its own framebuffer bound in place of the window
+    dglGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prevfbo);
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, scalefbo);
+
+    prevwindowx = ViewWindowX;
+    prevwindowy = ViewWindowY;
+    prevwidth = ViewWidth;
+    prevheight = ViewHeight;
+
+    ViewWindowX = 0;
+    ViewWindowY = 0;
+    ViewWidth = MAX((int)(prevwidth * scale + 0.5f), 1);
+    ViewHeight = MAX((int)(prevheight * scale + 0.5f), 1);
+
+    GL_ClearView(0xFF000000);
+    GL_SetOrthoScale(1.0f); // force ortho mode to be set
+
+    scaleactive = true;
+}
+
+//
+// GL_EndRenderScale
+// Switches back to the screen and stretches the scaled view over it
+//
+
+void GL_EndRenderScale(void) {
+    GLint filter;
+    float u;
+    float v;
+
+    if(!scaleactive) {
+        return;
+    }
+
+    scaleactive = false;
+
+    u = (float)ViewWidth / (float)scalepadw;
+    v = (float)ViewHeight / (float)scalepadh;
+
+    ViewWindowX = prevwindowx;
+    ViewWindowY = prevwindowy;
+    ViewWidth = prevwidth;
+    ViewHeight = prevheight;
+
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prevfbo);
+    dglViewport(ViewWindowX, ViewWindowY, ViewWidth, ViewHeight);
+    dglScissor(ViewWindowX, ViewWindowY, ViewWidth, ViewHeight);
+
+    filter = r_renderscalefilter ? GL_LINEAR : GL_NEAREST;
+
+    GL_SetTextureUnit(0, true);
+    dglBindTexture(GL_TEXTURE_2D, scaletexture);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+    GL_SetState(GLSTATE_BLEND, 0);
+    GL_SetState(GLSTATE_TEXTURE0, 1);
+    dglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    // the texture is upside down compared to the screen
+    GL_SetOrthoScale(1.0f);
+    GL_SetupAndDraw2DQuad(0, 0, SCREENWIDTH, SCREENHEIGHT, 0, u, v, 0, WHITE, true);
+    GL_SetOrthoScale(1.0f);
+
+    if(!r_fillmode) {
+        dglPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    }
+
+    GL_CheckFillMode();
+    GL_ResetTextures();
+}
+
+//
+// GL_UpdateRenderScale
+// Called once per frame after it has been presented. The scale is
+// stepped toward whatever should bring the average frame time back
+// to r_FrameTarget; frame time goes roughly with pixel count, so
+// the step is the square root of the ratio.
+//
+
+void GL_UpdateRenderScale(void) {
+    auto now = renderscaleclock_t::now();
+    std::chrono::duration<float, std::milli> elapsed = now - lastframe;
+    float frametime = elapsed.count();
+    float target;
+    float ratio;
+    float scale;
+    float minscale;
+    dboolean sample;
+
+    sample = havelastframe && viewrendered;
+
+    lastframe = now;
+    havelastframe = true;
+    viewrendered = false;
+
+    if(!r_dynamicres) {
+        dynamicscale = 1.0f;
+        avgframetime = 0.0f;
+        return;
+    }
+
+    // menus, intermissions and loads don't draw the view
+    if(!sample || frametime > MAXFRAMESAMPLE) {
+        return;
+    }
+
+    if(avgframetime <= 0.0f) {
+        avgframetime = frametime;
+    }
+    else {
+        avgframetime += (frametime - avgframetime) * 0.1f;
+    }
+
+    if(scalecooldown > 0) {
+        scalecooldown--;
+        return;
+    }
+
+    target = MAX(*r_frametarget, 1.0f);
+
+    if(avgframetime > target * (1.0f + SCALEHYSTERESIS) ||
+            avgframetime < target * (1.0f - SCALEHYSTERESIS)) {
+        minscale = MIN(MAX(*r_renderscalemin, MINRENDERSCALE), 1.0f);
+        ratio = sqrtf(target / avgframetime);
+        ratio = MIN(MAX(ratio, 1.0f - MAXSCALESTEP), 1.0f + MAXSCALESTEP);
+
+        scale = MIN(MAX(dynamicscale * ratio, minscale), 1.0f);
+
+        if(scale != dynamicscale) {
+            dynamicscale = scale;
+            scalecooldown = SCALECOOLDOWN;
+        }
+    }
+}
@@ -0,0 +1,440 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Background texture streaming.
+//    Images are decoded on worker threads and handed back to the main
+//    thread, which uploads as many of them as fit in r_TexStreamBudget
+//    milliseconds at the end of each frame. Until a texture has been
+//    uploaded a placeholder is bound in its place.
+//
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "doomdef.h"
+#include "i_png.h"
+#include "gl_main.h"
+#include "gl_texture.h"
+#include "gl_texstream.h"
+#include "con_console.h"
+#include "dgl.h"
+#include "core/cvar.hh"
+#include <wad.hh>
+
+#define MAXSTREAMWORKERS    4
+
+extern cvar::BoolVar r_texstream;
+extern cvar::FloatVar r_texstreambudget;
+extern cvar::BoolVar r_texnonpowresize;
+
+typedef struct {
+    texstreamtype_t type;
+    int             index;
+    int             pal;
+    dboolean        alpha;
+    dboolean        pad;
+    int             lump;
+    int             generation;
+    dboolean        failed;
+    Image           image;
+} texrequest_t;
+
+static std::mutex                   streammutex;
+static std::condition_variable      streamcond;
+static std::condition_variable      streamdonecond;
+static std::deque<texrequest_t*>    streamqueue;
+static std::deque<texrequest_t*>    streamready;
+static int                          streamdecoding = 0;
+static int                          streamgeneration = 0;
+
+// only touched by the main thread
+static std::unordered_set<uint64>   pendingtextures;
+static std::unordered_set<uint64>   failedtextures;
+
+static dtexture placeholder[2] = { 0, 0 };
+static rbuffer  streampbo = 0;
+
+//
+// Worker threads are joined on exit so none of them are
+// left decoding while the wad devices are torn down
+//
+
+static struct streamworkers_t {
+    std::vector<std::thread> threads;
+    bool quit = false;
+
+    ~streamworkers_t() {
+        {
+            std::lock_guard<std::mutex> lock(streammutex);
+            quit = true;
+        }
+
+        streamcond.notify_all();
+
+        for(auto &t : threads) {
+            t.join();
+        }
+    }
+} streamworkers;
+
+//
+// TextureKey
+//
+
+static uint64 TextureKey(texstreamtype_t type, int index, int pal) {
+    return ((uint64)type << 48) | ((uint64)(pal & 0xffff) << 32) | (uint32)index;
+}
+
+//
+// StreamWorker
+//
+
+static void StreamWorker(void) {
+    for(;;) {
+        texrequest_t *req;
+
+        {
+            std::unique_lock<std::mutex> lock(streammutex);
+
+            streamcond.wait(lock, [] { return streamworkers.quit || !streamqueue.empty(); });
+
+            if(streamworkers.quit) {
+                return;
+            }
+
+            req = streamqueue.front();
+            streamqueue.pop_front();
+            streamdecoding++;
+        }
+
+        try {
+            req->image = I_ReadImage(req->lump, false, true, req->alpha, req->pal);
+
+            // pad here rather than on the main thread
+            if(req->pad) {
+                auto offset = req->image.sprite_offset();
+
+                req->image.canvas(GL_PadTextureDims(req->image.width()),
+                                  GL_PadTextureDims(req->image.height()));
+                req->image.sprite_offset(offset);
+            }
+        }
+        catch(const std::exception&) {
+            req->failed = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(streammutex);
+
+            streamready.push_back(req);
+            streamdecoding--;
+        }
+
+        streamdonecond.notify_all();
+    }
+}
+
+//
+// StartWorkers
+//
+
+static void StartWorkers(void) {
+    int count = (int)std::thread::hardware_concurrency() - 1;
+
+    count = MAX(MIN(count, MAXSTREAMWORKERS), 1);
+
+    for(int i = 0; i < count; i++) {
+        streamworkers.threads.emplace_back(StreamWorker);
+    }
+
+    CON_DPrintf("Texture streaming started with %i worker(s)\n", count);
+}
+
+//
+// QueueTexture
+//
+
+static dboolean QueueTexture(texstreamtype_t type, int index, int pal, dboolean alpha) {
+    static const wad::Section sections[NUMTEXSTREAMTYPES] = {
+        wad::Section::textures,
+        wad::Section::sprites,
+        wad::Section::graphics
+    };
+    texrequest_t *req;
+    uint64 key;
+
+    key = TextureKey(type, index, pal);
+
+    if(pendingtextures.count(key)) {
+        return true;
+    }
+
+    // let the caller load it and report the error
+    if(failedtextures.count(key)) {
+        return false;
+    }
+
+    if(streamworkers.threads.empty()) {
+        StartWorkers();
+    }
+
+    req = new texrequest_t;
+    req->type = type;
+    req->index = index;
+    req->pal = pal;
+    req->alpha = alpha;
+    req->pad = (type != TST_WORLD && r_texnonpowresize > 0);
+    req->lump = wad::open(sections[type], index).value().lump_index();
+    req->generation = streamgeneration;
+    req->failed = false;
+
+    {
+        std::lock_guard<std::mutex> lock(streammutex);
+        streamqueue.push_back(req);
+    }
+
+    streamcond.notify_one();
+    pendingtextures.insert(key);
+
+    return true;
+}
+
+//
+// GL_QueueTexture
+// Returns true if the texture will be uploaded later,
+// in which case the caller should bind a placeholder
+//
+
+dboolean GL_QueueTexture(texstreamtype_t type, int index, int pal, dboolean alpha) {
+    if(!r_texstream || !usingGL) {
+        return false;
+    }
+
+    return QueueTexture(type, index, pal, alpha);
+}
+
+//
+// GL_PrecacheTexture
+// Same as GL_QueueTexture but ignores r_TexStream, since the
+// level precache always flushes before anything is drawn
+//
+
+dboolean GL_PrecacheTexture(texstreamtype_t type, int index, int pal, dboolean alpha) {
+    if(!usingGL) {
+        return false;
+    }
+
+    return QueueTexture(type, index, pal, alpha);
+}
+
+//
+// UploadReadyTextures
+// Uploads decoded textures until budget (in ms) runs out.
+// A negative budget uploads everything that is ready.
+//
+
+static void UploadReadyTextures(double budget) {
+    auto start = std::chrono::steady_clock::now();
+
+    for(;;) {
+        texrequest_t *req;
+
+        {
+            std::lock_guard<std::mutex> lock(streammutex);
+
+            if(streamready.empty()) {
+                break;
+            }
+
+            req = streamready.front();
+            streamready.pop_front();
+        }
+
+        // textures were dumped while this one was decoding
+        if(req->generation == streamgeneration) {
+            uint64 key = TextureKey(req->type, req->index, req->pal);
+
+            pendingtextures.erase(key);
+
+            if(req->failed) {
+                failedtextures.insert(key);
+            }
+            else {
+                GL_SetStreamedTexture(req->type, req->index, req->pal, req->alpha, req->image);
+            }
+        }
+
+        delete req;
+
+        if(budget >= 0) {
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            if(elapsed.count() >= budget) {
+                break;
+            }
+        }
+    }
+}
+
+//
+// GL_UpdateTextureStream
+// Called once per frame after everything has been drawn
+//
+
+void GL_UpdateTextureStream(void) {
+    if(pendingtextures.empty()) {
+        return;
+    }
+
+    UploadReadyTextures(r_texstreambudget);
+}
+
+//
+// GL_FlushTextureStream
+// Blocks until every queued texture has been uploaded.
+// Textures are uploaded in batches as they come back so
+// the upload overlaps with the remaining decoding.
+//
+
+void GL_FlushTextureStream(void) {
+    dboolean done = false;
+
+    while(!done && !pendingtextures.empty()) {
+        {
+            std::unique_lock<std::mutex> lock(streammutex);
+
+            streamdonecond.wait(lock, [] {
+                return !streamready.empty() || (streamqueue.empty() && !streamdecoding);
+            });
+
+            done = streamqueue.empty() && !streamdecoding;
+        }
+
+        UploadReadyTextures(-1);
+    }
+}
+
+//
+// GL_CancelTextureStream
+// Drops all queued textures. Anything still being decoded is
+// discarded once it comes back.
+//
+
+void GL_CancelTextureStream(void) {
+    std::lock_guard<std::mutex> lock(streammutex);
+
+    for(auto req : streamqueue) {
+        delete req;
+    }
+
+    streamqueue.clear();
+    streamgeneration++;
+
+    pendingtextures.clear();
+    failedtextures.clear();
+}
+
+//
+// GL_TextureStreamPending
+//
+
+int GL_TextureStreamPending(void) {
+    return (int)pendingtextures.size();
+}
+
+//
+// GL_BindPlaceholderTexture
+// Transparent for sprites and graphics, grey for world textures
+//
+
+void GL_BindPlaceholderTexture(dboolean alpha) {
+    dtexture *tex = &placeholder[alpha ? 1 : 0];
+
+    if(*tex == 0) {
+        rcolor rgb[16];
+        int i;
+
+        for(i = 0; i < 16; i++) {
+            rgb[i] = alpha ? D_RGBA(0xff, 0xff, 0xff, 0) : D_RGBA(0x80, 0x80, 0x80, 0xff);
+        }
+
+        dglGenTextures(1, tex);
+        dglBindTexture(GL_TEXTURE_2D, *tex);
+        dglTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, (byte*)rgb);
+        dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        GL_CheckFillMode();
+        GL_SetTextureFilter();
+    }
+    else {
+        dglBindTexture(GL_TEXTURE_2D, *tex);
+    }
+}
+
+//
+// GL_TexImage
+// Uploads a texture image through a pixel buffer object if available
+//
+
+void GL_TexImage(GLenum internalformat, int width, int height, GLenum format, const byte *data) {
+    size_t size = width * height * (format == GL_RGBA ? 4 : 3);
+    GLint unpack;
+    void *ptr;
+
+    // image rows are tightly packed, which RGB rows often aren't at 4
+    dglGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack);
+    dglPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if(!GLAD_GL_ARB_pixel_buffer_object || !GLAD_GL_ARB_vertex_buffer_object) {
+        dglTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        dglPixelStorei(GL_UNPACK_ALIGNMENT, unpack);
+        return;
+    }
+
+    if(streampbo == 0) {
+        dglGenBuffersARB(1, &streampbo);
+    }
+
+    dglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, streampbo);
+
+    // orphan the previous contents so the driver doesn't have to wait on them
+    dglBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_STREAM_DRAW_ARB);
+
+    if((ptr = dglMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB))) {
+        dmemcpy(ptr, data, size);
+        dglUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+        dglTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0, format, GL_UNSIGNED_BYTE, 0);
+        dglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+    }
+    else {
+        dglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+        dglTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    }
+
+    dglPixelStorei(GL_UNPACK_ALIGNMENT, unpack);
+}
@@ -0,0 +1,42 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __GL_TEXSTREAM_H__
+#define __GL_TEXSTREAM_H__
+
+#include "gl_main.h"
+
+typedef enum {
+    TST_WORLD,
+    TST_SPRITE,
+    TST_GFX,
+    NUMTEXSTREAMTYPES
+} texstreamtype_t;
+
+dboolean    GL_QueueTexture(texstreamtype_t type, int index, int pal, dboolean alpha);
+dboolean    GL_PrecacheTexture(texstreamtype_t type, int index, int pal, dboolean alpha);
+void        GL_UpdateTextureStream(void);
+void        GL_FlushTextureStream(void);
+void        GL_CancelTextureStream(void);
+int         GL_TextureStreamPending(void);
+void        GL_BindPlaceholderTexture(dboolean alpha);
+void        GL_TexImage(GLenum internalformat, int width, int height, GLenum format, const byte *data);
+
+#endif
@@ -25,12 +25,16 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <list>
+#include <unordered_map>
+
 #include "doomstat.h"
 #include "r_local.h"
 #include "i_png.h"
 #include "i_system.h"
 #include "z_zone.h"
 #include "gl_texture.h"
+#include "gl_texstream.h"
 #include "gl_main.h"
 #include "p_spec.h"
 #include "p_local.h"
@@ -75,6 +79,20 @@ float*      spritetopoffset;
 word*       spriteheight;
 word*       spritecount;
 
+// texture residency, most recently used first
+
+typedef struct {
+    uint64  key;
+    size_t  size;
+    int     lastframe;
+} texresident_t;
+
+static std::list<texresident_t> residentlist;
+static std::unordered_map<uint64, std::list<texresident_t>::iterator> residentmap;
+static size_t   residentbytes = 0;
+static int      residentframe = 0;
+static int      residentevicted = 0;
+
 typedef struct {
     GLenum mode;
     GLenum combine_rgb;
@@ -92,6 +110,67 @@ static int curunit = 0;
 extern cvar::BoolVar r_texnonpowresize;
 extern cvar::BoolVar r_fillmode;
 extern cvar::BoolVar r_texturecombiner;
+extern cvar::IntVar r_texturebudget;
+
+//
+// ResidentKey
+//
+
+static uint64 ResidentKey(int type, int index, int pal) {
+    return ((uint64)type << 48) | ((uint64)(pal & 0xffff) << 32) | (uint32)index;
+}
+
+//
+// ResidentSlot
+//
+
+static dtexture *ResidentSlot(uint64 key) {
+    int index = (int)(key & 0xffffffff);
+    int pal = (int)((key >> 32) & 0xffff);
+
+    switch(key >> 48) {
+    case TST_WORLD:
+        return &textureptr[index][pal];
+
+    case TST_SPRITE:
+        return &spriteptr[index][pal];
+
+    default:
+        return &gfxptr[index];
+    }
+}
+
+//
+// AddResident
+//
+
+static void AddResident(int type, int index, int pal, size_t size) {
+    texresident_t res;
+
+    res.key = ResidentKey(type, index, pal);
+    res.size = size;
+    res.lastframe = residentframe;
+
+    residentlist.push_front(res);
+    residentmap[res.key] = residentlist.begin();
+    residentbytes += size;
+}
+
+//
+// TouchResident
+// Marks a texture as used this frame
+//
+
+static void TouchResident(int type, int index, int pal) {
+    auto it = residentmap.find(ResidentKey(type, index, pal));
+
+    if(it == residentmap.end()) {
+        return;
+    }
+
+    it->second->lastframe = residentframe;
+    residentlist.splice(residentlist.begin(), residentlist, it->second);
+}
 
 //
 // R_TextureCombinerFunc
@@ -161,6 +240,28 @@ static void InitWorldTextures(void) {
     CON_DPrintf("%i world textures initialized\n", numtextures);
 }
 
+//
+// SetWorldTexture
+//
+
+static void SetWorldTexture(int texnum, int pal, Image &image) {
+    dglGenTextures(1, &textureptr[texnum][pal]);
+    dglBindTexture(GL_TEXTURE_2D, textureptr[texnum][pal]);
+    GL_TexImage(GL_RGBA8, image.width(), image.height(), GL_RGBA, reinterpret_cast<byte*>(image.data_ptr()));
+
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    GL_CheckFillMode();
+    GL_SetTextureFilter();
+
+    // update global width and heights
+    texturewidth[texnum] = image.width();
+    textureheight[texnum] = image.height();
+
+    AddResident(TST_WORLD, texnum, pal, image.width() * image.height() * 4);
+}
+
 //
 // GL_BindWorldTexture
 //
@@ -180,7 +281,9 @@ void GL_BindWorldTexture(int texnum, int *width, int *height) {
         *height = textureheight[texnum];
     }
 
+    // still bound, but it has to count as used this frame
     if(curtexture == texnum) {
+        TouchResident(TST_WORLD, texnum, palettetranslation[texnum]);
         return;
     }
 
@@ -188,6 +291,7 @@ void GL_BindWorldTexture(int texnum, int *width, int *height) {
 
     // if texture is already in video ram
     if(textureptr[texnum][palettetranslation[texnum]]) {
+        TouchResident(TST_WORLD, texnum, palettetranslation[texnum]);
         dglBindTexture(GL_TEXTURE_2D, textureptr[texnum][palettetranslation[texnum]]);
         dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -197,25 +301,17 @@ void GL_BindWorldTexture(int texnum, int *width, int *height) {
         return;
     }
 
-    // create a new texture
-    auto image = I_ReadImage(wad::open(wad::Section::textures, texnum).value().lump_index(), false, true, true, palettetranslation[texnum]);
-
-    {
-        dglGenTextures(1, &textureptr[texnum][palettetranslation[texnum]]);
-        dglBindTexture(GL_TEXTURE_2D, textureptr[texnum][palettetranslation[texnum]]);
-        dglTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                      image.data_ptr());
-
-        dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // wall texture coordinates are built from the texture size, so only
+    // stream textures whose size is already known (ie palette variants)
+    if(texturewidth[texnum] && GL_QueueTexture(TST_WORLD, texnum, palettetranslation[texnum], true)) {
+        GL_BindPlaceholderTexture(false);
+        return;
     }
 
-    GL_CheckFillMode();
-    GL_SetTextureFilter();
+    // create a new texture
+    auto image = I_ReadImage(wad::open(wad::Section::textures, texnum).value().lump_index(), false, true, true, palettetranslation[texnum]);
 
-    // update global width and heights
-    texturewidth[texnum] = image.width();
-    textureheight[texnum] = image.height();
+    SetWorldTexture(texnum, palettetranslation[texnum], image);
 
     if(width) {
         *width = texturewidth[texnum];
@@ -248,14 +344,11 @@ void GL_SetNewPalette(int id, byte palID) {
 
 static void SetTextureImage(byte* data, int bits, int *origwidth, int *origheight, GLenum format, GLenum type)
 {
-    if(r_texnonpowresize > 0) {
-       int wp;
-       int hp;
-
-       // pad the width and heights
-       wp = GL_PadTextureDims(*origwidth);
-       hp = GL_PadTextureDims(*origheight);
+    int wp = GL_PadTextureDims(*origwidth);
+    int hp = GL_PadTextureDims(*origheight);
 
+    // streamed images are padded by the decoding thread
+    if(r_texnonpowresize > 0 && (wp != *origwidth || hp != *origheight)) {
        Image image(format == GL_RGBA8 ? PixelFormat::rgba : PixelFormat::rgb, *origwidth, *origheight);
 
        std::copy_n(reinterpret_cast<char*>(data), image.size(), image.data_ptr());
@@ -265,30 +358,10 @@ static void SetTextureImage(byte* data, int bits, int *origwidth, int *origheigh
        *origwidth = wp;
        *origheight = hp;
 
-       dglTexImage2D(
-               GL_TEXTURE_2D,
-               0,
-               format,
-               wp,
-               hp,
-               0,
-               type,
-               GL_UNSIGNED_BYTE,
-               image.data_ptr()
-       );
+       GL_TexImage(format, wp, hp, type, reinterpret_cast<byte*>(image.data_ptr()));
     }
     else {
-        dglTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            format,
-            *origwidth,
-            *origheight,
-            0,
-            type,
-            GL_UNSIGNED_BYTE,
-            data
-        );
+        GL_TexImage(format, *origwidth, *origheight, type, data);
     }
 
     GL_CheckFillMode();
@@ -324,20 +397,45 @@ static void InitGfxTextures(void) {
     CON_DPrintf("%i generic textures initialized\n", numgfx);
 }
 
+//
+// SetGfxTexture
+//
+
+static void SetGfxTexture(int gfxid, dboolean alpha, Image &image) {
+    int width = image.width();
+    int height = image.height();
+
+    dglGenTextures(1, &gfxptr[gfxid]);
+    dglBindTexture(GL_TEXTURE_2D, gfxptr[gfxid]);
+
+    // if alpha is specified, setup the format for only RGBA pixels (4 bytes) per pixel
+    GLenum format = alpha ? GL_RGBA8 : GL_RGB8;
+    GLenum type = alpha ? GL_RGBA : GL_RGB;
+
+    SetTextureImage(reinterpret_cast<byte*>(image.data_ptr()), (alpha ? 4 : 3), &width, &height, format, type);
+
+    gfxwidth[gfxid] = width;
+    gfxorigwidth[gfxid] = width;
+
+    gfxheight[gfxid] = height;
+    gfxorigheight[gfxid] = height;
+
+    AddResident(TST_GFX, gfxid, 0, width * height * (alpha ? 4 : 3));
+}
+
 //
 // GL_BindGfxTexture
 //
 
 int GL_BindGfxTexture(const char* name, dboolean alpha) {
     dboolean npot;
-    int width;
-    int height;
     int gfxid;
 
     auto lump = wad::open(wad::Section::graphics, name).value();
     gfxid = lump.section_index();
 
     if(gfxid == curgfx) {
+        TouchResident(TST_GFX, gfxid, 0);
         return gfxid;
     }
 
@@ -345,6 +443,7 @@ int GL_BindGfxTexture(const char* name, dboolean alpha) {
 
     // if texture is already in video ram
     if(gfxptr[gfxid]) {
+        TouchResident(TST_GFX, gfxid, 0);
         dglBindTexture(GL_TEXTURE_2D, gfxptr[gfxid]);
         if(devparm) {
             glBindCalls++;
@@ -352,10 +451,6 @@ int GL_BindGfxTexture(const char* name, dboolean alpha) {
         return gfxid;
     }
 
-    auto image = I_ReadImage(lump.lump_index(), false, true, alpha, 0);
-    width = image.width();
-    height = image.height();
-
     // check for non-power of two textures
     npot = GLAD_GL_ARB_texture_non_power_of_two;
 
@@ -363,20 +458,16 @@ int GL_BindGfxTexture(const char* name, dboolean alpha) {
         r_texnonpowresize = 1;
     }
 
-    dglGenTextures(1, &gfxptr[gfxid]);
-    dglBindTexture(GL_TEXTURE_2D, gfxptr[gfxid]);
-
-    // if alpha is specified, setup the format for only RGBA pixels (4 bytes) per pixel
-    GLenum format = alpha ? GL_RGBA8 : GL_RGB8;
-    GLenum type = alpha ? GL_RGBA : GL_RGB;
-
-    SetTextureImage(reinterpret_cast<byte*>(image.data_ptr()), (alpha ? 4 : 3), &width, &height, format, type);
+    // 2D layouts are built from the image size, so only stream
+    // graphics that have been loaded before
+    if(gfxwidth[gfxid] && GL_QueueTexture(TST_GFX, gfxid, 0, alpha)) {
+        GL_BindPlaceholderTexture(true);
+        return gfxid;
+    }
 
-    gfxwidth[gfxid] = width;
-    gfxorigwidth[gfxid] = width;
+    auto image = I_ReadImage(lump.lump_index(), false, true, alpha, 0);
 
-    gfxheight[gfxid] = height;
-    gfxorigheight[gfxid] = height;
+    SetGfxTexture(gfxid, alpha, image);
 
     if(devparm) {
         glBindCalls++;
@@ -397,10 +488,10 @@ static void InitSpriteTextures(void) {
 
     auto section        = wad::list_section(wad::Section::sprites);
     numsprtex           = static_cast<int>(section.size());
-    spritewidth         = (word*)Z_Malloc(numsprtex * sizeof(word), PU_STATIC, 0);
-    spriteoffset        = (float*)Z_Malloc(numsprtex * sizeof(float), PU_STATIC, 0);
-    spritetopoffset     = (float*)Z_Malloc(numsprtex * sizeof(float), PU_STATIC, 0);
-    spriteheight        = (word*)Z_Malloc(numsprtex * sizeof(word), PU_STATIC, 0);
+    spritewidth         = (word*)Z_Calloc(numsprtex * sizeof(word), PU_STATIC, 0);
+    spriteoffset        = (float*)Z_Calloc(numsprtex * sizeof(float), PU_STATIC, 0);
+    spritetopoffset     = (float*)Z_Calloc(numsprtex * sizeof(float), PU_STATIC, 0);
+    spriteheight        = (word*)Z_Calloc(numsprtex * sizeof(word), PU_STATIC, 0);
     spriteptr           = (dtexture**)Z_Malloc(sizeof(dtexture*) * numsprtex, PU_STATIC, 0);
     spritecount         = (word*)Z_Calloc(numsprtex * sizeof(word), PU_STATIC, 0);
 
@@ -437,6 +528,28 @@ static void InitSpriteTextures(void) {
     }
 }
 
+//
+// SetSpriteTexture
+//
+
+static void SetSpriteTexture(int spritenum, int pal, Image &image) {
+    dglGenTextures(1, &spriteptr[spritenum][pal]);
+    dglBindTexture(GL_TEXTURE_2D, spriteptr[spritenum][pal]);
+
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+
+    int w = image.width(), h = image.height();
+    SetTextureImage(reinterpret_cast<byte*>(image.data_ptr()), 4, &w, &h, GL_RGBA8, GL_RGBA);
+
+    spritewidth[spritenum] = w;
+    spriteheight[spritenum] = h;
+    spriteoffset[spritenum] = image.sprite_offset().x;
+    spritetopoffset[spritenum] = image.sprite_offset().y;
+
+    AddResident(TST_SPRITE, spritenum, pal, w * h * 4);
+}
+
 //
 // GL_BindSpriteTexture
 //
@@ -449,6 +562,7 @@ void GL_BindSpriteTexture(int spritenum, int pal) {
     }
 
     if((spritenum == cursprite) && (pal == curtrans)) {
+        TouchResident(TST_SPRITE, spritenum, pal);
         return;
     }
 
@@ -462,6 +576,7 @@ void GL_BindSpriteTexture(int spritenum, int pal) {
 
     // if texture is already in video ram
     if(spriteptr[spritenum][pal]) {
+        TouchResident(TST_SPRITE, spritenum, pal);
         dglBindTexture(GL_TEXTURE_2D, spriteptr[spritenum][pal]);
         dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
         dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
@@ -471,8 +586,6 @@ void GL_BindSpriteTexture(int spritenum, int pal) {
         return;
     }
 
-    auto image = I_ReadImage(wad::open(wad::Section::sprites, spritenum).value().lump_index(), false, true, true, pal);
-
     // check for non-power of two textures
     npot = GLAD_GL_ARB_texture_non_power_of_two;
 
@@ -480,25 +593,154 @@ void GL_BindSpriteTexture(int spritenum, int pal) {
         r_texnonpowresize = 1;
     }
 
-    dglGenTextures(1, &spriteptr[spritenum][pal]);
-    dglBindTexture(GL_TEXTURE_2D, spriteptr[spritenum][pal]);
-
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
-    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+    // sprites with an unknown size are simply not drawn until they arrive
+    if(GL_QueueTexture(TST_SPRITE, spritenum, pal, true)) {
+        GL_BindPlaceholderTexture(true);
+        return;
+    }
 
-    int w = image.width(), h = image.height();
-    SetTextureImage(reinterpret_cast<byte*>(image.data_ptr()), 4, &w, &h, GL_RGBA8, GL_RGBA);
+    auto image = I_ReadImage(wad::open(wad::Section::sprites, spritenum).value().lump_index(), false, true, true, pal);
 
-    spritewidth[spritenum] = w;
-    spriteheight[spritenum] = h;
-    spriteoffset[spritenum] = image.sprite_offset().x;
-    spritetopoffset[spritenum] = image.sprite_offset().y;
+    SetSpriteTexture(spritenum, pal, image);
 
     if(devparm) {
         glBindCalls++;
     }
 }
 
+//
+// GL_PrecacheWorldTexture
+// Queues a world texture palette variant for the streaming
+// threads, or loads it right away if streaming isn't possible
+//
+
+void GL_PrecacheWorldTexture(int texnum, int pal) {
+    if(r_fillmode <= 0 || textureptr[texnum][pal]) {
+        return;
+    }
+
+    if(GL_PrecacheTexture(TST_WORLD, texnum, pal, true)) {
+        return;
+    }
+
+    auto image = I_ReadImage(wad::open(wad::Section::textures, texnum).value().lump_index(), false, true, true, pal);
+
+    SetWorldTexture(texnum, pal, image);
+}
+
+//
+// GL_PrecacheSpriteTexture
+//
+
+void GL_PrecacheSpriteTexture(int spritenum, int pal) {
+    if(!r_fillmode) {
+        return;
+    }
+
+    if(pal && pal >= spritecount[spritenum]) {
+        pal = 0;
+    }
+
+    if(spriteptr[spritenum][pal]) {
+        return;
+    }
+
+    if(!GLAD_GL_ARB_texture_non_power_of_two && r_texnonpowresize <= 0) {
+        r_texnonpowresize = 1;
+    }
+
+    if(GL_PrecacheTexture(TST_SPRITE, spritenum, pal, true)) {
+        return;
+    }
+
+    auto image = I_ReadImage(wad::open(wad::Section::sprites, spritenum).value().lump_index(), false, true, true, pal);
+
+    SetSpriteTexture(spritenum, pal, image);
+}
+
+//
+// GL_TextureMemory
+// Returns the approximate amount of texture memory in use
+//
+
+size_t GL_TextureMemory(void) {
+    return residentbytes;
+}
+
+//
+// GL_UpdateTextureResidency
+// Called once per frame. Evicts the least recently used textures
+// until the total is back under r_TextureBudget. Anything used
+// during the current frame is never evicted.
+//
+
+void GL_UpdateTextureResidency(void) {
+    size_t budget = (size_t)MAX(*r_texturebudget, 0) << 20;
+
+    residentevicted = 0;
+
+    while(budget && residentbytes > budget && !residentlist.empty()) {
+        texresident_t &res = residentlist.back();
+
+        if(res.lastframe >= residentframe) {
+            break;
+        }
+
+        GL_UnloadTexture(ResidentSlot(res.key));
+
+        residentbytes -= res.size;
+        residentmap.erase(res.key);
+        residentlist.pop_back();
+        residentevicted++;
+    }
+
+    if(residentevicted) {
+        GL_ResetTextures();
+    }
+
+    residentframe++;
+}
+
+//
+// GL_GetTextureResidency
+//
+
+void GL_GetTextureResidency(int *count, size_t *bytes, int *evicted) {
+    *count = (int)residentlist.size();
+    *bytes = residentbytes;
+    *evicted = residentevicted;
+}
+
+//
+// GL_SetStreamedTexture
+// Creates a texture from an image decoded by the streaming threads
+//
+
+void GL_SetStreamedTexture(int type, int index, int pal, dboolean alpha, Image &image) {
+    switch(type) {
+    case TST_WORLD:
+        if(!textureptr[index][pal]) {
+            SetWorldTexture(index, pal, image);
+        }
+        break;
+
+    case TST_SPRITE:
+        if(!spriteptr[index][pal]) {
+            SetSpriteTexture(index, pal, image);
+        }
+        break;
+
+    case TST_GFX:
+        if(!gfxptr[index]) {
+            SetGfxTexture(index, alpha, image);
+        }
+        break;
+    }
+
+    // the real texture needs to be bound next time around
+    GL_ResetTextures();
+}
+
 //
 // GL_ScreenToTexture
 //
@@ -895,22 +1137,18 @@ void GL_DumpTextures(void) {
         return;
     }
 
+    GL_CancelTextureStream();
+
     for(i = 0; i < numtextures; i++) {
         GL_UnloadTexture(&textureptr[i][0]);
+    }
 
-        for(p = 0; p < numanimdef; p++) {
-            int lump = wad::open(wad::Section::textures, animdefs[p].name).value().section_index();
-
-            if(lump != i) {
-                 continue;
+    for(p = 0; p < numanimdef; p++) {
+        if(animdefs[p].palette) {
+            for(j = 1; j < animdefs[p].frames; j++) {
+                GL_UnloadTexture(&textureptr[animdefs[p].texnum][j]);
             }
-
-            if(animdefs[p].palette) {
-                for(j = 1; j < animdefs[p].frames; j++) {
-                    GL_UnloadTexture(&textureptr[i][j]);
-                }
-            }
-       }
+        }
     }
 
     for(i = 0; i < numsprtex; i++) {
@@ -922,6 +1160,10 @@ void GL_DumpTextures(void) {
     for(i = 0; i < numgfx; i++) {
         GL_UnloadTexture(&gfxptr[i]);
     }
+
+    residentlist.clear();
+    residentmap.clear();
+    residentbytes = 0;
 }
 
 //
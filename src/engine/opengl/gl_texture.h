@@ -70,6 +70,12 @@ int         GL_PadTextureDims(int size);
 void        GL_SetNewPalette(int id, byte palID);
 void        GL_DumpTextures(void);
 void        GL_ResetTextures(void);
+void        GL_SetStreamedTexture(int type, int index, int pal, dboolean alpha, Image &image);
+void        GL_PrecacheWorldTexture(int texnum, int pal);
+void        GL_PrecacheSpriteTexture(int spritenum, int pal);
+size_t      GL_TextureMemory(void);
+void        GL_UpdateTextureResidency(void);
+void        GL_GetTextureResidency(int *count, size_t *bytes, int *evicted);
 void        GL_BindDummyTexture(void);
 void        GL_UpdateEnvTexture(rcolor color);
 void        GL_BindEnvTexture(void);
@@ -280,6 +280,17 @@ extern fixed_t        bmaporgy;    // origin of block map
 extern mobj_t**        blocklinks;    // for thing chains
 
 
+//
+// P_PVS
+//
+extern byte*        pvsmatrix;      // NULL if the map has none
+extern int          pvsrowbytes;
+
+void        P_LoadPVS(void);
+dboolean    P_CheckPVS(int s1, int s2);
+dboolean    P_CheckPVSPoint(int s1, int s2);
+
+
 
 //
 // P_INTER
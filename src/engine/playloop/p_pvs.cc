@@ -0,0 +1,429 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Potentially visible set.
+//    Two-sided lines and minisegs between subsectors are treated as
+//    portals, and the subsectors that can be seen through each portal
+//    are found by flowing through the portals behind it, clipping each
+//    one to the lines that pass through both the first portal and the
+//    one before it. Everything is done in 2D, and every door is
+//    assumed to be open. The result is cached on disk, keyed by a hash
+//    of the map's geometry lumps. The portal flow itself lives in
+//    p_pvsbuild.cc, which knows nothing of the map structures.
+//
+//-----------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "p_local.h"
+#include "i_system.h"
+#include "i_swap.h"
+#include "m_misc.h"
+#include "md5.h"
+#include "z_zone.h"
+#include "con_console.h"
+#include "map.hh"
+#include "p_pvsbuild.h"
+
+// bump this whenever the builder changes, so old caches are ignored
+#define PVS_VERSION         2
+
+// one row of bits per subsector, so very large maps go without
+#define PVS_MAXSUBSECTORS   8192
+
+// a seg this close to a leaf edge lies along it
+#define PVS_EPSILON         0.5
+
+byte    *pvsmatrix = NULL;
+int     pvsrowbytes = 0;
+
+// subsectors that touch each one, see P_CheckPVSPoint
+static int  *pvstouch = NULL;
+static int  *pvstouchlist = NULL;
+
+//
+// P_PVSLineDist
+//
+
+static double P_PVSLineDist(const pvsedge_t *edge, double len, const pvspoint_t *p) {
+    return ((edge->p[1].x - edge->p[0].x) * (p->y - edge->p[0].y) -
+            (edge->p[1].y - edge->p[0].y) * (p->x - edge->p[0].x)) / len;
+}
+
+//
+// P_PVSLeafEdges
+//
+
+static void P_PVSLeafEdges(int num, std::vector<pvsedge_t> &edges) {
+    subsector_t *ss = &subsectors[num];
+    int i;
+    int j;
+
+    edges.clear();
+
+    if(ss->numleafs < 3) {
+        return;
+    }
+
+    for(i = 0; i < ss->numleafs; i++) {
+        vertex_t *v1 = leafs[ss->leaf + i].vertex;
+        vertex_t *v2 = leafs[ss->leaf + (i + 1) % ss->numleafs].vertex;
+        pvsedge_t edge;
+        double len;
+
+        edge.p[0].x = (double)v1->x / FRACUNIT;
+        edge.p[0].y = (double)v1->y / FRACUNIT;
+        edge.p[1].x = (double)v2->x / FRACUNIT;
+        edge.p[1].y = (double)v2->y / FRACUNIT;
+        edge.solid = false;
+
+        len = sqrt((edge.p[1].x - edge.p[0].x) * (edge.p[1].x - edge.p[0].x) +
+                   (edge.p[1].y - edge.p[0].y) * (edge.p[1].y - edge.p[0].y));
+
+        // solid if a one-sided seg of this subsector lies along it
+        if(len >= PVS_EPSILON) {
+            for(j = 0; j < ss->numlines; j++) {
+                seg_t *seg = &segs[ss->firstline + j];
+                pvspoint_t s1;
+                pvspoint_t s2;
+
+                if(seg->backsector || !seg->linedef) {
+                    continue;
+                }
+
+                s1.x = (double)seg->v1->x / FRACUNIT;
+                s1.y = (double)seg->v1->y / FRACUNIT;
+                s2.x = (double)seg->v2->x / FRACUNIT;
+                s2.y = (double)seg->v2->y / FRACUNIT;
+
+                if(fabs(P_PVSLineDist(&edge, len, &s1)) < PVS_EPSILON &&
+                        fabs(P_PVSLineDist(&edge, len, &s2)) < PVS_EPSILON) {
+                    edge.solid = true;
+                    break;
+                }
+            }
+        }
+
+        edges.push_back(edge);
+    }
+}
+
+//
+// P_PVSMakeTouch
+// Subsectors that share a vertex or a portal with each one
+//
+
+static void P_PVSMakeTouch(void) {
+    std::unordered_multimap<uint64, int> vertexmap;
+    std::vector<std::vector<int>> touch(numsubsectors);
+    std::vector<int> across;
+    int count;
+    int i;
+    int j;
+
+    for(i = 0; i < numsubsectors; i++) {
+        for(j = 0; j < subsectors[i].numleafs; j++) {
+            vertex_t *v = leafs[subsectors[i].leaf + j].vertex;
+            vertexmap.emplace(((uint64)(uint32)v->x << 32) | (uint32)v->y, i);
+        }
+    }
+
+    for(i = 0; i < numsubsectors; i++) {
+        for(j = 0; j < subsectors[i].numleafs; j++) {
+            vertex_t *v = leafs[subsectors[i].leaf + j].vertex;
+            auto range = vertexmap.equal_range(((uint64)(uint32)v->x << 32) | (uint32)v->y);
+
+            for(auto it = range.first; it != range.second; ++it) {
+                touch[i].push_back(it->second);
+            }
+        }
+
+        P_PVSPortalLeafs(i, across);
+        touch[i].insert(touch[i].end(), across.begin(), across.end());
+
+        std::sort(touch[i].begin(), touch[i].end());
+        touch[i].erase(std::unique(touch[i].begin(), touch[i].end()), touch[i].end());
+    }
+
+    count = 0;
+    for(i = 0; i < numsubsectors; i++) {
+        count += (int)touch[i].size();
+    }
+
+    pvstouch = (int*)Z_Malloc((numsubsectors + 1) * sizeof(int), PU_LEVEL, 0);
+    pvstouchlist = (int*)Z_Malloc(MAX(count, 1) * sizeof(int), PU_LEVEL, 0);
+
+    count = 0;
+    for(i = 0; i < numsubsectors; i++) {
+        pvstouch[i] = count;
+
+        for(int leaf : touch[i]) {
+            pvstouchlist[count++] = leaf;
+        }
+    }
+
+    pvstouch[numsubsectors] = count;
+}
+
+//
+// P_PVSCacheName
+//
+
+static char *P_PVSCacheName(void) {
+    static const int hashlumps[] = {
+        ML_LINEDEFS, ML_SIDEDEFS, ML_VERTEXES, ML_SEGS, ML_SSECTORS, ML_NODES, ML_LEAFS
+    };
+    md5_context_t md5;
+    md5_digest_t digest;
+    char name[64];
+    int i;
+
+    MD5_Init(&md5);
+    MD5_UpdateInt32(&md5, PVS_VERSION);
+
+    for(i = 0; i < (int)(sizeof(hashlumps) / sizeof(hashlumps[0])); i++) {
+        MD5_UpdateInt32(&md5, W_MapLumpLength(hashlumps[i]));
+        MD5_Update(&md5, (byte*)W_GetMapLump(hashlumps[i]), W_MapLumpLength(hashlumps[i]));
+    }
+
+    MD5_Final(digest, &md5);
+
+    for(i = 0; i < 16; i++) {
+        sprintf(name + i * 2, "%02x", digest[i]);
+    }
+
+    dstrcpy(name + 32, ".pvs");
+    return I_GetUserFile(name);
+}
+
+//
+// P_PVSReadCache
+// Rows are stored with runs of zero bytes packed into a count,
+// followed by the touch lists
+//
+
+static dboolean P_PVSReadCache(const char *path) {
+    byte *data;
+    byte *src;
+    byte *end;
+    byte *dst;
+    int size = numsubsectors * pvsrowbytes;
+    int length;
+    int count;
+    int i;
+
+    if((length = M_ReadFile(path, &data)) < 12) {
+        if(length >= 0) {
+            Z_Free(data);
+        }
+
+        return false;
+    }
+
+    src = data + 12;
+    end = data + length;
+    dst = pvsmatrix;
+
+    if(dstrncmp((char*)data, "PVS2", 4) ||
+            (int)I_SwapLE32(*(uint32*)(data + 4)) != numsubsectors ||
+            (int)I_SwapLE32(*(uint32*)(data + 8)) != pvsrowbytes) {
+        Z_Free(data);
+        return false;
+    }
+
+    for(i = 0; i < size && src < end;) {
+        if(*src) {
+            dst[i++] = *src++;
+            continue;
+        }
+
+        if(src + 1 >= end || i + src[1] > size) {
+            break;
+        }
+
+        dmemset(dst + i, 0, src[1]);
+        i += src[1];
+        src += 2;
+    }
+
+    if(i != size || end - src < (numsubsectors + 1) * 4) {
+        Z_Free(data);
+        return false;
+    }
+
+    count = (int)I_SwapLE32(*(uint32*)(src + numsubsectors * 4));
+
+    if(count < 0 || end - src != (numsubsectors + 1 + count) * 4) {
+        Z_Free(data);
+        return false;
+    }
+
+    pvstouch = (int*)Z_Malloc((numsubsectors + 1) * sizeof(int), PU_LEVEL, 0);
+    pvstouchlist = (int*)Z_Malloc(MAX(count, 1) * sizeof(int), PU_LEVEL, 0);
+
+    for(i = 0; i <= numsubsectors; i++, src += 4) {
+        pvstouch[i] = (int)I_SwapLE32(*(uint32*)src);
+    }
+
+    for(i = 0; i < count; i++, src += 4) {
+        pvstouchlist[i] = (int)I_SwapLE32(*(uint32*)src);
+    }
+
+    Z_Free(data);
+
+    return true;
+}
+
+//
+// P_PVSWriteCache
+//
+
+static void P_PVSWriteCache(const char *path) {
+    std::vector<byte> out;
+    uint32 header[2];
+    int size = numsubsectors * pvsrowbytes;
+    int i;
+
+    header[0] = I_SwapLE32(numsubsectors);
+    header[1] = I_SwapLE32(pvsrowbytes);
+
+    out.insert(out.end(), (const byte*)"PVS2", (const byte*)"PVS2" + 4);
+    out.insert(out.end(), (byte*)header, (byte*)header + sizeof(header));
+
+    for(i = 0; i < size;) {
+        int count;
+
+        if(pvsmatrix[i]) {
+            out.push_back(pvsmatrix[i++]);
+            continue;
+        }
+
+        for(count = 0; i < size && count < 255 && !pvsmatrix[i]; count++, i++);
+
+        out.push_back(0);
+        out.push_back((byte)count);
+    }
+
+    for(i = 0; i < numsubsectors + pvstouch[numsubsectors] + 1; i++) {
+        uint32 value;
+
+        value = I_SwapLE32(i <= numsubsectors ? pvstouch[i] : pvstouchlist[i - numsubsectors - 1]);
+        out.insert(out.end(), (byte*)&value, (byte*)&value + sizeof(value));
+    }
+
+    if(!M_WriteFile(path, out.data(), (int)out.size())) {
+        CON_Warnf("Couldn't write PVS cache %s\n", path);
+    }
+}
+
+//
+// P_LoadPVS
+// Must be called while the map lumps are still cached
+//
+
+void P_LoadPVS(void) {
+    char *path;
+    int starttime;
+    int numportals;
+
+    pvsmatrix = NULL;
+    pvsrowbytes = 0;
+    pvstouch = NULL;
+    pvstouchlist = NULL;
+
+    if(numsubsectors > PVS_MAXSUBSECTORS || numleafs != numsubsectors) {
+        return;
+    }
+
+    pvsrowbytes = (numsubsectors + 7) >> 3;
+    pvsmatrix = (byte*)Z_Calloc(numsubsectors * pvsrowbytes, PU_LEVEL, 0);
+
+    path = P_PVSCacheName();
+
+    // the portals are only needed when there's no cache to read
+    if(!path || !P_PVSReadCache(path)) {
+        pvsleafs_t leafedges(numsubsectors);
+        int i;
+
+        for(i = 0; i < numsubsectors; i++) {
+            P_PVSLeafEdges(i, leafedges[i]);
+        }
+
+        P_PVSMakePortals(leafedges);
+        P_PVSMakeTouch();
+
+        dmemset(pvsmatrix, 0, numsubsectors * pvsrowbytes);
+
+        starttime = I_GetTimeMS();
+        numportals = P_PVSBuild(pvsmatrix, pvsrowbytes);
+        CON_DPrintf("PVS: %i portals\n", numportals);
+        CON_DPrintf("PVS built in %i ms\n", I_GetTimeMS() - starttime);
+
+        P_PVSFreePortals();
+
+        if(path) {
+            P_PVSWriteCache(path);
+        }
+    }
+
+    free(path);
+}
+
+//
+// P_CheckPVS
+// Returns false if nothing in subsector s2 can be seen from s1
+//
+
+dboolean P_CheckPVS(int s1, int s2) {
+    if(!pvsmatrix) {
+        return true;
+    }
+
+    return (pvsmatrix[s1 * pvsrowbytes + (s2 >> 3)] & (1 << (s2 & 7))) != 0;
+}
+
+//
+// P_CheckPVSPoint
+// Something standing right on the edge of subsector s2 can
+// be seen through whichever subsector is on the other side,
+// so any subsector touching s2 counts as well
+//
+
+dboolean P_CheckPVSPoint(int s1, int s2) {
+    int i;
+
+    if(P_CheckPVS(s1, s2)) {
+        return true;
+    }
+
+    for(i = pvstouch[s2]; i < pvstouch[s2 + 1]; i++) {
+        if(P_CheckPVS(s1, pvstouchlist[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
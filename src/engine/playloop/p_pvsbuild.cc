@@ -0,0 +1,617 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Portal flow for the potentially visible set. Only 2D geometry
+//    goes in and only the visibility matrix comes out, so the flow
+//    can be tested away from the rest of the engine. Loading and
+//    caching is done in p_pvs.cc.
+//
+//-----------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "p_pvsbuild.h"
+
+// everything is rounded towards visible by this much
+#define PVS_EPSILON         0.5
+
+// steps a single portal may take before settling for its rough set
+#define PVS_MAXFLOW         8192
+
+#define PVS_TESTBIT(bits, n)    ((bits)[(n) >> 5] & (1u << ((n) & 31)))
+#define PVS_SETBIT(bits, n)     ((bits)[(n) >> 5] |= (1u << ((n) & 31)))
+
+typedef struct {
+    pvspoint_t  p[2];
+    bool        empty;
+} pvswinding_t;
+
+typedef struct {
+    double  a;
+    double  b;
+    double  c;
+} pvsplane_t;
+
+typedef struct {
+    pvswinding_t    winding;
+    pvsplane_t      plane;      // front side faces into leaf
+    int             owner;
+    int             leaf;
+    int             mightcount;
+    uint32_t        *mightsee;
+    uint32_t        *vis;
+    bool            done;
+} pvsportal_t;
+
+static std::vector<pvsportal_t>             pvsportals;
+static std::vector<std::vector<int>>        pvsleafportals;
+static std::vector<unsigned char>           pvsopenleafs;
+static std::vector<uint32_t>                pvsbits;
+static std::vector<std::vector<uint32_t>>   pvsmightstack;
+static std::vector<unsigned char>           pvsonstack;
+static int                                  pvsnumleafs;
+static int                                  pvsleaflongs;
+static int                                  pvsflowcount;
+
+//
+// P_PVSDist
+//
+
+static double P_PVSDist(const pvsplane_t *plane, const pvspoint_t *p) {
+    return plane->a * p->x + plane->b * p->y + plane->c;
+}
+
+//
+// P_PVSPlane
+// Plane through two points, facing away from behind
+//
+
+static bool P_PVSPlane(pvsplane_t *plane, const pvspoint_t *p1, const pvspoint_t *p2,
+                           const pvspoint_t *behind) {
+    double dx = p2->x - p1->x;
+    double dy = p2->y - p1->y;
+    double len = sqrt(dx * dx + dy * dy);
+
+    if(len < PVS_EPSILON) {
+        return false;
+    }
+
+    plane->a = -dy / len;
+    plane->b = dx / len;
+    plane->c = -(plane->a * p1->x + plane->b * p1->y);
+
+    if(behind && P_PVSDist(plane, behind) > 0) {
+        plane->a = -plane->a;
+        plane->b = -plane->b;
+        plane->c = -plane->c;
+    }
+
+    return true;
+}
+
+//
+// P_PVSClipWinding
+// Keeps the part of the winding in front of the plane,
+// or behind it if front is false
+//
+
+static pvswinding_t P_PVSClipWinding(const pvswinding_t &w, const pvsplane_t *plane, bool front) {
+    pvswinding_t out = w;
+    double d0 = P_PVSDist(plane, &w.p[0]);
+    double d1 = P_PVSDist(plane, &w.p[1]);
+    double frac;
+
+    if(!front) {
+        d0 = -d0;
+        d1 = -d1;
+    }
+
+    if(d0 >= -PVS_EPSILON && d1 >= -PVS_EPSILON) {
+        return out;
+    }
+
+    if(d0 < -PVS_EPSILON && d1 < -PVS_EPSILON) {
+        out.empty = true;
+        return out;
+    }
+
+    // cut where the winding is epsilon behind the plane
+    frac = (d0 + PVS_EPSILON) / (d0 - d1);
+
+    if(d0 < -PVS_EPSILON) {
+        out.p[0].x = w.p[0].x + frac * (w.p[1].x - w.p[0].x);
+        out.p[0].y = w.p[0].y + frac * (w.p[1].y - w.p[0].y);
+    }
+    else {
+        out.p[1].x = w.p[0].x + frac * (w.p[1].x - w.p[0].x);
+        out.p[1].y = w.p[0].y + frac * (w.p[1].y - w.p[0].y);
+    }
+
+    return out;
+}
+
+//
+// P_PVSClipSeparators
+// A line through both the source and the pass portal can only reach
+// the part of the target on the pass side of any line from one end of
+// the source through one end of the pass that has the rest of the
+// source on the other side
+//
+
+static pvswinding_t P_PVSClipSeparators(const pvswinding_t &source, const pvswinding_t &pass,
+                                        pvswinding_t target) {
+    pvsplane_t sep;
+    double ds;
+    double dp;
+    int i;
+    int j;
+
+    for(i = 0; i < 2; i++) {
+        for(j = 0; j < 2; j++) {
+            if(!P_PVSPlane(&sep, &source.p[i], &pass.p[j], NULL)) {
+                continue;
+            }
+
+            ds = P_PVSDist(&sep, &source.p[i ^ 1]);
+            dp = P_PVSDist(&sep, &pass.p[j ^ 1]);
+
+            if(fabs(dp) < PVS_EPSILON) {
+                continue;
+            }
+
+            if(dp < 0) {
+                sep.a = -sep.a;
+                sep.b = -sep.b;
+                sep.c = -sep.c;
+                ds = -ds;
+            }
+
+            // the source has to be on the other side, or on the line
+            if(ds > 0) {
+                continue;
+            }
+
+            target = P_PVSClipWinding(target, &sep, true);
+
+            if(target.empty) {
+                return target;
+            }
+        }
+    }
+
+    return target;
+}
+
+//
+// P_PVSAddPortal
+//
+
+static void P_PVSAddPortal(int owner, int leaf, const pvspoint_t *p1, const pvspoint_t *p2,
+                           const pvspoint_t *center) {
+    pvsportal_t portal;
+
+    portal.winding.p[0] = *p1;
+    portal.winding.p[1] = *p2;
+    portal.winding.empty = false;
+    portal.owner = owner;
+    portal.leaf = leaf;
+    portal.mightcount = 0;
+    portal.mightsee = NULL;
+    portal.vis = NULL;
+    portal.done = false;
+
+    if(!P_PVSPlane(&portal.plane, p1, p2, center)) {
+        return;
+    }
+
+    pvsleafportals[owner].push_back((int)pvsportals.size());
+    pvsportals.push_back(portal);
+}
+
+//
+// P_PVSMakePortals
+// Pairs every open leaf edge with the edges on the other side of it.
+// Both sides usually share the same two vertexes, otherwise the
+// overlapping part of any collinear edge facing the other way is used.
+//
+
+void P_PVSMakePortals(const pvsleafs_t &leafedges) {
+    std::vector<pvspoint_t> centers(leafedges.size());
+    std::unordered_multimap<uint64_t, std::pair<int, int>> edgemap;
+    int i;
+    int j;
+
+    pvsnumleafs = (int)leafedges.size();
+    pvsportals.clear();
+    pvsleafportals.assign(pvsnumleafs, std::vector<int>());
+    pvsopenleafs.assign(pvsnumleafs, 0);
+
+    for(i = 0; i < pvsnumleafs; i++) {
+        if(leafedges[i].size() < 3) {
+            continue;
+        }
+
+        pvsopenleafs[i] = 1;
+        centers[i].x = centers[i].y = 0;
+
+        for(const pvsedge_t &e : leafedges[i]) {
+            centers[i].x += e.p[0].x;
+            centers[i].y += e.p[0].y;
+        }
+
+        centers[i].x /= leafedges[i].size();
+        centers[i].y /= leafedges[i].size();
+    }
+
+    auto edgekey = [](const pvspoint_t &a, const pvspoint_t &b) {
+        uint64_t h = 0;
+
+        h = h * 31 + (uint64_t)(int64_t)(a.x * 16);
+        h = h * 31 + (uint64_t)(int64_t)(a.y * 16);
+        h = h * 31 + (uint64_t)(int64_t)(b.x * 16);
+        h = h * 31 + (uint64_t)(int64_t)(b.y * 16);
+
+        return h;
+    };
+
+    for(i = 0; i < pvsnumleafs; i++) {
+        for(j = 0; j < (int)leafedges[i].size(); j++) {
+            const pvsedge_t &e = leafedges[i][j];
+            edgemap.emplace(edgekey(e.p[0], e.p[1]), std::make_pair(i, j));
+        }
+    }
+
+    for(i = 0; i < pvsnumleafs; i++) {
+        for(j = 0; j < (int)leafedges[i].size(); j++) {
+            const pvsedge_t &e = leafedges[i][j];
+            pvsplane_t plane;
+            double len;
+            bool found = false;
+            int k;
+            int m;
+
+            if(e.solid) {
+                continue;
+            }
+
+            auto range = edgemap.equal_range(edgekey(e.p[1], e.p[0]));
+
+            for(auto it = range.first; it != range.second; ++it) {
+                const pvsedge_t &o = leafedges[it->second.first][it->second.second];
+
+                if(it->second.first == i || o.solid) {
+                    continue;
+                }
+
+                if(o.p[0].x == e.p[1].x && o.p[0].y == e.p[1].y &&
+                        o.p[1].x == e.p[0].x && o.p[1].y == e.p[0].y) {
+                    P_PVSAddPortal(i, it->second.first, &e.p[0], &e.p[1], &centers[i]);
+                    found = true;
+                }
+            }
+
+            if(found || !P_PVSPlane(&plane, &e.p[0], &e.p[1], NULL)) {
+                continue;
+            }
+
+            // the other side is split differently
+            len = sqrt((e.p[1].x - e.p[0].x) * (e.p[1].x - e.p[0].x) +
+                       (e.p[1].y - e.p[0].y) * (e.p[1].y - e.p[0].y));
+
+            for(k = 0; k < pvsnumleafs; k++) {
+                if(k == i) {
+                    continue;
+                }
+
+                for(m = 0; m < (int)leafedges[k].size(); m++) {
+                    const pvsedge_t &o = leafedges[k][m];
+                    double t0;
+                    double t1;
+                    pvspoint_t p1;
+                    pvspoint_t p2;
+
+                    if(o.solid) {
+                        continue;
+                    }
+
+                    if(fabs(P_PVSDist(&plane, &o.p[0])) >= PVS_EPSILON ||
+                            fabs(P_PVSDist(&plane, &o.p[1])) >= PVS_EPSILON) {
+                        continue;
+                    }
+
+                    // distance along the edge, divided by its length
+                    t0 = ((o.p[1].x - e.p[0].x) * (e.p[1].x - e.p[0].x) +
+                          (o.p[1].y - e.p[0].y) * (e.p[1].y - e.p[0].y)) / (len * len);
+                    t1 = ((o.p[0].x - e.p[0].x) * (e.p[1].x - e.p[0].x) +
+                          (o.p[0].y - e.p[0].y) * (e.p[1].y - e.p[0].y)) / (len * len);
+
+                    // must face the other way
+                    if(t1 <= t0) {
+                        continue;
+                    }
+
+                    t0 = std::max(t0, 0.0);
+                    t1 = std::min(t1, 1.0);
+
+                    if((t1 - t0) * len < PVS_EPSILON) {
+                        continue;
+                    }
+
+                    p1.x = e.p[0].x + t0 * (e.p[1].x - e.p[0].x);
+                    p1.y = e.p[0].y + t0 * (e.p[1].y - e.p[0].y);
+                    p2.x = e.p[0].x + t1 * (e.p[1].x - e.p[0].x);
+                    p2.y = e.p[0].y + t1 * (e.p[1].y - e.p[0].y);
+
+                    P_PVSAddPortal(i, k, &p1, &p2, &centers[i]);
+                }
+            }
+        }
+    }
+}
+
+//
+// P_PVSPortalLeafs
+// Leafs on the other side of any portal out of leaf
+//
+
+void P_PVSPortalLeafs(int leaf, std::vector<int> &out) {
+    out.clear();
+
+    for(int pnum : pvsleafportals[leaf]) {
+        out.push_back(pvsportals[pnum].leaf);
+    }
+}
+
+//
+// P_PVSPortalFront
+// Some of q is in front of p, and some of p is behind q
+//
+
+static bool P_PVSPortalFront(const pvsportal_t *p, const pvsportal_t *q) {
+    if(P_PVSDist(&p->plane, &q->winding.p[0]) <= -PVS_EPSILON &&
+            P_PVSDist(&p->plane, &q->winding.p[1]) <= -PVS_EPSILON) {
+        return false;
+    }
+
+    if(P_PVSDist(&q->plane, &p->winding.p[0]) >= PVS_EPSILON &&
+            P_PVSDist(&q->plane, &p->winding.p[1]) >= PVS_EPSILON) {
+        return false;
+    }
+
+    return true;
+}
+
+//
+// P_PVSMightSee
+// Rough set of leafs that a portal could possibly see into,
+// used to cut the flow short
+//
+
+static void P_PVSMightSee(pvsportal_t *p) {
+    std::vector<int> stack;
+
+    stack.push_back(p->leaf);
+    PVS_SETBIT(p->mightsee, p->leaf);
+    p->mightcount = 1;
+
+    while(!stack.empty()) {
+        int leaf = stack.back();
+
+        stack.pop_back();
+
+        for(int qnum : pvsleafportals[leaf]) {
+            pvsportal_t *q = &pvsportals[qnum];
+
+            if(PVS_TESTBIT(p->mightsee, q->leaf) || !P_PVSPortalFront(p, q)) {
+                continue;
+            }
+
+            PVS_SETBIT(p->mightsee, q->leaf);
+            p->mightcount++;
+            stack.push_back(q->leaf);
+        }
+    }
+}
+
+//
+// P_PVSFlow
+//
+
+static void P_PVSFlow(pvsportal_t *p, int leaf, const pvswinding_t &source,
+                      const pvswinding_t *pass, const uint32_t *might, int depth) {
+    uint32_t *newmight;
+    int i;
+
+    if(++pvsflowcount > PVS_MAXFLOW) {
+        return;
+    }
+
+    PVS_SETBIT(p->vis, leaf);
+    pvsonstack[leaf] = 1;
+
+    if((int)pvsmightstack.size() <= depth) {
+        pvsmightstack.resize(depth + 1);
+    }
+
+    if(pvsmightstack[depth].empty()) {
+        pvsmightstack[depth].resize(pvsleaflongs);
+    }
+
+    newmight = pvsmightstack[depth].data();
+
+    for(int qnum : pvsleafportals[leaf]) {
+        pvsportal_t *q = &pvsportals[qnum];
+        const uint32_t *test;
+        pvswinding_t target;
+        pvswinding_t newsource;
+        bool more;
+
+        if(!PVS_TESTBIT(might, q->leaf) || pvsonstack[q->leaf]) {
+            continue;
+        }
+
+        // what has been found through q already is all it can add
+        test = q->done ? q->vis : q->mightsee;
+        more = false;
+
+        for(i = 0; i < pvsleaflongs; i++) {
+            newmight[i] = might[i] & test[i];
+
+            if(newmight[i] & ~p->vis[i]) {
+                more = true;
+            }
+        }
+
+        if(!more && PVS_TESTBIT(p->vis, q->leaf)) {
+            continue;
+        }
+
+        // the target has to be in front of the first portal,
+        // and what is left of that portal behind the target
+        target = P_PVSClipWinding(q->winding, &p->plane, true);
+        if(target.empty) {
+            continue;
+        }
+
+        newsource = P_PVSClipWinding(source, &q->plane, false);
+        if(newsource.empty) {
+            continue;
+        }
+
+        if(pass) {
+            target = P_PVSClipSeparators(newsource, *pass, target);
+            if(target.empty) {
+                continue;
+            }
+
+            // the same works backwards, from the target through the pass
+            newsource = P_PVSClipSeparators(target, *pass, newsource);
+            if(newsource.empty) {
+                continue;
+            }
+        }
+
+        P_PVSFlow(p, q->leaf, newsource, &target, newmight, depth + 1);
+
+        // the deeper levels may have moved the stack around
+        newmight = pvsmightstack[depth].data();
+    }
+
+    pvsonstack[leaf] = 0;
+}
+
+//
+// P_PVSBuild
+// Sets a bit in row i of the matrix for every leaf that leaf i can see.
+// The matrix has to be cleared first. Returns the number of portals.
+//
+
+int P_PVSBuild(unsigned char *matrix, int rowbytes) {
+    std::vector<int> order;
+    std::vector<uint32_t> leafvis;
+    int i;
+    int j;
+
+    pvsleaflongs = (pvsnumleafs + 31) >> 5;
+    pvsbits.assign(pvsportals.size() * pvsleaflongs * 2, 0);
+    pvsonstack.assign(pvsnumleafs, 0);
+
+    for(i = 0; i < (int)pvsportals.size(); i++) {
+        pvsportals[i].mightsee = &pvsbits[(i * 2) * pvsleaflongs];
+        pvsportals[i].vis = &pvsbits[(i * 2 + 1) * pvsleaflongs];
+
+        P_PVSMightSee(&pvsportals[i]);
+        order.push_back(i);
+    }
+
+    // portals that see little go first, so that the
+    // busier ones can use their results
+    std::stable_sort(order.begin(), order.end(), [](int a, int b) {
+        return pvsportals[a].mightcount < pvsportals[b].mightcount;
+    });
+
+    for(int pnum : order) {
+        pvsportal_t *p = &pvsportals[pnum];
+
+        // a line can't come back into the leaf it started from
+        pvsonstack[p->owner] = 1;
+        pvsflowcount = 0;
+        P_PVSFlow(p, p->leaf, p->winding, NULL, p->mightsee, 0);
+        pvsonstack[p->owner] = 0;
+
+        if(pvsflowcount > PVS_MAXFLOW) {
+            for(j = 0; j < pvsleaflongs; j++) {
+                p->vis[j] |= p->mightsee[j];
+            }
+        }
+
+        p->done = true;
+    }
+
+    leafvis.resize(pvsleaflongs);
+
+    for(i = 0; i < pvsnumleafs; i++) {
+        std::fill(leafvis.begin(), leafvis.end(), 0);
+        PVS_SETBIT(leafvis, i);
+
+        for(int pnum : pvsleafportals[i]) {
+            for(j = 0; j < pvsleaflongs; j++) {
+                leafvis[j] |= pvsportals[pnum].vis[j];
+            }
+        }
+
+        for(j = 0; j < pvsnumleafs; j++) {
+            if(PVS_TESTBIT(leafvis, j)) {
+                matrix[i * rowbytes + (j >> 3)] |= (1 << (j & 7));
+            }
+        }
+    }
+
+    // leafs without a proper polygon can't be reasoned about,
+    // and the result is made symmetric to be safe
+    for(i = 0; i < pvsnumleafs; i++) {
+        for(j = 0; j < pvsnumleafs; j++) {
+            if(!pvsopenleafs[i] || !pvsopenleafs[j] ||
+                    (matrix[j * rowbytes + (i >> 3)] & (1 << (i & 7)))) {
+                matrix[i * rowbytes + (j >> 3)] |= (1 << (j & 7));
+            }
+        }
+    }
+
+    pvsbits.clear();
+    pvsmightstack.clear();
+    pvsonstack.clear();
+
+    return (int)pvsportals.size();
+}
+
+//
+// P_PVSFreePortals
+//
+
+void P_PVSFreePortals(void) {
+    pvsportals.clear();
+    pvsleafportals.clear();
+    pvsopenleafs.clear();
+}
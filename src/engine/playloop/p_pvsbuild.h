@@ -0,0 +1,52 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Portal flow for the PVS, on plain 2D geometry.
+//    Only for p_pvs.cc and its test.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __P_PVSBUILD__
+#define __P_PVSBUILD__
+
+#include <stdint.h>
+#include <vector>
+
+typedef struct {
+    double  x;
+    double  y;
+} pvspoint_t;
+
+typedef struct {
+    pvspoint_t  p[2];
+    bool        solid;      // a one-sided line lies along it
+} pvsedge_t;
+
+// The edges of each leaf's convex polygon, all wound the same way. Leafs
+// with fewer than three edges see, and are seen from, everywhere.
+typedef std::vector<std::vector<pvsedge_t>> pvsleafs_t;
+
+void    P_PVSMakePortals(const pvsleafs_t &leafedges);
+void    P_PVSPortalLeafs(int leaf, std::vector<int> &out);
+int     P_PVSBuild(unsigned char *matrix, int rowbytes);
+void    P_PVSFreePortals(void);
+
+#endif
@@ -930,6 +930,8 @@ void P_SetupSky(void) {
     sky                 = NULL;
     logoAlpha           = 0;
 
+    R_InitSkyMeshes();
+
     if(skyflatnum == -1) {
         return;
     }
@@ -1028,6 +1030,7 @@ void P_SetupLevel(int map, int playermask, skill_t skill, bool spawn_mobjs) {
     P_LoadSegs(ML_SEGS);
     P_LoadLeafs(ML_LEAFS);
     P_LoadReject(ML_REJECT);
+    P_LoadPVS();
     P_LoadLights(ML_LIGHTS);
     P_GroupLines();
     P_LoadThings(ML_THINGS, spawn_mobjs);
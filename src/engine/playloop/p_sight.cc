@@ -333,6 +333,14 @@ dboolean P_CheckSight(mobj_t* t1, mobj_t* t2) {
         return false;
     }
 
+    // the PVS is finer grained than REJECT, but it
+    // isn't in the original game so it is optional
+    if((gameflags & GF_PVSSIGHT) &&
+            !P_CheckPVSPoint(t1->subsector - subsectors, t2->subsector - subsectors)) {
+        sightcounts[0]++;
+        return false;
+    }
+
     // An unobstructed LOS is possible.
     // Now look from eyes of t1 to any part of t2.
     sightcounts[1]++;
@@ -66,7 +66,6 @@ static byte tryopentype[3];
 typedef struct {
     dboolean isreverse;
     int delay;
-    int texnum;
     int tic;
     int frame;
 } animinfo_t;
@@ -177,14 +176,14 @@ void P_InitPicAnims(void) {
         animinfo[i].delay = 0;
         animinfo[i].tic = 0;
         animinfo[i].isreverse = false;
-        animinfo[i].texnum = wad::open(wad::Section::textures, animdefs[i].name).value().section_index();
+        animdefs[i].texnum = wad::open(wad::Section::textures, animdefs[i].name).value().section_index();
         animinfo[i].frame = -1;
 
         // reallocate texture pointers if they contain multiple palettes
         // check by looking up animdefs
 
         if(animdefs[i].palette) {
-            int lump = animinfo[i].texnum;
+            int lump = animdefs[i].texnum;
 
             textureptr[lump] = (dtexture*)Z_Realloc(textureptr[lump],
                                                     animdefs[i].frames * sizeof(dtexture), PU_STATIC, 0);
@@ -232,10 +231,10 @@ void P_CyclePicAnims(void) {
         }
 
         if(anim->palette) {
-            GL_SetNewPalette(info->texnum, info->frame);
+            GL_SetNewPalette(anim->texnum, info->frame);
         }
         else {
-            texturetranslation[info->texnum] = info->texnum + info->frame;
+            texturetranslation[anim->texnum] = anim->texnum + info->frame;
         }
 
         if(info->frame == lastpic) {
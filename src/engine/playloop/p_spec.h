@@ -42,6 +42,7 @@ typedef struct {
     int         speed;
     bool        reverse;
     bool        palette;
+    int         texnum;     // resolved by P_InitPicAnims
 } animdef_t;
 
 extern int          numanimdef;
@@ -40,6 +40,8 @@
 #include "r_wipe.h"
 #include "p_setup.h"
 #include "g_demo.h"
+#include "gl_gputimer.h"
+#include "gl_draw.h"
 
 extern cvar::BoolVar i_interpolateframes;
 extern cvar::BoolVar p_damageindicator;
@@ -373,7 +375,9 @@ void P_Stop(void) {
         }
     }
 
-    S_ResetSound();
+    // the level is gone, but sounds play on until the wipe is done
+    S_RemoveSoundSources();
+    WIPE_OnFinish(S_ResetSound);
 
     // action is warpquick only because the user
     // cancelled demo playback...
@@ -403,10 +407,33 @@ void P_Drawer(void) {
         R_RenderPlayerView(&players[displayplayer]);
     }
 
+    GL_BeginGPUPass(GPU_AUTOMAP);
     AM_Drawer();
+    GL_EndGPUPass();
+
+    // the status bar runs before D_DrawInterface opens its
+    // batch, so its text and numbers get one of their own
+    GL_BeginGPUPass(GPU_HUD);
+    Draw_BeginBatch();
     ST_Drawer();
+    Draw_EndBatch();
+    GL_EndGPUPass();
 }
 
+//
+// P_RunPlaysimNormal
+//
+
+static void P_RunPlaysimNormal(void) {
+    P_RunThinkers();
+    P_ScanSights();
+    P_RunMobjs();
+    P_UpdateSpecials();
+    P_RunMacros();
+}
+
+void (*P_RunPlaysim)(void) = P_RunPlaysimNormal;
+
 //
 // P_Ticker
 //
@@ -439,11 +466,7 @@ bool P_Ticker(void) {
         }
     }
 
-    P_RunThinkers();
-    P_ScanSights();
-    P_RunMobjs();
-    P_UpdateSpecials();
-    P_RunMacros();
+    P_RunPlaysim();
 
     ST_Ticker();
     AM_Ticker();
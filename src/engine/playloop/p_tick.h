@@ -39,6 +39,13 @@ void P_Drawer(void);
 // Carries out all thinking of monsters and players.
 bool P_Ticker(void);
 
+void P_RunThinkers(void);
+void P_RunMobjs(void);
+
+// Thinkers, sights, mobjs, specials and macros for one tic.
+// -simdemo swaps in a version that times each of them.
+extern void (*P_RunPlaysim)(void);
+
 
 
 #endif
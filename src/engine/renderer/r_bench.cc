@@ -0,0 +1,438 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Camera path recording and BSP traversal benchmarks.
+//    A camera path is a plain text file with one view position per
+//    rendered frame. Replaying it runs the BSP traversal without
+//    drawing anything, so the front-end cost can be compared between
+//    implementations against the exact same workload.
+//
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+#include <vector>
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "r_local.h"
+#include "r_clipper.h"
+#include "r_drawlist.h"
+#include "r_bench.h"
+#include "con_console.h"
+#include "g_actions.h"
+#include "d_main.h"
+#include "z_zone.h"
+
+typedef struct {
+    fixed_t x;
+    fixed_t y;
+    fixed_t z;
+    angle_t angle;
+    angle_t pitch;
+} campose_t;
+
+static FILE *campathfile = NULL;
+
+//
+// R_BenchRecordFrame
+// Appends the current view to the camera path being recorded
+//
+
+void R_BenchRecordFrame(void) {
+    if(!campathfile) {
+        return;
+    }
+
+    fprintf(campathfile, "%d %d %d %u %u\n", viewx, viewy, viewz, viewangle, viewpitch);
+}
+
+//
+// R_BenchStopRecording
+// A path only covers the map it was started on, so this
+// is also called on level setup and at exit
+//
+
+void R_BenchStopRecording(void) {
+    if(!campathfile) {
+        return;
+    }
+
+    fclose(campathfile);
+    campathfile = NULL;
+
+    CON_Printf(WHITE, "Camera path recording stopped\n");
+}
+
+//
+// R_LoadCamPath
+//
+
+static dboolean R_LoadCamPath(const char *name, std::vector<campose_t> &path) {
+    FILE *f;
+    int map;
+    campose_t pose;
+
+    if(!(f = fopen(name, "r"))) {
+        CON_Warnf("Couldn't open camera path %s\n", name);
+        return false;
+    }
+
+    if(fscanf(f, "CAMPATH %d\n", &map) != 1) {
+        CON_Warnf("%s is not a camera path\n", name);
+        fclose(f);
+        return false;
+    }
+
+    if(map != gamemap) {
+        CON_Warnf("%s was recorded on map %02d\n", name, map);
+        fclose(f);
+        return false;
+    }
+
+    while(fscanf(f, "%d %d %d %u %u\n", &pose.x, &pose.y, &pose.z, &pose.angle, &pose.pitch) == 5) {
+        path.push_back(pose);
+    }
+
+    fclose(f);
+
+    if(path.empty()) {
+        CON_Warnf("%s contains no frames\n", name);
+        return false;
+    }
+
+    return true;
+}
+
+//
+// R_SetCamPose
+//
+
+static void R_SetCamPose(const campose_t *pose) {
+    viewx       = pose->x;
+    viewy       = pose->y;
+    viewz       = pose->z;
+    viewangle   = pose->angle;
+    viewpitch   = pose->pitch;
+
+    fviewx      = F2D3D(viewx);
+    fviewy      = F2D3D(viewy);
+    fviewz      = F2D3D(viewz);
+
+    viewsin[0]  = F2D3D(dsin(viewangle));
+    viewsin[1]  = F2D3D(dsin(viewpitch - ANG90));
+
+    viewcos[0]  = F2D3D(dcos(viewangle));
+    viewcos[1]  = F2D3D(dcos(viewpitch - ANG90));
+
+    D_IncValidCount();
+}
+
+//
+// R_ReplayCamPath
+// Runs the BSP traversal for every frame of the path and
+// returns the time it took in milliseconds
+//
+
+static double R_ReplayCamPath(const std::vector<campose_t> &path, int passes) {
+    auto start = std::chrono::steady_clock::now();
+    int i;
+
+    for(i = 0; i < passes; i++) {
+        for(const auto &pose : path) {
+            drawlist[DLT_WALL].index = 0;
+            drawlist[DLT_FLAT].index = 0;
+            drawlist[DLT_SPRITE].index = 0;
+
+            R_ClearSprites();
+            R_SetCamPose(&pose);
+            R_SetViewMatrix();
+            R_SetViewClipping(R_FrustumAngle());
+            R_RenderBSPNode(numnodes - 1);
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+//
+// R_CountCamPath
+// Runs the BSP traversal once for every frame of the path and
+// keeps the number of walls and flats it found
+//
+
+static void R_CountCamPath(const std::vector<campose_t> &path, std::vector<int> &counts) {
+    counts.clear();
+
+    for(const auto &pose : path) {
+        drawlist[DLT_WALL].index = 0;
+        drawlist[DLT_FLAT].index = 0;
+        drawlist[DLT_SPRITE].index = 0;
+
+        R_ClearSprites();
+        R_SetCamPose(&pose);
+        R_SetViewMatrix();
+        R_SetViewClipping(R_FrustumAngle());
+        R_RenderBSPNode(numnodes - 1);
+
+        counts.push_back(drawlist[DLT_WALL].index);
+        counts.push_back(drawlist[DLT_FLAT].index);
+    }
+}
+
+//
+// R_SaveMapped
+// Traversal marks lines as seen on the automap, so
+// the player's automap is kept intact around benchmarks
+//
+
+static byte *R_SaveMapped(void) {
+    byte *mapped;
+    int i;
+
+    mapped = (byte*)Z_Malloc(numlines, PU_STATIC, NULL);
+    for(i = 0; i < numlines; i++) {
+        mapped[i] = (lines[i].flags & ML_MAPPED) != 0;
+    }
+
+    return mapped;
+}
+
+//
+// R_RestoreMapped
+//
+
+static void R_RestoreMapped(byte *mapped) {
+    int i;
+
+    for(i = 0; i < numlines; i++) {
+        if(!mapped[i]) {
+            lines[i].flags &= ~ML_MAPPED;
+        }
+    }
+
+    Z_Free(mapped);
+}
+
+//
+// R_BenchCamPath
+// Replays the path once per clipper implementation
+//
+
+static void R_BenchCamPath(const char *name, int passes) {
+    std::vector<campose_t> path;
+    byte *mapped;
+    int oldclipper;
+    int frames;
+    int i;
+    double time[NUMCLIPPERS];
+
+    if(gamestate != GS_LEVEL) {
+        CON_Warnf("Must be in a level to run benchmarks\n");
+        return;
+    }
+
+    if(!R_LoadCamPath(name, path)) {
+        return;
+    }
+
+    mapped = R_SaveMapped();
+    oldclipper = *r_clipper;
+    frames = (int)path.size() * passes;
+
+    for(i = 0; i < NUMCLIPPERS; i++) {
+        r_clipper = i;
+
+        // warm up caches before timing
+        R_ReplayCamPath(path, 1);
+        time[i] = R_ReplayCamPath(path, passes);
+    }
+
+    r_clipper = oldclipper;
+
+    R_RestoreMapped(mapped);
+    R_ClearSprites();
+
+    CON_Printf(WHITE, "benchclipper: %s, %i frames\n", name, frames);
+    CON_Printf(WHITE, "  list:  %8.2f ms (%.4f ms/frame)\n", time[CLIPPER_LIST], time[CLIPPER_LIST] / frames);
+    CON_Printf(WHITE, "  array: %8.2f ms (%.4f ms/frame)\n", time[CLIPPER_ARRAY], time[CLIPPER_ARRAY] / frames);
+
+    if(time[CLIPPER_ARRAY] > 0.0) {
+        CON_Printf(WHITE, "  speedup: %.2fx\n", time[CLIPPER_LIST] / time[CLIPPER_ARRAY]);
+    }
+}
+
+//
+// R_BenchCullPath
+// Replays the path with and without frustum culling of BSP
+// nodes. Both must find the same walls and flats every frame.
+//
+
+static void R_BenchCullPath(const char *name, int passes) {
+    std::vector<campose_t> path;
+    std::vector<int> counts[2];
+    byte *mapped;
+    bool oldcull;
+    int frames;
+    int mismatch;
+    int i;
+    double time[2];
+
+    if(gamestate != GS_LEVEL) {
+        CON_Warnf("Must be in a level to run benchmarks\n");
+        return;
+    }
+
+    if(!R_LoadCamPath(name, path)) {
+        return;
+    }
+
+    mapped = R_SaveMapped();
+    oldcull = *r_cullnodes;
+    frames = (int)path.size() * passes;
+
+    for(i = 0; i < 2; i++) {
+        r_cullnodes = (i == 1);
+
+        R_CountCamPath(path, counts[i]);
+        time[i] = R_ReplayCamPath(path, passes);
+    }
+
+    r_cullnodes = oldcull;
+
+    R_RestoreMapped(mapped);
+    R_ClearSprites();
+
+    mismatch = 0;
+    for(i = 0; i < (int)path.size(); i++) {
+        int w = i * 2;
+        int f = i * 2 + 1;
+
+        if(counts[0][w] != counts[1][w] || counts[0][f] != counts[1][f]) {
+            if(mismatch < 10) {
+                CON_Warnf("frame %i: %i/%i walls, %i/%i flats\n", i,
+                          counts[0][w], counts[1][w], counts[0][f], counts[1][f]);
+            }
+
+            mismatch++;
+        }
+    }
+
+    CON_Printf(WHITE, "benchcull: %s, %i frames\n", name, frames);
+    CON_Printf(WHITE, "  off: %8.2f ms (%.4f ms/frame)\n", time[0], time[0] / frames);
+    CON_Printf(WHITE, "  on:  %8.2f ms (%.4f ms/frame)\n", time[1], time[1] / frames);
+
+    if(time[1] > 0.0) {
+        CON_Printf(WHITE, "  speedup: %.2fx\n", time[0] / time[1]);
+    }
+
+    if(mismatch) {
+        CON_Warnf("  %i frame(s) differ\n", mismatch);
+    }
+    else {
+        CON_Printf(WHITE, "  results match\n");
+    }
+}
+
+//
+// CMD_RecordCamPath
+//
+
+static CMD(RecordCamPath) {
+    if(!param[0]) {
+        CON_Printf(WHITE, "Usage: recordcampath <file>\n");
+        return;
+    }
+
+    if(gamestate != GS_LEVEL) {
+        CON_Warnf("Must be in a level to record a camera path\n");
+        return;
+    }
+
+    if(campathfile) {
+        fclose(campathfile);
+    }
+
+    if(!(campathfile = fopen(param[0], "w"))) {
+        CON_Warnf("Couldn't create camera path %s\n", param[0]);
+        return;
+    }
+
+    fprintf(campathfile, "CAMPATH %d\n", gamemap);
+    CON_Printf(WHITE, "Recording camera path to %s\n", param[0]);
+}
+
+//
+// CMD_StopCamPath
+//
+
+static CMD(StopCamPath) {
+    R_BenchStopRecording();
+}
+
+//
+// CMD_BenchClipper
+//
+
+static CMD(BenchClipper) {
+    int passes = 1;
+
+    if(!param[0]) {
+        CON_Printf(WHITE, "Usage: benchclipper <file> [passes]\n");
+        return;
+    }
+
+    if(param[1]) {
+        passes = MAX(datoi(param[1]), 1);
+    }
+
+    R_BenchCamPath(param[0], passes);
+}
+
+//
+// CMD_BenchCull
+//
+
+static CMD(BenchCull) {
+    int passes = 1;
+
+    if(!param[0]) {
+        CON_Printf(WHITE, "Usage: benchcull <file> [passes]\n");
+        return;
+    }
+
+    if(param[1]) {
+        passes = MAX(datoi(param[1]), 1);
+    }
+
+    R_BenchCullPath(param[0], passes);
+}
+
+//
+// R_InitBench
+//
+
+void R_InitBench(void) {
+    G_AddCommand("recordcampath", CMD_RecordCamPath, 0);
+    G_AddCommand("stopcampath", CMD_StopCamPath, 0);
+    G_AddCommand("benchclipper", CMD_BenchClipper, 0);
+    G_AddCommand("benchcull", CMD_BenchCull, 0);
+}
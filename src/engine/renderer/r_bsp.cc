@@ -50,6 +50,12 @@ static void AddSegToDrawlist(drawlist_t *dl, seg_t *line, int texid, int sidetyp
 
 extern cvar::BoolVar i_interpolateframes;
 extern cvar::BoolVar r_texturecombiner;
+extern cvar::BoolVar r_pvs;
+
+// a bit for each child of a node that has a subsector in the PVS
+static byte *pvsnodes = NULL;
+static int pvsviewsub = -1;
+static dboolean pvsactive = false;
 
 //
 // R_AddClipLine
@@ -698,6 +704,101 @@ void R_Subsector(int num) {
     R_AddSprites(sub);
 }
 
+//
+// R_MarkPVSNodes
+//
+
+static dboolean R_MarkPVSNodes(int bspnum, int viewsub) {
+    node_t *bsp;
+    int i;
+
+    if(bspnum & NF_SUBSECTOR) {
+        return P_CheckPVS(viewsub, bspnum & ~NF_SUBSECTOR);
+    }
+
+    bsp = &nodes[bspnum];
+    pvsnodes[bspnum] = 0;
+
+    for(i = 0; i < 2; i++) {
+        if(R_MarkPVSNodes(bsp->children[i], viewsub)) {
+            pvsnodes[bspnum] |= (1 << i);
+        }
+    }
+
+    return pvsnodes[bspnum] != 0;
+}
+
+//
+// R_PointInLeaf
+//
+
+static dboolean R_PointInLeaf(subsector_t *sub, fixed_t x, fixed_t y) {
+    float px = F2D3D(x);
+    float py = F2D3D(y);
+    int front = 0;
+    int back = 0;
+    int i;
+
+    if(sub->numleafs < 3) {
+        return false;
+    }
+
+    for(i = 0; i < sub->numleafs; i++) {
+        vertex_t *v1 = leafs[sub->leaf + i].vertex;
+        vertex_t *v2 = leafs[sub->leaf + (i + 1) % sub->numleafs].vertex;
+        float dx = F2D3D(v2->x - v1->x);
+        float dy = F2D3D(v2->y - v1->y);
+        float side = (px - F2D3D(v1->x)) * dy - (py - F2D3D(v1->y)) * dx;
+
+        if(side > 0) {
+            front++;
+        }
+        else if(side < 0) {
+            back++;
+        }
+    }
+
+    return !(front && back);
+}
+
+//
+// R_SetupPVS
+// Marks the nodes that lead to subsectors visible
+// from the view's subsector
+//
+
+void R_SetupPVS(void) {
+    subsector_t *sub;
+    int num;
+
+    pvsactive = false;
+
+    if(!r_pvs || !pvsmatrix || !numnodes) {
+        return;
+    }
+
+    sub = R_PointInSubsector(viewx, viewy);
+
+    // the PVS means nothing from outside the map
+    if(!R_PointInLeaf(sub, viewx, viewy)) {
+        return;
+    }
+
+    if(!pvsnodes) {
+        pvsnodes = (byte*)Z_Malloc(numnodes, PU_LEVEL, (void**)&pvsnodes);
+        pvsviewsub = -1;
+    }
+
+    num = sub - subsectors;
+
+    if(num != pvsviewsub) {
+        R_MarkPVSNodes(numnodes - 1, num);
+        pvsviewsub = num;
+    }
+
+    pvsactive = true;
+}
+
 //
 // R_RenderBSPNode
 //
@@ -705,6 +806,7 @@ void R_Subsector(int num) {
 void R_RenderBSPNode(int bspnum) {
     node_t  *bsp;
     int     side;
+    int     inview;
 
     while(!(bspnum & NF_SUBSECTOR)) {
         bsp = &nodes[bspnum];
@@ -712,13 +814,21 @@ void R_RenderBSPNode(int bspnum) {
         // Decide which side the view point is on.
         side = R_PointOnSide(viewx, viewy, bsp);
 
+        // both children against the frustum at once,
+        // before the more expensive clipper checks
+        inview = r_cullnodes ? R_FrustrumTestNode(bspnum) : 3;
+
+        if(pvsactive) {
+            inview &= pvsnodes[bspnum];
+        }
+
         // check the front space
-        if(R_CheckBBox(bsp->bbox[side])) {
+        if((inview & (1 << side)) && R_CheckBBox(bsp->bbox[side])) {
             R_RenderBSPNode(bsp->children[side]);
         }
 
         // continue down the back space
-        if(!R_CheckBBox(bsp->bbox[side^1])) {
+        if(!(inview & (1 << (side^1))) || !R_CheckBBox(bsp->bbox[side^1])) {
             return;
         }
 
@@ -25,16 +25,60 @@
 //
 //-----------------------------------------------------------------------------
 
+#include "doomstat.h"
 #include "r_local.h"
+#include "r_clipper.h"
+#include "m_misc.h"
 #include "tables.h"
 #include "m_fixed.h"
 #include "z_zone.h"
+#include "gl_texture.h"
 #include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define USE_SSE_FRUSTUM
+#include <xmmintrin.h>
+#endif
+
+cvar::IntVar r_clipper = 1;
+cvar::BoolVar r_cullnodes = true;
 
 static GLdouble viewMatrix[16];
 static GLdouble projMatrix[16];
+static float clip[16];
 float frustum[6][4];
 
+//
+// The frustum planes again with one array per plane component, so
+// that four planes can be tested at once. Padded to eight planes
+// with planes that always pass.
+//
+
+#define FRUSTUMPLANES   8
+
+alignas(16) static float frustumsoa[4][FRUSTUMPLANES];
+
+//
+// Child boxes of every node, one array per box side. Entry
+// node * 2 + side belongs to nodes[node].bbox[side]. The boxes are
+// grown by the largest sprite, so they hold everything drawn from
+// their subsectors.
+//
+
+static float *nodeboxes[4];
+static float spritepad;
+
+//
+// The left and right edges of the clipper's view angle, as 2D planes
+// (a, b, d) through the view point. They don't depend on the pitch
+// beyond what the clipper already allows for, so a node they cull
+// would have failed R_CheckBBox too, and automap marking is unchanged.
+//
+
+static float nodeplanes[2][3];
+static dboolean nodeclip = false;
+
 typedef struct clipnode_s {
     struct clipnode_s *prev, *next;
     angle_t start, end;
@@ -53,6 +97,26 @@ static void R_Clipper_AddClipRange(angle_t start, angle_t end);
 static void R_Clipper_RemoveRange(clipnode_t * range);
 static void R_Clipnode_Free(clipnode_t *node);
 
+//
+// Array clipper: the occluded ranges are kept as a sorted array of
+// disjoint spans, so visibility checks are a binary search and adding
+// a range is a single memmove instead of walking the clipnode list
+//
+
+typedef struct {
+    angle_t start;
+    angle_t end;
+} clipspan_t;
+
+static clipspan_t   *clipspans      = NULL;
+static int          numclipspans    = 0;
+static int          maxclipspans    = 0;
+
+static int          clipmode        = CLIPPER_ARRAY;
+
+static dboolean R_ClipSpan_IsRangeVisible(angle_t startAngle, angle_t endAngle);
+static void R_ClipSpan_AddClipRange(angle_t start, angle_t end);
+
 static clipnode_t *R_Clipnode_GetNew(void) {
     if(freelist) {
         clipnode_t *p = freelist;
@@ -76,6 +140,14 @@ static clipnode_t * R_Clipnode_NewRange(angle_t start, angle_t end) {
 //
 
 dboolean R_Clipper_SafeCheckRange(angle_t startAngle, angle_t endAngle) {
+    if(clipmode == CLIPPER_ARRAY) {
+        if(startAngle > endAngle)
+            return (R_ClipSpan_IsRangeVisible(startAngle, ANGLE_MAX) ||
+                    R_ClipSpan_IsRangeVisible(0, endAngle));
+
+        return R_ClipSpan_IsRangeVisible(startAngle, endAngle);
+    }
+
     if(startAngle > endAngle)
         return (R_Clipper_IsRangeVisible(startAngle, ANGLE_MAX) ||
                 R_Clipper_IsRangeVisible(0, endAngle));
@@ -129,6 +201,18 @@ static void R_Clipper_RemoveRange(clipnode_t *range) {
 //
 
 void R_Clipper_SafeAddClipRange(angle_t startangle, angle_t endangle) {
+    if(clipmode == CLIPPER_ARRAY) {
+        if(startangle > endangle) {
+            R_ClipSpan_AddClipRange(startangle, ANGLE_MAX);
+            R_ClipSpan_AddClipRange(0, endangle);
+        }
+        else {
+            R_ClipSpan_AddClipRange(startangle, endangle);
+        }
+
+        return;
+    }
+
     if(startangle > endangle) {
         // The range has to added in two parts.
         R_Clipper_AddClipRange(startangle, ANGLE_MAX);
@@ -226,6 +310,99 @@ static void R_Clipper_AddClipRange(angle_t start, angle_t end) {
     }
 }
 
+//
+// R_ClipSpan_Find
+// Returns the index of the first span that ends at or after the given angle
+//
+
+static int R_ClipSpan_Find(angle_t angle) {
+    int lo = 0;
+    int hi = numclipspans;
+
+    while(lo < hi) {
+        int mid = (lo + hi) >> 1;
+
+        if(clipspans[mid].end < angle) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+//
+// R_ClipSpan_IsRangeVisible
+//
+
+static dboolean R_ClipSpan_IsRangeVisible(angle_t startAngle, angle_t endAngle) {
+    int i = R_ClipSpan_Find(startAngle);
+
+    // spans are disjoint, so only the first span that reaches
+    // startAngle can possibly cover the whole range
+    if(i < numclipspans && clipspans[i].start <= startAngle &&
+            clipspans[i].end >= endAngle) {
+        return false;
+    }
+
+    return true;
+}
+
+//
+// R_ClipSpan_AddClipRange
+//
+
+static void R_ClipSpan_AddClipRange(angle_t start, angle_t end) {
+    int first;
+    int last;
+
+    first = R_ClipSpan_Find(start);
+
+    // find the spans that overlap the new range and fold them into it
+    last = first;
+    while(last < numclipspans && clipspans[last].start <= end) {
+        if(clipspans[last].start < start) {
+            start = clipspans[last].start;
+        }
+
+        if(clipspans[last].end > end) {
+            end = clipspans[last].end;
+        }
+
+        last++;
+    }
+
+    if(last == first) {
+        // nothing to merge with, insert a new span
+        if(numclipspans == maxclipspans) {
+            maxclipspans = maxclipspans ? maxclipspans * 2 : 64;
+            clipspans = (clipspan_t*)Z_Realloc(clipspans,
+                                               maxclipspans * sizeof(clipspan_t), PU_STATIC, NULL);
+        }
+
+        if(first < numclipspans) {
+            memmove(&clipspans[first + 1], &clipspans[first],
+                     (numclipspans - first) * sizeof(clipspan_t));
+        }
+
+        numclipspans++;
+    }
+    else if(last - first > 1) {
+        // collapse the merged spans into the first one
+        if(last < numclipspans) {
+            memmove(&clipspans[first + 1], &clipspans[last],
+                     (numclipspans - last) * sizeof(clipspan_t));
+        }
+
+        numclipspans -= (last - first - 1);
+    }
+
+    clipspans[first].start = start;
+    clipspans[first].end = end;
+}
+
 //
 // R_Clipper_Clear
 //
@@ -234,6 +411,10 @@ void R_Clipper_Clear(void) {
     clipnode_t *node = cliphead;
     clipnode_t *temp;
 
+    // only switch implementations between frames
+    clipmode = *r_clipper;
+    numclipspans = 0;
+
     while(node != NULL) {
         temp = node;
         node = node->next;
@@ -282,8 +463,6 @@ viewMatrix[e] * projMatrix[f] + \
 viewMatrix[g] * projMatrix[h])
 
 void R_FrustrumSetup(void) {
-    float clip[16];
-
     dglGetDoublev(GL_PROJECTION_MATRIX, projMatrix);
     dglGetDoublev(GL_MODELVIEW_MATRIX, viewMatrix);
 
@@ -342,6 +521,153 @@ void R_FrustrumSetup(void) {
     frustum[5][1] = clip[ 7] + clip[ 6];
     frustum[5][2] = clip[11] + clip[10];
     frustum[5][3] = clip[15] + clip[14];
+
+    for(int p = 0; p < FRUSTUMPLANES; p++) {
+        for(int i = 0; i < 4; i++) {
+            if(p < 6) {
+                frustumsoa[i][p] = frustum[p][i];
+            }
+            else {
+                frustumsoa[i][p] = (i == 3) ? 1.0f : 0.0f;
+            }
+        }
+    }
+}
+
+//
+// R_InitNodeBounds
+// Called at level setup, after the nodes are loaded
+//
+
+void R_InitNodeBounds(void) {
+    float *boxes;
+    int i;
+    int j;
+
+    boxes = (float*)Z_Malloc(numnodes * 2 * 4 * sizeof(float), PU_LEVEL, NULL);
+
+    for(i = 0; i < 4; i++) {
+        nodeboxes[i] = boxes + (numnodes * 2 * i);
+    }
+
+    spritepad = 0;
+
+    for(i = 0; i < numsprtex; i++) {
+        spritepad = MAX(spritepad, spritewidth[i] + fabsf(spriteoffset[i]));
+    }
+
+    for(i = 0; i < numnodes; i++) {
+        for(j = 0; j < 2; j++) {
+            fixed_t *bbox = nodes[i].bbox[j];
+
+            nodeboxes[BOXTOP][i * 2 + j] = F2D3D(bbox[BOXTOP]) + spritepad;
+            nodeboxes[BOXBOTTOM][i * 2 + j] = F2D3D(bbox[BOXBOTTOM]) - spritepad;
+            nodeboxes[BOXLEFT][i * 2 + j] = F2D3D(bbox[BOXLEFT]) - spritepad;
+            nodeboxes[BOXRIGHT][i * 2 + j] = F2D3D(bbox[BOXRIGHT]) + spritepad;
+        }
+    }
+}
+
+//
+// R_SetNodeClipping
+// Takes the same angle as the clipper's view range
+//
+
+void R_SetNodeClipping(angle_t angle) {
+    angle_t half = angle - ANG180;
+    angle_t left;
+    angle_t right;
+    float x;
+    float y;
+
+    // nothing to gain once the view is 180 degrees or wider
+    nodeclip = (half > 0 && half < ANG90);
+
+    if(!nodeclip) {
+        return;
+    }
+
+    left = viewangle + half;
+    right = viewangle - half;
+    x = F2D3D(viewx);
+    y = F2D3D(viewy);
+
+    nodeplanes[0][0] = F2D3D(dsin(left));
+    nodeplanes[0][1] = -F2D3D(dcos(left));
+    nodeplanes[1][0] = -F2D3D(dsin(right));
+    nodeplanes[1][1] = F2D3D(dcos(right));
+
+    nodeplanes[0][2] = -(nodeplanes[0][0] * x + nodeplanes[0][1] * y);
+    nodeplanes[1][2] = -(nodeplanes[1][0] * x + nodeplanes[1][1] * y);
+}
+
+//
+// R_FrustrumTestNode
+// Returns a bit for each child of the node that is in view
+//
+
+int R_FrustrumTestNode(int node) {
+    int n = node * 2;
+
+    if(!nodeclip) {
+        return 3;
+    }
+
+#ifdef USE_SSE_FRUSTUM
+    {
+        // both planes against both children at once
+        __m128 a = _mm_set_ps(nodeplanes[1][0], nodeplanes[0][0], nodeplanes[1][0], nodeplanes[0][0]);
+        __m128 b = _mm_set_ps(nodeplanes[1][1], nodeplanes[0][1], nodeplanes[1][1], nodeplanes[0][1]);
+        __m128 d = _mm_set_ps(nodeplanes[1][2], nodeplanes[0][2], nodeplanes[1][2], nodeplanes[0][2]);
+        __m128 x1 = _mm_set_ps(nodeboxes[BOXLEFT][n + 1], nodeboxes[BOXLEFT][n + 1],
+                               nodeboxes[BOXLEFT][n], nodeboxes[BOXLEFT][n]);
+        __m128 x2 = _mm_set_ps(nodeboxes[BOXRIGHT][n + 1], nodeboxes[BOXRIGHT][n + 1],
+                               nodeboxes[BOXRIGHT][n], nodeboxes[BOXRIGHT][n]);
+        __m128 y1 = _mm_set_ps(nodeboxes[BOXBOTTOM][n + 1], nodeboxes[BOXBOTTOM][n + 1],
+                               nodeboxes[BOXBOTTOM][n], nodeboxes[BOXBOTTOM][n]);
+        __m128 y2 = _mm_set_ps(nodeboxes[BOXTOP][n + 1], nodeboxes[BOXTOP][n + 1],
+                               nodeboxes[BOXTOP][n], nodeboxes[BOXTOP][n]);
+        __m128 dist;
+        int out;
+
+        // distance of the corner furthest in front of each plane
+        dist = _mm_add_ps(_mm_max_ps(_mm_mul_ps(a, x1), _mm_mul_ps(a, x2)),
+                          _mm_max_ps(_mm_mul_ps(b, y1), _mm_mul_ps(b, y2)));
+        dist = _mm_add_ps(dist, d);
+
+        out = _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_setzero_ps()));
+
+        return ((out & 3) ? 0 : 1) | ((out & 12) ? 0 : 2);
+    }
+#else
+    {
+        int bits = 0;
+        int i;
+        int p;
+
+        for(i = 0; i < 2; i++) {
+            for(p = 0; p < 2; p++) {
+                float dist;
+
+                dist = MAX(nodeplanes[p][0] * nodeboxes[BOXLEFT][n + i],
+                           nodeplanes[p][0] * nodeboxes[BOXRIGHT][n + i]) +
+                       MAX(nodeplanes[p][1] * nodeboxes[BOXBOTTOM][n + i],
+                           nodeplanes[p][1] * nodeboxes[BOXTOP][n + i]) +
+                       nodeplanes[p][2];
+
+                if(dist < 0) {
+                    break;
+                }
+            }
+
+            if(p == 2) {
+                bits |= (1 << i);
+            }
+        }
+
+        return bits;
+    }
+#endif
 }
 
 //
@@ -350,6 +676,40 @@ void R_FrustrumSetup(void) {
 //
 
 dboolean R_FrustrumTestVertex(vtx_t* vertex, int count) {
+#ifdef USE_SSE_FRUSTUM
+    __m128 zero = _mm_setzero_ps();
+    int front = 0;
+    int p;
+    int i;
+
+    //
+    // same sums as below in the same order, four planes at
+    // a time. front has a bit for each plane that some
+    // vertex is in front of
+    //
+    for(i = 0; i < count; i++) {
+        __m128 x = _mm_set1_ps(vertex[i].x);
+        __m128 y = _mm_set1_ps(vertex[i].y);
+        __m128 z = _mm_set1_ps(vertex[i].z);
+
+        for(p = 0; p < FRUSTUMPLANES; p += 4) {
+            __m128 dist;
+
+            dist = _mm_add_ps(_mm_mul_ps(_mm_load_ps(&frustumsoa[0][p]), x),
+                              _mm_mul_ps(_mm_load_ps(&frustumsoa[1][p]), y));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_load_ps(&frustumsoa[2][p]), z));
+            dist = _mm_add_ps(dist, _mm_load_ps(&frustumsoa[3][p]));
+
+            front |= _mm_movemask_ps(_mm_cmpgt_ps(dist, zero)) << p;
+        }
+
+        if(front == (1 << FRUSTUMPLANES) - 1) {
+            return true;
+        }
+    }
+
+    return false;
+#else
     int p;
     int i;
 
@@ -370,5 +730,45 @@ dboolean R_FrustrumTestVertex(vtx_t* vertex, int count) {
         return false;
     }
 
+    return true;
+#endif
+}
+
+//
+// R_ProjectVertexBox
+// Computes the screen-space (normalized device) bounds of a polygon.
+// Returns false if part of the polygon is behind the view, in which
+// case the bounds are set to cover the entire screen
+//
+
+dboolean R_ProjectVertexBox(vtx_t* vertex, int count, float* box) {
+    int i;
+
+    box[0] = box[2] = 1.0f;
+    box[1] = box[3] = -1.0f;
+
+    for(i = 0; i < count; i++) {
+        float x = vertex[i].x;
+        float y = vertex[i].y;
+        float z = vertex[i].z;
+        float w = x * clip[3] + y * clip[7] + z * clip[11] + clip[15];
+        float sx;
+        float sy;
+
+        if(w <= 0.0f) {
+            box[0] = box[2] = -1.0f;
+            box[1] = box[3] = 1.0f;
+            return false;
+        }
+
+        sx = (x * clip[0] + y * clip[4] + z * clip[8] + clip[12]) / w;
+        sy = (x * clip[1] + y * clip[5] + z * clip[9] + clip[13]) / w;
+
+        box[0] = MIN(box[0], sx);
+        box[1] = MAX(box[1], sx);
+        box[2] = MIN(box[2], sy);
+        box[3] = MAX(box[3], sy);
+    }
+
     return true;
 }
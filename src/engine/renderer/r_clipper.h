@@ -24,6 +24,15 @@
 #ifndef R_CLIPPER_H
 #define R_CLIPPER_H
 
+typedef enum {
+    CLIPPER_LIST,
+    CLIPPER_ARRAY,
+    NUMCLIPPERS
+} clippertype_e;
+
+extern cvar::IntVar r_clipper;
+extern cvar::BoolVar r_cullnodes;
+
 dboolean    R_Clipper_SafeCheckRange(angle_t startAngle, angle_t endAngle);
 void        R_Clipper_SafeAddClipRange(angle_t startangle, angle_t endangle);
 void        R_Clipper_Clear(void);
@@ -33,5 +42,9 @@ extern float frustum[6][4];
 angle_t     R_FrustumAngle(void);
 void        R_FrustrumSetup(void);
 dboolean    R_FrustrumTestVertex(vtx_t* vertex, int count);
+void        R_InitNodeBounds(void);
+void        R_SetNodeClipping(angle_t angle);
+int         R_FrustrumTestNode(int node);
+dboolean    R_ProjectVertexBox(vtx_t* vertex, int count, float* box);
 
 #endif
\ No newline at end of file
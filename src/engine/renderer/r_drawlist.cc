@@ -32,14 +32,18 @@
 #include "gl_texture.h"
 #include "gl_main.h"
 #include "r_drawlist.h"
+#include "r_clipper.h"
 #include "i_system.h"
 #include "z_zone.h"
+#include "m_profile.h"
 
 static float envcolor[4] = { 0, 0, 0, 0 };
 
 drawlist_t drawlist[NUMDRAWLISTS];
 vtx_t drawVertex[MAXDLDRAWCOUNT];
 
+unsigned int spriteDrawCalls = 0;
+
 extern cvar::BoolVar r_texturecombiner;
 
 //
@@ -98,6 +102,13 @@ static int SortSprites(const void *a, const void *b) {
 // DL_ProcessDrawList
 //
 
+static const char *drawlistzones[NUMDRAWLISTS] = {
+    "DL_ProcessDrawList WALL",
+    "DL_ProcessDrawList FLAT",
+    "DL_ProcessDrawList SPRITE",
+    "DL_ProcessDrawList AMAP"
+};
+
 void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*)) {
     drawlist_t* dl;
     int i;
@@ -110,6 +121,8 @@ void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*)) {
         return;
     }
 
+    PROFILE_ZONE(drawlistzones[tag]);
+
     dl = &drawlist[tag];
 
     if(dl->max > 0) {
@@ -124,6 +137,10 @@ void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*)) {
 
         tail = &dl->list[dl->index];
 
+        // each texture run is collected in the growable batch
+        // buffer, so there's no limit on how big a run can get
+        dglBeginBatch();
+
         for(i = 0; i < dl->index; i++) {
             vtxlist_t* rover;
 
@@ -134,10 +151,6 @@ void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*)) {
                 break;
             }
 
-            if(drawcount >= MAXDLDRAWCOUNT) {
-                I_Error("DL_ProcessDrawList: Draw overflow by %i, tag=%i", dl->index, tag);
-            }
-
             if(procfunc) {
                 if(!procfunc(head, &drawcount)) {
                     continue;
@@ -198,7 +211,7 @@ void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*)) {
                 GL_UpdateEnvTexture(D_RGBA(l, l, l, 0xff));
             }
 
-            dglDrawGeometry(drawcount, drawVertex);
+            dglEndBatch();
 
             // count vertex size
             if(devparm) {
@@ -211,6 +224,245 @@ void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*)) {
     }
 }
 
+//
+// SPRITE BATCHING
+//
+// Sprite geometry is generated up front so that sprites sharing the same
+// texture, palette and blend state can be submitted in a single draw.
+// Sprites are drawn back to front without depth writes, since their
+// filtered edges are blended; a sprite may only be pulled forward into
+// an earlier batch if it doesn't overlap, on screen, any sprite it would
+// be jumping ahead of.
+//
+
+#define SPRBATCH_LOOKAHEAD  32
+
+typedef struct {
+    vtxlist_t   *list;
+    vtx_t       *vtx;
+    float       box[4];
+    dboolean    done;
+} sprbatch_t;
+
+static sprbatch_t   *sprbatch = NULL;
+static vtx_t        *sprvertex = NULL;
+static int          maxsprbatch = 0;
+
+//
+// SpriteFlags
+//
+
+static int SpriteFlags(const sprbatch_t *sb) {
+    return ((visspritelist_t*)sb->list->data)->spr->flags;
+}
+
+//
+// SpriteBatchMatch
+// Sprites can share a draw if they need the exact same state
+//
+
+static dboolean SpriteBatchMatch(const sprbatch_t *a, const sprbatch_t *b) {
+    const int mask = MF_NIGHTMARE | MF_RENDERLASER;
+
+    return (a->list->texid == b->list->texid &&
+            a->list->params == b->list->params &&
+            (SpriteFlags(a) & mask) == (SpriteFlags(b) & mask));
+}
+
+//
+// BoxOverlap
+//
+
+static dboolean BoxOverlap(const float *a, const float *b) {
+    return !(a[1] < b[0] || b[1] < a[0] || a[3] < b[2] || b[3] < a[2]);
+}
+
+//
+// BeginSpriteBatch
+// Sets up the texture and blend state for a run of sprites
+//
+
+static void BeginSpriteBatch(const sprbatch_t *sb, dboolean *nightmare) {
+    vtxlist_t *head = sb->list;
+    int flags = SpriteFlags(sb);
+
+    // textid in sprites contains hack that stores palette index data
+    GL_BindSpriteTexture(head->texid & 0xffff, head->texid >> 24);
+    GL_SetState(GLSTATE_CULL, !(flags & MF_RENDERLASER));
+
+    // villsa 12152013 - change blend states for nightmare things
+    if(*nightmare != !!(flags & MF_NIGHTMARE)) {
+        *nightmare ^= 1;
+
+        if(*nightmare) {
+            dglBlendFunc(GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
+        }
+        else {
+            dglBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+    }
+
+    if(r_texturecombiner) {
+        envcolor[0] = envcolor[1] = envcolor[2] = ((float)head->params / 255.0f);
+        GL_SetEnvColor(envcolor);
+    }
+    else {
+        int l = (head->params >> 1);
+
+        GL_UpdateEnvTexture(D_RGBA(l, l, l, 0xff));
+    }
+}
+
+//
+// FlushSpriteBatch
+//
+
+static void FlushSpriteBatch(int *drawcount) {
+    if(!*drawcount) {
+        return;
+    }
+
+    dglDrawGeometry(*drawcount, drawVertex);
+
+    if(devparm) {
+        vertCount += *drawcount;
+        spriteDrawCalls++;
+    }
+
+    *drawcount = 0;
+}
+
+//
+// AddSpriteToBatch
+//
+
+static void AddSpriteToBatch(sprbatch_t *sb, int *drawcount) {
+    int count;
+
+    if(*drawcount + 4 > MAXDLDRAWCOUNT) {
+        FlushSpriteBatch(drawcount);
+    }
+
+    count = *drawcount;
+
+    dmemcpy(&drawVertex[count], sb->vtx, sizeof(vtx_t) * 4);
+
+    dglTriangle(count + 0, count + 1, count + 2);
+    dglTriangle(count + 3, count + 2, count + 1);
+
+    *drawcount += 4;
+    sb->done = true;
+}
+
+//
+// DL_ProcessSpriteList
+//
+
+void DL_ProcessSpriteList(void) {
+    PROFILE_ZONE("DL_ProcessSpriteList");
+    drawlist_t *dl = &drawlist[DLT_SPRITE];
+    int numsprites = 0;
+    int drawcount = 0;
+    dboolean nightmare = false;
+    int i;
+    int j;
+
+    if(dl->max <= 0 || dl->index <= 0) {
+        return;
+    }
+
+    if(dl->index >= 2) {
+        qsort(dl->list, dl->index, sizeof(vtxlist_t), SortSprites);
+    }
+
+    // walls and flats leave the batch buffer bound
+    dglSetVertex(drawVertex);
+
+    if(dl->index > maxsprbatch) {
+        maxsprbatch = dl->index;
+        sprbatch = (sprbatch_t*)Z_Realloc(sprbatch, maxsprbatch * sizeof(sprbatch_t), PU_STATIC, NULL);
+        sprvertex = (vtx_t*)Z_Realloc(sprvertex, maxsprbatch * 4 * sizeof(vtx_t), PU_STATIC, NULL);
+    }
+
+    // generate geometry for every visible sprite
+    for(i = 0; i < dl->index; i++) {
+        vtxlist_t *head = &dl->list[i];
+        sprbatch_t *sb = &sprbatch[numsprites];
+        mobj_t *mobj;
+
+        if(!head->data) {
+            break;
+        }
+
+        mobj = ((visspritelist_t*)head->data)->spr;
+
+        if(!mobj) {
+            continue;
+        }
+
+        sb->list = head;
+        sb->vtx = &sprvertex[numsprites * 4];
+        sb->done = false;
+
+        if(!head->callback(head->data, sb->vtx)) {
+            continue;
+        }
+
+        R_ProjectVertexBox(sb->vtx, 4, sb->box);
+        numsprites++;
+    }
+
+    // sprites keep their back to front order
+    for(i = 0; i < numsprites; i++) {
+        sprbatch_t *sb = &sprbatch[i];
+        float *skipped[SPRBATCH_LOOKAHEAD];
+        int numskipped = 0;
+
+        if(sb->done) {
+            continue;
+        }
+
+        BeginSpriteBatch(sb, &nightmare);
+        AddSpriteToBatch(sb, &drawcount);
+
+        for(j = i + 1; j < numsprites && j <= i + SPRBATCH_LOOKAHEAD; j++) {
+            sprbatch_t *next = &sprbatch[j];
+            dboolean blocked = false;
+            int k;
+
+            if(next->done) {
+                continue;
+            }
+
+            if(SpriteBatchMatch(sb, next)) {
+                for(k = 0; k < numskipped; k++) {
+                    if(BoxOverlap(skipped[k], next->box)) {
+                        blocked = true;
+                        break;
+                    }
+                }
+
+                if(!blocked) {
+                    AddSpriteToBatch(next, &drawcount);
+                    continue;
+                }
+            }
+
+            skipped[numskipped++] = next->box;
+        }
+
+        FlushSpriteBatch(&drawcount);
+    }
+
+    for(i = 0; i < dl->index; i++) {
+        dl->list[i].data = NULL;
+    }
+
+    if(nightmare) {
+        dglBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+}
+
 //
 // DL_GetDrawListSize
 //
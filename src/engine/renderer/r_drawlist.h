@@ -64,6 +64,8 @@ extern drawlist_t drawlist[NUMDRAWLISTS];
 #define MAXDLDRAWCOUNT  0x10000
 extern vtx_t drawVertex[MAXDLDRAWCOUNT];
 
+extern unsigned int spriteDrawCalls;
+
 dboolean DL_ProcessWalls(vtxlist_t* vl, int* drawcount);
 dboolean DL_ProcessLeafs(vtxlist_t* vl, int* drawcount);
 dboolean DL_ProcessSprites(vtxlist_t* vl, int* drawcount);
@@ -72,6 +74,7 @@ vtxlist_t *DL_AddVertexList(drawlist_t *dl);
 int DL_GetDrawListSize(int tag);
 void DL_BeginDrawList(dboolean t, dboolean a);
 void DL_ProcessDrawList(int tag, dboolean(*procfunc)(vtxlist_t*, int*));
+void DL_ProcessSpriteList(void);
 void DL_RenderDrawList(void);
 void DL_Init(void);
 
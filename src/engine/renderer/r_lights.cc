@@ -32,9 +32,39 @@
 #include "r_local.h"
 #include "d_keywds.h"
 #include "p_local.h"
+#include "z_zone.h"
 
 rcolor    bspColor[5];
 
+//
+// Wall colors are cached per seg for each of the four ways
+// R_SetSegLineColor can be asked for them. A sector's stamp
+// changes whenever its heights or wall lights differ from the
+// last time it was checked, and a seg's colors are only valid
+// as long as the stamps of both of its sectors are unchanged.
+//
+
+typedef struct {
+    fixed_t     floorheight;
+    fixed_t     ceilingheight;
+    rcolor      colors[3];
+    int         stamp;
+    int         checkframe;
+} sectorlight_t;
+
+typedef struct {
+    int         frontstamp;
+    int         backstamp;
+    int         lineflags;  // blend flags can be changed by macros
+    byte        valid;
+    rcolor      colors[4][4];
+} seglight_t;
+
+static sectorlight_t    *sectorlights = NULL;
+static seglight_t       *seglights = NULL;
+static int              lightstamp = 0;
+static int              lightframe = 0;
+
 extern cvar::FloatVar i_brightness;
 extern cvar::BoolVar r_texturecombiner;
 
@@ -300,12 +330,11 @@ rcolor R_SplitLineColor(seg_t *line, byte side) {
 }
 
 //
-// R_SetSegLineColor
+// R_GetSegLineColor
 //
 
-void R_SetSegLineColor(seg_t *line, vtx_t* v, byte side) {
+static void R_GetSegLineColor(seg_t *line, rcolor *c, byte side) {
     int i;
-    rcolor c[4];
     byte lwr = LIGHT_LWRWALL;
     byte upr = LIGHT_UPRWALL;
 
@@ -367,9 +396,96 @@ void R_SetSegLineColor(seg_t *line, vtx_t* v, byte side) {
             c[i] = bspColor[LIGHT_THING];
         }
     }
+}
+
+//
+// R_InitSegLights
+// Called when a level is set up
+//
+
+void R_InitSegLights(void) {
+    sectorlights = (sectorlight_t*)Z_Calloc(numsectors * sizeof(sectorlight_t), PU_LEVEL, NULL);
+    seglights = (seglight_t*)Z_Calloc(numsegs * sizeof(seglight_t), PU_LEVEL, NULL);
+    lightframe = 0;
+}
+
+//
+// R_NextSegLightFrame
+// Sectors are checked for changes again after this,
+// once per frame and only if one of their segs is drawn
+//
+
+void R_NextSegLightFrame(void) {
+    lightframe++;
+}
+
+//
+// R_SectorLightStamp
+//
+
+static int R_SectorLightStamp(sector_t *sector) {
+    sectorlight_t *sl = &sectorlights[sector - sectors];
+    rcolor thing;
+    rcolor upper;
+    rcolor lower;
+
+    if(sl->checkframe == lightframe) {
+        return sl->stamp;
+    }
+
+    sl->checkframe = lightframe;
+
+    thing = R_GetSectorLight(0xff, sector->colors[LIGHT_THING]);
+    upper = R_GetSectorLight(0xff, sector->colors[LIGHT_UPRWALL]);
+    lower = R_GetSectorLight(0xff, sector->colors[LIGHT_LWRWALL]);
+
+    if(sl->floorheight != sector->floorheight ||
+            sl->ceilingheight != sector->ceilingheight ||
+            sl->colors[0] != thing || sl->colors[1] != upper || sl->colors[2] != lower) {
+        sl->floorheight = sector->floorheight;
+        sl->ceilingheight = sector->ceilingheight;
+        sl->colors[0] = thing;
+        sl->colors[1] = upper;
+        sl->colors[2] = lower;
+        sl->stamp = ++lightstamp;
+    }
+
+    return sl->stamp;
+}
+
+//
+// R_SetSegLineColor
+//
+
+void R_SetSegLineColor(seg_t *line, vtx_t* v, byte side) {
+    seglight_t *sl = &seglights[line - segs];
+    sector_t *sec = line->frontsector;
+    int frontstamp;
+    int backstamp;
+    int i;
+
+    frontstamp = R_SectorLightStamp(sec);
+    backstamp = line->backsector ? R_SectorLightStamp(line->backsector) : -1;
+
+    if(sl->frontstamp != frontstamp || sl->backstamp != backstamp ||
+            sl->lineflags != line->linedef->flags) {
+        sl->frontstamp = frontstamp;
+        sl->backstamp = backstamp;
+        sl->lineflags = line->linedef->flags;
+        sl->valid = 0;
+    }
+
+    if(!(sl->valid & (1 << side))) {
+        bspColor[LIGHT_THING]   = R_GetSectorLight(0xff, sec->colors[LIGHT_THING]);
+        bspColor[LIGHT_UPRWALL] = R_GetSectorLight(0xff, sec->colors[LIGHT_UPRWALL]);
+        bspColor[LIGHT_LWRWALL] = R_GetSectorLight(0xff, sec->colors[LIGHT_LWRWALL]);
+
+        R_GetSegLineColor(line, sl->colors[side], side);
+        sl->valid |= (1 << side);
+    }
 
     for(i = 0; i < 4; i++) {
-        *(rcolor*)&v[i].r = c[i];
+        *(rcolor*)&v[i].r = sl->colors[side][i];
     }
 }
 
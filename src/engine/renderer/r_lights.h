@@ -40,6 +40,8 @@ rcolor R_GetSectorLight(byte alpha, word ptr);
 void R_SetLightFactor(float lightfactor);
 void R_RefreshBrightness(void);
 void R_LightToVertex(vtx_t *v, int idx, word c);
+void R_InitSegLights(void);
+void R_NextSegLightFrame(void);
 void R_SetSegLineColor(seg_t *line, vtx_t* v, byte side);
 
 #endif
\ No newline at end of file
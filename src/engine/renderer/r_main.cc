@@ -35,7 +35,9 @@
 #include "r_local.h"
 #include "r_sky.h"
 #include "r_clipper.h"
+#include "r_occlusion.h"
 #include "gl_texture.h"
+#include "gl_texstream.h"
 #include "gl_main.h"
 #include "m_fixed.h"
 #include "tables.h"
@@ -48,6 +50,10 @@
 #include "r_drawlist.h"
 #include "gl_draw.h"
 #include "g_actions.h"
+#include "r_bench.h"
+#include "m_profile.h"
+#include "gl_gputimer.h"
+#include "gl_renderscale.h"
 
 int             skytexture;
 
@@ -97,6 +103,16 @@ cvar::BoolVar r_filter          = false;
 cvar::BoolVar r_texnonpowresize = false;
 cvar::BoolVar r_anisotropic     = false;
 cvar::BoolVar r_texturecombiner = false;
+cvar::BoolVar r_texstream       = true;
+cvar::FloatVar r_texstreambudget = 2.0f;
+cvar::IntVar r_texturebudget    = 512;
+cvar::IntVar r_gputimers        = 0;
+cvar::FloatVar r_renderscale    = 1.0f;
+cvar::BoolVar r_dynamicres      = false;
+cvar::FloatVar r_frametarget    = 16.7f;
+cvar::FloatVar r_renderscalemin = 0.5f;
+cvar::BoolVar r_renderscalefilter = true;
+cvar::BoolVar r_pvs             = true;
 
 extern cvar::BoolVar i_interpolateframes;
 extern cvar::BoolVar p_usecontext;
@@ -292,7 +308,20 @@ void R_Init(void) {
         (r_filter,          "r_Filter",          "TODO")
         (r_texnonpowresize, "r_TexNonPowResize", "Resize non-power-of-2 textures")
         (r_anisotropic,     "r_Anisotropic",     "Anisotropic filtering")
-        (r_texturecombiner, "r_TextureCombiner", "TODO");
+        (r_texturecombiner, "r_TextureCombiner", "TODO")
+        (r_texstream,       "r_TexStream",       "Decode textures in the background (0 = load synchronously)")
+        (r_texstreambudget, "r_TexStreamBudget", "Time in ms spent uploading streamed textures per frame")
+        (r_texturebudget,   "r_TextureBudget",   "Texture memory budget in MB before unused textures are evicted (0 = unlimited)")
+        (r_gputimers,       "r_GPUTimers",       "GPU time per render pass (1 = show in devstats, 2 = also log every frame)")
+        (r_renderscale,     "r_RenderScale",     "Fraction of the screen resolution the 3D view is drawn at")
+        (r_dynamicres,      "r_DynamicRes",      "Lower the 3D view resolution to hold r_FrameTarget")
+        (r_frametarget,     "r_FrameTarget",     "Frame time in ms r_DynamicRes aims for")
+        (r_renderscalemin,  "r_RenderScaleMin",  "Lowest scale r_DynamicRes may drop to")
+        (r_renderscalefilter, "r_RenderScaleFilter", "Filter the scaled 3D view when stretching it (0 = nearest)")
+        (r_clipper,         "r_Clipper",         "Occlusion clipper (0 = linked list, 1 = sorted array)")
+        (r_cullnodes,       "r_CullNodes",       "Skip BSP nodes that are outside the view angle")
+        (r_pvs,             "r_PVS",             "Skip BSP nodes that the potentially visible set can't see")
+        (r_occlusion,       "r_Occlusion",       "Skip sprites in subsectors that occlusion queries found hidden");
 
     r_colorscale.set_callback([](const int&) {
         GL_SetColorScale();
@@ -313,6 +342,12 @@ void R_Init(void) {
         GL_SetTextureFilter();
     });
 
+    r_texstream.set_callback([](const bool& value) {
+        if(!value) {
+            GL_FlushTextureStream();
+        }
+    });
+
     void R_TextureCombinerFunc(const bool&);
     r_texturecombiner.set_callback(R_TextureCombinerFunc);
 
@@ -320,6 +355,8 @@ void R_Init(void) {
     GL_ResetTextures();
 
     G_AddCommand("wireframe", CMD_Wireframe, 0);
+
+    R_InitBench();
 }
 
 //
@@ -368,7 +405,11 @@ void R_SetViewOffset(int offset) {
 //
 
 void R_SetupLevel(void) {
+    R_BenchStopRecording();
     R_AllocSubsectorBuffer();
+    R_InitNodeBounds();
+    R_InitOcclusion();
+    R_InitSegLights();
     R_RefreshBrightness();
 
     DL_Init();
@@ -376,122 +417,6 @@ void R_SetupLevel(void) {
     bRenderSky = true;
 }
 
-//
-// R_PrecacheLevel
-// Loads and binds all world textures before level startup
-//
-
-void R_PrecacheLevel(void) {
-    char *texturepresent;
-    char *spritepresent;
-    int    i;
-    int j;
-    int    p;
-    int num;
-    mobj_t* mo;
-
-    CON_DPrintf("--------R_PrecacheLevel--------\n");
-    //GL_DumpTextures();
-
-    texturepresent = (char*)Z_Alloca(numtextures);
-    spritepresent = (char*)Z_Alloca(NUMSPRITES);
-
-    for(i = 0; i < numsides; i++) {
-        texturepresent[sides[i].toptexture] = 1;
-        texturepresent[sides[i].midtexture] = 1;
-        texturepresent[sides[i].bottomtexture] = 1;
-    }
-
-    for(i = 0; i < numsectors; i++) {
-        texturepresent[sectors[i].ceilingpic] = 1;
-        texturepresent[sectors[i].floorpic] = 1;
-
-        if(sectors[i].flags & MS_LIQUIDFLOOR) {
-            texturepresent[sectors[i].floorpic + 1] = 1;
-        }
-    }
-
-    num = 0;
-
-    for(i = 0; i < numtextures; i++) {
-        if(texturepresent[i]) {
-            GL_BindWorldTexture(i, 0, 0);
-            num++;
-
-            for(p = 0; p < numanimdef; p++) {
-                auto l = wad::open(wad::Section::textures, animdefs[p].name).value();
-                int lump = l.section_index();
-
-                if(lump != i) {
-                    continue;
-                }
-
-                //
-                // TODO - add support for precaching palettes
-                //
-                if(!animdefs[p].palette) {
-                    for(j = 1; j < animdefs[p].frames; j++) {
-                        GL_BindWorldTexture(i + j, 0, 0);
-                        num++;
-                    }
-                }
-            }
-        }
-    }
-
-    CON_DPrintf("%i world textures cached\n", num);
-
-    for(mo = mobjhead.next; mo != &mobjhead; mo = mo->next) {
-        spritepresent[mo->sprite] = 1;
-    }
-
-    num = 0;
-
-    //
-    // TODO - add support for precaching palettes
-    //
-    for(i = 0; i < NUMSPRITES; i++) {
-        if(spritepresent[i]) {
-            spritedef_t    *sprdef;
-            int k;
-
-            sprdef = &spriteinfo[i];
-
-            for(k = 0; k < sprdef->numframes; k++) {
-                spriteframe_t *sprframe;
-                int p;
-
-                sprframe = &sprdef->spriteframes[k];
-                if(sprframe->rotate) {
-                    for(p = 0; p < 8; p++) {
-                        GL_BindSpriteTexture(sprframe->lump[p], 0);
-                        num++;
-                    }
-                }
-                else {
-                    GL_BindSpriteTexture(sprframe->lump[0], 0);
-                    num++;
-                }
-            }
-        }
-    }
-
-    CON_DPrintf("%i sprites cached\n", num);
-
-    if(GLAD_GL_ARB_multitexture) {
-        GL_SetTextureUnit(1, true);
-        GL_BindEnvTexture();
-
-        GL_SetTextureUnit(2, true);
-        GL_BindDummyTexture();
-
-        GL_SetTextureUnit(3, true);
-        GL_BindDummyTexture();
-    }
-
-    GL_SetDefaultCombiner();
-}
-
 //
 // R_SetupFrame
 //
@@ -544,6 +469,9 @@ void R_SetupFrame(player_t *player) {
     viewcos[0]  = F2D3D(dcos(viewangle));
     viewcos[1]  = F2D3D(dcos(viewpitch - ANG90));
 
+    R_BenchRecordFrame();
+    R_NextSegLightFrame();
+
     D_IncValidCount();
 }
 
@@ -551,10 +479,12 @@ void R_SetupFrame(player_t *player) {
 // R_SetViewClipping
 //
 
-static void R_SetViewClipping(angle_t angle) {
+void R_SetViewClipping(angle_t angle) {
     R_Clipper_Clear();
     R_Clipper_SafeAddClipRange(viewangle + angle, viewangle - angle);
+    R_SetNodeClipping(angle);
     R_FrustrumSetup();
+    R_SetupPVS();
 }
 
 //
@@ -830,6 +760,10 @@ static void R_DrawContextWall(line_t* line) {
 //
 
 void R_RenderPlayerView(player_t *player) {
+    PROFILE_ZONE("R_RenderPlayerView");
+
+    GL_BeginRenderScale();
+
     if(!r_fillmode) {
         dglPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     }
@@ -842,6 +776,7 @@ void R_RenderPlayerView(player_t *player) {
     // clear sprite list
     //
     R_ClearSprites();
+    R_SetupOcclusion();
 
     //
     // setup draw frame
@@ -861,7 +796,9 @@ void R_RenderPlayerView(player_t *player) {
     // draw sky
     //
     if(bRenderSky) {
+        GL_BeginGPUPass(GPU_SKY);
         R_DrawSky();
+        GL_EndGPUPass();
     }
 
     bRenderSky = false;
@@ -891,7 +828,10 @@ void R_RenderPlayerView(player_t *player) {
     //
     // traverse BSP for rendering
     //
-    R_RenderBSPNode(numnodes-1);
+    {
+        PROFILE_ZONE("R_RenderBSPNode");
+        R_RenderBSPNode(numnodes-1);
+    }
 
     //
     // check for new console commands
@@ -924,9 +864,16 @@ void R_RenderPlayerView(player_t *player) {
     //
     if(ShowGun && player->cameratarget == player->mo &&
             !(player->cheats & CF_SPECTATOR)) {
+        GL_BeginGPUPass(GPU_SPRITES);
         R_RenderPlayerSprites(player);
+        GL_EndGPUPass();
     }
 
+    //
+    // stretch scaled view back over the screen
+    //
+    GL_EndRenderScale();
+
     if(devparm) {
         spriteRenderTic = (I_GetTimeMS() - spriteRenderTic);
     }
@@ -79,6 +79,8 @@ void R_DrawWireframe(dboolean enable);    //villsa
 void R_SetViewMatrix(void);
 void R_RenderWorld(void);
 void R_RenderBSPNode(int bspnum);
+void R_SetupPVS(void);
+void R_SetViewClipping(angle_t angle);
 void R_AllocSubsectorBuffer(void);
 
 #endif
@@ -0,0 +1,385 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Occlusion queries for sprites.
+//    Once the walls and flats are drawn, a box around each visited
+//    subsector that holds things is drawn into the depth buffer with
+//    a GL_SAMPLES_PASSED query. Results are only read once the GPU
+//    reports them available, so the sprites of a subsector are
+//    skipped based on a test from an earlier frame and the CPU never
+//    waits on the GPU. A subsector without a result counts as visible.
+//
+//-----------------------------------------------------------------------------
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "r_local.h"
+#include "r_occlusion.h"
+#include "gl_main.h"
+#include "gl_texture.h"
+#include "p_local.h"
+#include "z_zone.h"
+#include "con_console.h"
+#include "dgl.h"
+
+// frames an occluded result is trusted for without a newer one
+#define OCC_MAXAGE      4
+
+// distance from the box the view has to be for a query to be drawn
+#define OCC_VIEWPAD     4.0f
+
+cvar::BoolVar r_occlusion = false;
+
+extern cvar::IntVar r_rendersprites;
+
+typedef enum {
+    OCCLUSION_UNCHECKED,
+    OCCLUSION_READY,
+    OCCLUSION_UNSUPPORTED
+} occlusionstate_t;
+
+typedef struct {
+    GLuint      query;
+    int         issued;     // frame of the query still in flight, 0 if none
+    int         tested;     // frame the last result was issued in
+    int         listed;     // last frame this subsector was queued
+    dboolean    occluded;
+    float       box[6];     // min x/y/z, max x/y/z of the last query
+} occlusion_t;
+
+static occlusionstate_t occstate = OCCLUSION_UNCHECKED;
+static occlusion_t  *occlusion = NULL;
+static int          numocclusion = 0;
+static int          *occlist = NULL;
+static int          numocclist = 0;
+static int          occframe = 0;
+static dboolean     occactive = false;
+
+// corners are indexed by bit 0 = x, bit 1 = y, bit 2 = z
+static const byte occboxfaces[24] = {
+    0, 2, 6, 4,
+    1, 5, 7, 3,
+    0, 4, 5, 1,
+    2, 3, 7, 6,
+    0, 1, 3, 2,
+    4, 6, 7, 5
+};
+
+//
+// R_InitOcclusion
+// Called at level setup. Queries of the previous level are
+// deleted here since level memory is already gone by now.
+//
+
+void R_InitOcclusion(void) {
+    int i;
+
+    if(occlusion) {
+        if(usingGL && occstate == OCCLUSION_READY) {
+            for(i = 0; i < numocclusion; i++) {
+                if(occlusion[i].query) {
+                    dglDeleteQueriesARB(1, &occlusion[i].query);
+                }
+            }
+        }
+
+        Z_Free(occlusion);
+        Z_Free(occlist);
+    }
+
+    numocclusion = numsubsectors;
+    occlusion = (occlusion_t*)Z_Calloc(numocclusion * sizeof(occlusion_t), PU_STATIC, NULL);
+    occlist = (int*)Z_Malloc(numocclusion * sizeof(int), PU_STATIC, NULL);
+    numocclist = 0;
+    occactive = false;
+}
+
+//
+// R_OcclusionSupported
+//
+
+static dboolean R_OcclusionSupported(void) {
+    if(occstate == OCCLUSION_UNCHECKED) {
+        if(GLAD_GL_ARB_occlusion_query) {
+            occstate = OCCLUSION_READY;
+        }
+        else {
+            CON_Warnf("r_Occlusion: GL_ARB_occlusion_query isn't supported\n");
+            occstate = OCCLUSION_UNSUPPORTED;
+        }
+    }
+
+    return occstate == OCCLUSION_READY;
+}
+
+//
+// R_SetupOcclusion
+// Called at the start of every frame
+//
+
+void R_SetupOcclusion(void) {
+    occactive = r_occlusion && usingGL && occlusion && R_OcclusionSupported();
+    numocclist = 0;
+    occframe++;
+}
+
+//
+// R_OcclusionPointInBox
+//
+
+static dboolean R_OcclusionPointInBox(const float *box, float x, float y, float z, float pad) {
+    return x >= box[0] - pad && x <= box[3] + pad &&
+           y >= box[1] - pad && y <= box[4] + pad &&
+           z >= box[2] - pad && z <= box[5] + pad;
+}
+
+//
+// R_SubsectorOccluded
+// Called for each subsector as the BSP is traversed. Picks up the
+// result of the last query if it is ready and queues the subsector
+// to be tested again this frame.
+//
+
+dboolean R_SubsectorOccluded(subsector_t *sub) {
+    occlusion_t *occ;
+    mobj_t *thing;
+    dboolean inside;
+    GLuint result;
+    int count;
+
+    if(!occactive) {
+        return false;
+    }
+
+    occ = &occlusion[sub - subsectors];
+    inside = true;
+    count = 0;
+
+    for(thing = sub->sector->thinglist; thing; thing = thing->snext) {
+        if(thing->subsector != sub || (thing->flags & MF_NOSECTOR)) {
+            continue;
+        }
+
+        // things that moved out of the tested box may be in view now
+        if(!R_OcclusionPointInBox(occ->box, F2D3D(thing->x), F2D3D(thing->y), F2D3D(thing->z), 0)) {
+            inside = false;
+        }
+
+        count++;
+    }
+
+    if(!count) {
+        return false;
+    }
+
+    if(occ->listed != occframe) {
+        occ->listed = occframe;
+        occlist[numocclist++] = sub - subsectors;
+    }
+
+    if(occ->issued) {
+        dglGetQueryObjectuivARB(occ->query, GL_QUERY_RESULT_AVAILABLE_ARB, &result);
+
+        if(result) {
+            dglGetQueryObjectuivARB(occ->query, GL_QUERY_RESULT_ARB, &result);
+            occ->occluded = (result == 0);
+            occ->tested = occ->issued;
+            occ->issued = 0;
+        }
+    }
+
+    return occ->occluded && inside && occframe - occ->tested <= OCC_MAXAGE;
+}
+
+//
+// R_AddThingToBox
+// Grows box by the sprite of thing, covering every rotation of
+// its current frame and where it was drawn last tic
+//
+
+static void R_AddThingToBox(mobj_t *thing, float *box) {
+    spritedef_t *sprdef;
+    spriteframe_t *sprframe;
+    float x1, x2, y1, y2, z1, z2;
+    float width;
+    float top;
+    float bottom;
+    int frame;
+    int lump;
+    int i;
+
+    sprdef = &spriteinfo[thing->sprite];
+    frame = thing->frame & FF_FRAMEMASK;
+
+    width = F2D3D(thing->radius);
+    top = F2D3D(thing->height);
+    bottom = 0;
+
+    if(frame < sprdef->numframes) {
+        sprframe = &sprdef->spriteframes[frame];
+
+        for(i = 0; i < (sprframe->rotate ? 8 : 1); i++) {
+            if((lump = sprframe->lump[i]) < 0) {
+                continue;
+            }
+
+            width = MAX(width, fabsf(spriteoffset[lump]));
+            width = MAX(width, fabsf((float)spritewidth[lump] - spriteoffset[lump]));
+            top = MAX(top, spritetopoffset[lump]);
+            bottom = MIN(bottom, spritetopoffset[lump] - (float)spriteheight[lump]);
+        }
+    }
+
+    // billboarded sprites tilt towards the view
+    if(r_rendersprites >= 2) {
+        width = MAX(width, top - bottom);
+    }
+
+    // prop sprites are nudged around to avoid z-fighting
+    width += 2.0f;
+
+    x1 = F2D3D(MIN(thing->x, thing->frame_x));
+    x2 = F2D3D(MAX(thing->x, thing->frame_x));
+    y1 = F2D3D(MIN(thing->y, thing->frame_y));
+    y2 = F2D3D(MAX(thing->y, thing->frame_y));
+    z1 = F2D3D(MIN(thing->z, thing->frame_z));
+    z2 = F2D3D(MAX(thing->z, thing->frame_z));
+
+    box[0] = MIN(box[0], x1 - width);
+    box[1] = MIN(box[1], y1 - width);
+    box[2] = MIN(box[2], z1 + bottom);
+    box[3] = MAX(box[3], x2 + width);
+    box[4] = MAX(box[4], y2 + width);
+    box[5] = MAX(box[5], z2 + top);
+}
+
+//
+// R_SetOcclusionBox
+// The subsector from floor to ceiling plus the sprites inside it.
+// Returns false if the subsector can't be tested this way.
+//
+
+static dboolean R_SetOcclusionBox(subsector_t *sub, float *box) {
+    sector_t *sector;
+    mobj_t *thing;
+    int i;
+
+    box[0] = box[1] = box[2] = (float)D_MAXINT;
+    box[3] = box[4] = box[5] = (float)D_MININT;
+
+    for(i = 0; i < sub->numleafs; i++) {
+        vertex_t *v = leafs[sub->leaf + i].vertex;
+
+        box[0] = MIN(box[0], F2D3D(v->x));
+        box[1] = MIN(box[1], F2D3D(v->y));
+        box[3] = MAX(box[3], F2D3D(v->x));
+        box[4] = MAX(box[4], F2D3D(v->y));
+    }
+
+    sector = sub->sector;
+
+    box[2] = F2D3D(MIN(sector->floorheight, sector->frame_z1[1]));
+    box[5] = F2D3D(MAX(sector->ceilingheight, sector->frame_z2[1]));
+
+    for(thing = sector->thinglist; thing; thing = thing->snext) {
+        if(thing->subsector != sub || (thing->flags & MF_NOSECTOR)) {
+            continue;
+        }
+
+        // lasers are stretched between two points
+        if(thing->flags & MF_RENDERLASER) {
+            return false;
+        }
+
+        R_AddThingToBox(thing, box);
+    }
+
+    return true;
+}
+
+//
+// R_DrawOcclusionQueries
+// Called after the walls and flats are drawn and before the
+// sprites. Nothing is written to the color or depth buffers.
+//
+
+void R_DrawOcclusionQueries(void) {
+    occlusion_t *occ;
+    float corner[8][3];
+    int i;
+    int j;
+
+    if(!occactive || !numocclist) {
+        return;
+    }
+
+    GL_SetState(GLSTATE_TEXTURE0, 0);
+    GL_SetState(GLSTATE_CULL, 0);
+    dglDisable(GL_ALPHA_TEST);
+    dglColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    dglDepthMask(GL_FALSE);
+
+    for(i = 0; i < numocclist; i++) {
+        subsector_t *sub = &subsectors[occlist[i]];
+
+        occ = &occlusion[occlist[i]];
+
+        // the last query is still in flight
+        if(occ->issued) {
+            continue;
+        }
+
+        // a box around the view would be clipped by the near plane
+        if(!R_SetOcclusionBox(sub, occ->box) ||
+                R_OcclusionPointInBox(occ->box, fviewx, fviewy, fviewz, OCC_VIEWPAD)) {
+            occ->occluded = false;
+            occ->tested = occframe;
+            continue;
+        }
+
+        if(!occ->query) {
+            dglGenQueriesARB(1, &occ->query);
+        }
+
+        for(j = 0; j < 8; j++) {
+            corner[j][0] = occ->box[(j & 1) ? 3 : 0];
+            corner[j][1] = occ->box[(j & 2) ? 4 : 1];
+            corner[j][2] = occ->box[(j & 4) ? 5 : 2];
+        }
+
+        dglBeginQueryARB(GL_SAMPLES_PASSED_ARB, occ->query);
+        dglBegin(GL_QUADS);
+
+        for(j = 0; j < 24; j++) {
+            const float *c = corner[occboxfaces[j]];
+            dglVertex3f(c[0], c[1], c[2]);
+        }
+
+        dglEnd();
+        dglEndQueryARB(GL_SAMPLES_PASSED_ARB);
+
+        occ->issued = occframe;
+    }
+
+    dglColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    dglEnable(GL_ALPHA_TEST);
+    GL_SetState(GLSTATE_TEXTURE0, 1);
+}
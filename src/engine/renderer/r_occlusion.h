@@ -0,0 +1,31 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef R_OCCLUSION_H
+#define R_OCCLUSION_H
+
+extern cvar::BoolVar r_occlusion;
+
+void        R_InitOcclusion(void);
+void        R_SetupOcclusion(void);
+dboolean    R_SubsectorOccluded(subsector_t *sub);
+void        R_DrawOcclusionQueries(void);
+
+#endif
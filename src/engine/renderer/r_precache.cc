@@ -0,0 +1,361 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Level precaching.
+//    Gathers every texture, palette variant and sprite frame the level
+//    can reach, including things that are only spawned later on
+//    (projectiles, drops, spawn specials), and decodes them on the
+//    texture streaming threads before the level starts.
+//
+//-----------------------------------------------------------------------------
+
+#include "doomdef.h"
+#include "doomstat.h"
+#include "r_local.h"
+#include "gl_texture.h"
+#include "gl_texstream.h"
+#include "gl_main.h"
+#include "i_system.h"
+#include "p_local.h"
+#include "p_spec.h"
+#include "p_pspr.h"
+#include "z_zone.h"
+#include "con_console.h"
+
+extern "C" {
+
+void A_FireMissile();
+void A_FireBFG();
+void A_BFGSpray();
+void A_FirePlasma();
+void A_FireLaser();
+void A_Tracer();
+void A_RectMissile();
+void A_RectGroundFire();
+void A_MoveGroundFire();
+void A_PainAttack();
+void A_PainDie();
+void A_BarrelExplode();
+void A_SpawnSmoke();
+void A_CyberDeathEvent();
+void A_RectDeathEvent();
+
+} // extern "C"
+
+//
+// Things spawned by action functions
+//
+
+static const struct {
+    actionf_v   action;
+    mobjtype_t  type;
+} precacheactions[] = {
+    { A_FireMissile,        MT_PROJ_ROCKET      },
+    { A_FireBFG,            MT_PROJ_BFG         },
+    { A_BFGSpray,           MT_BFGSPREAD        },
+    { A_FirePlasma,         MT_PROJ_PLASMA      },
+    { A_FireLaser,          MT_PROJ_LASER       },
+    { A_FireLaser,          MT_LASERMARKER      },
+    { A_Tracer,             MT_SMOKE_RED        },
+    { A_RectMissile,        MT_PROJ_RECT        },
+    { A_RectGroundFire,     MT_PROJ_RECTFIRE    },
+    { A_MoveGroundFire,     MT_PROP_FIRE        },
+    { A_PainAttack,         MT_SKULL            },
+    { A_PainDie,            MT_SKULL            },
+    { A_BarrelExplode,      MT_EXPLOSION1       },
+    { A_SpawnSmoke,         MT_SMOKE_GRAY       },
+    { A_CyberDeathEvent,    MT_EXPLOSION2       },
+    { A_RectDeathEvent,     MT_EXPLOSION2       }
+};
+
+//
+// Things spawned on behalf of a specific type
+// (see P_MissileAttack, P_KillMobj and P_SpawnDartMissile)
+//
+
+static const struct {
+    mobjtype_t  type;
+    mobjtype_t  spawn;
+} precachespawns[] = {
+    { MT_MANCUBUS,          MT_PROJ_FATSO       },
+    { MT_IMP1,              MT_PROJ_IMP1        },
+    { MT_IMP2,              MT_PROJ_IMP2        },
+    { MT_BABY,              MT_PROJ_BABY        },
+    { MT_CACODEMON,         MT_PROJ_HEAD        },
+    { MT_CYBORG,            MT_PROJ_ROCKET      },
+    { MT_CYBORG_TITLE,      MT_PROJ_ROCKET      },
+    { MT_BRUISER1,          MT_PROJ_BRUISER2    },
+    { MT_BRUISER2,          MT_PROJ_BRUISER1    },
+    { MT_POSSESSED1,        MT_AMMO_CLIP        },
+    { MT_POSSESSED2,        MT_WEAP_SHOTGUN     },
+    { MT_DEST_PROJECTILE,   MT_PROJ_DART        },
+    { MT_DEST_PROJECTILE,   MT_PROJ_TRACER      }
+};
+
+// bitmasks of palettes, indexed by state, mobj type and sprite lump
+static word *statepals;
+static word *mobjpals;
+static word *spritepals;
+
+static void R_PrecacheMobjType(int type, int pal);
+
+//
+// R_PrecacheState
+// Follows a state chain, marking the sprite frames it shows
+//
+
+static void R_PrecacheState(int state, int pal) {
+    int i;
+
+    while(state != S_000 && !(statepals[state] & (1 << pal))) {
+        state_t *st = &states[state];
+        spritedef_t *sprdef = &spriteinfo[st->sprite];
+        int frame = st->frame & FF_FRAMEMASK;
+
+        statepals[state] |= (1 << pal);
+
+        if(frame < sprdef->numframes) {
+            spriteframe_t *sprframe = &sprdef->spriteframes[frame];
+            int rotations = sprframe->rotate ? 8 : 1;
+
+            for(i = 0; i < rotations; i++) {
+                if(sprframe->lump[i] >= 0) {
+                    spritepals[sprframe->lump[i]] |= (1 << pal);
+                }
+            }
+        }
+
+        if(st->action.acv) {
+            for(i = 0; i < (int)(sizeof(precacheactions) / sizeof(precacheactions[0])); i++) {
+                if(st->action.acv == precacheactions[i].action) {
+                    R_PrecacheMobjType(precacheactions[i].type, mobjinfo[precacheactions[i].type].palette);
+                }
+            }
+        }
+
+        state = st->nextstate;
+    }
+}
+
+//
+// R_PrecacheMobjType
+//
+
+static void R_PrecacheMobjType(int type, int pal) {
+    mobjinfo_t *info = &mobjinfo[type];
+    int i;
+
+    // palettes are kept in a 16 bit mask
+    if(pal < 0 || pal >= 16) {
+        pal = 0;
+    }
+
+    if(mobjpals[type] & (1 << pal)) {
+        return;
+    }
+
+    mobjpals[type] |= (1 << pal);
+
+    R_PrecacheState(info->spawnstate, pal);
+    R_PrecacheState(info->seestate, pal);
+    R_PrecacheState(info->painstate, pal);
+    R_PrecacheState(info->meleestate, pal);
+    R_PrecacheState(info->missilestate, pal);
+    R_PrecacheState(info->deathstate, pal);
+    R_PrecacheState(info->xdeathstate, pal);
+
+    for(i = 0; i < (int)(sizeof(precachespawns) / sizeof(precachespawns[0])); i++) {
+        if(precachespawns[i].type == type) {
+            R_PrecacheMobjType(precachespawns[i].spawn, mobjinfo[precachespawns[i].spawn].palette);
+        }
+    }
+}
+
+//
+// R_PrecacheTextures
+//
+
+static int R_PrecacheTextures(void) {
+    char *texturepresent;
+    int i;
+    int j;
+    int p;
+    int num;
+
+    texturepresent = (char*)Z_Alloca(numtextures);
+
+    for(i = 0; i < numsides; i++) {
+        texturepresent[sides[i].toptexture] = 1;
+        texturepresent[sides[i].midtexture] = 1;
+        texturepresent[sides[i].bottomtexture] = 1;
+    }
+
+    for(i = 0; i < numsectors; i++) {
+        texturepresent[sectors[i].ceilingpic] = 1;
+        texturepresent[sectors[i].floorpic] = 1;
+
+        if(sectors[i].flags & MS_LIQUIDFLOOR) {
+            texturepresent[sectors[i].floorpic + 1] = 1;
+        }
+    }
+
+    // switches toggle between pairs of textures
+    if(swx_start != -1) {
+        for(i = swx_start; i < numtextures; i++) {
+            if(texturepresent[i] && (i ^ 1) < numtextures) {
+                texturepresent[i ^ 1] = 1;
+            }
+        }
+    }
+
+    num = 0;
+
+    for(p = 0; p < numanimdef; p++) {
+        i = animdefs[p].texnum;
+
+        if(!texturepresent[i]) {
+            continue;
+        }
+
+        for(j = 1; j < animdefs[p].frames; j++) {
+            if(animdefs[p].palette) {
+                GL_PrecacheWorldTexture(i, j);
+                num++;
+            }
+            else {
+                texturepresent[i + j] = 1;
+            }
+        }
+    }
+
+    for(i = 0; i < numtextures; i++) {
+        if(texturepresent[i]) {
+            GL_PrecacheWorldTexture(i, 0);
+            num++;
+        }
+    }
+
+    return num;
+}
+
+//
+// R_PrecacheSprites
+//
+
+static int R_PrecacheSprites(void) {
+    mobj_t *mo;
+    int i;
+    int j;
+    int p;
+    int num;
+
+    statepals = (word*)Z_Alloca(NUMSTATES * sizeof(word));
+    mobjpals = (word*)Z_Alloca(NUMMOBJTYPES * sizeof(word));
+    spritepals = (word*)Z_Alloca(numsprtex * sizeof(word));
+
+    for(mo = mobjhead.next; mo != &mobjhead; mo = mo->next) {
+        R_PrecacheMobjType(mo->type, mo->player ? mo->player->palette : mo->info->palette);
+    }
+
+    // things that are spawned later by specials
+    for(i = 0; i < numspawnlist; i++) {
+        for(j = 0; j < NUMMOBJTYPES; j++) {
+            if(spawnlist[i].type == mobjinfo[j].doomednum) {
+                R_PrecacheMobjType(j, mobjinfo[j].palette);
+                break;
+            }
+        }
+    }
+
+    // spawned by the player or the world at any time
+    R_PrecacheMobjType(MT_BLOOD, mobjinfo[MT_BLOOD].palette);
+    R_PrecacheMobjType(MT_SMOKE_SMALL, mobjinfo[MT_SMOKE_SMALL].palette);
+    R_PrecacheMobjType(MT_TELEPORTFOG, mobjinfo[MT_TELEPORTFOG].palette);
+
+    // crushed bodies (see PIT_ChangeSector)
+    R_PrecacheState(S_498, 0);
+
+    for(i = 0; i < NUMWEAPONS; i++) {
+        R_PrecacheState(weaponinfo[i].upstate, 0);
+        R_PrecacheState(weaponinfo[i].downstate, 0);
+        R_PrecacheState(weaponinfo[i].readystate, 0);
+        R_PrecacheState(weaponinfo[i].atkstate, 0);
+        R_PrecacheState(weaponinfo[i].flashstate, 0);
+    }
+
+    num = 0;
+
+    for(i = 0; i < numsprtex; i++) {
+        for(p = 0; p < 16; p++) {
+            if(spritepals[i] & (1 << p)) {
+                GL_PrecacheSpriteTexture(i, p);
+                num++;
+            }
+        }
+    }
+
+    return num;
+}
+
+//
+// R_PrecacheLevel
+// Loads all textures and sprites the level can use before it starts
+//
+
+void R_PrecacheLevel(void) {
+    int starttime;
+    int numtex;
+    int numspr;
+
+    // nothing to upload to without a display
+    if(!usingGL) {
+        return;
+    }
+
+    CON_DPrintf("--------R_PrecacheLevel--------\n");
+
+    starttime = I_GetTimeMS();
+
+    numtex = R_PrecacheTextures();
+    numspr = R_PrecacheSprites();
+
+    // decoding happens on the streaming threads, wait for all of it
+    GL_FlushTextureStream();
+    GL_ResetTextures();
+
+    CON_DPrintf("%i world textures cached\n", numtex);
+    CON_DPrintf("%i sprites cached\n", numspr);
+    CON_DPrintf("precache took %i ms, %i KB texture memory in use\n",
+                I_GetTimeMS() - starttime, (int)(GL_TextureMemory() >> 10));
+
+    if(GLAD_GL_ARB_multitexture) {
+        GL_SetTextureUnit(1, true);
+        GL_BindEnvTexture();
+
+        GL_SetTextureUnit(2, true);
+        GL_BindDummyTexture();
+
+        GL_SetTextureUnit(3, true);
+        GL_BindDummyTexture();
+    }
+
+    GL_SetDefaultCombiner();
+}
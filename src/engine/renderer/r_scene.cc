@@ -31,6 +31,8 @@
 #include "r_local.h"
 #include "r_sky.h"
 #include "r_drawlist.h"
+#include "gl_gputimer.h"
+#include "r_occlusion.h"
 
 extern cvar::BoolVar i_interpolateframes;
 extern cvar::BoolVar r_texturecombiner;
@@ -44,20 +46,17 @@ extern cvar::BoolVar st_flashoverlay;
 
 static dboolean ProcessWalls(vtxlist_t* vl, int* drawcount) {
     seg_t* seg = (seg_t*)vl->data;
-    sector_t* sec = seg->frontsector;
+    vtx_t vtx[4];
 
-    bspColor[LIGHT_FLOOR]    = R_GetSectorLight(0xff, sec->colors[LIGHT_FLOOR]);
-    bspColor[LIGHT_CEILING] = R_GetSectorLight(0xff, sec->colors[LIGHT_CEILING]);
-    bspColor[LIGHT_THING]    = R_GetSectorLight(0xff, sec->colors[LIGHT_THING]);
-    bspColor[LIGHT_UPRWALL] = R_GetSectorLight(0xff, sec->colors[LIGHT_UPRWALL]);
-    bspColor[LIGHT_LWRWALL] = R_GetSectorLight(0xff, sec->colors[LIGHT_LWRWALL]);
-
-    if(!vl->callback(seg, &drawVertex[*drawcount])) {
+    // colors come from the seg light cache (see R_SetSegLineColor)
+    if(!vl->callback(seg, vtx)) {
         return false;
     }
 
-    dglTriangle(*drawcount + 0, *drawcount + 1, *drawcount + 2);
-    dglTriangle(*drawcount + 3, *drawcount + 2, *drawcount + 1);
+    dmemcpy(dglBatchVertex(4), vtx, sizeof(vtx));
+
+    dglTriangle(0, 1, 2);
+    dglTriangle(3, 2, 1);
 
     *drawcount += 4;
 
@@ -75,15 +74,15 @@ static dboolean ProcessFlats(vtxlist_t* vl, int* drawcount) {
     leaf_t* leaf;
     subsector_t* ss;
     sector_t* sector;
-    int count;
+    vtx_t* vtx;
 
     ss      = (subsector_t*)vl->data;
     leaf    = &leafs[ss->leaf];
     sector  = ss->sector;
-    count   = *drawcount;
+    vtx     = dglBatchVertex(ss->numleafs);
 
     for(j = 0; j < ss->numleafs - 2; j++) {
-        dglTriangle(count, count + 1 + j, count + 2 + j);
+        dglTriangle(0, 1 + j, 2 + j);
     }
 
     // need to keep texture coords small to avoid
@@ -96,7 +95,7 @@ static dboolean ProcessFlats(vtxlist_t* vl, int* drawcount) {
 
     for(j = 0; j < ss->numleafs; j++) {
         int idx;
-        vtx_t *v = &drawVertex[count];
+        vtx_t *v = &vtx[j];
 
         if(vl->flags & DLF_CEILING) {
             leaf = &leafs[(ss->leaf + (ss->numleafs - 1)) - j];
@@ -159,40 +158,9 @@ static dboolean ProcessFlats(vtxlist_t* vl, int* drawcount) {
         if(vl->flags & DLF_WATER2) {
             v->tu += F2D3D(scrollfrac >> 6);
         }
-
-        count++;
     }
 
-    *drawcount = count;
-
-    return true;
-}
-
-//
-// ProcessSprites
-//
-
-static dboolean ProcessSprites(vtxlist_t* vl, int* drawcount) {
-    visspritelist_t* vis;
-    mobj_t* mobj;
-
-    vis = (visspritelist_t*)vl->data;
-    mobj = vis->spr;
-
-    if(!mobj) {
-        return false;
-    }
-
-    if(!vl->callback(vis, &drawVertex[*drawcount])) {
-        return false;
-    }
-
-    GL_SetState(GLSTATE_CULL, !(mobj->flags & MF_RENDERLASER));
-
-    dglTriangle(*drawcount + 0, *drawcount + 1, *drawcount + 2);
-    dglTriangle(*drawcount + 3, *drawcount + 2, *drawcount + 1);
-
-    *drawcount += 4;
+    *drawcount += ss->numleafs;
 
     return true;
 }
@@ -330,6 +298,7 @@ void R_RenderWorld(void) {
 
     // -------------- Draw walls (segs) --------------------------
 
+    GL_BeginGPUPass(GPU_WORLD);
     DL_ProcessDrawList(DLT_WALL, ProcessWalls);
 
     // -------------- Draw floors/ceilings (leafs) ---------------
@@ -337,6 +306,11 @@ void R_RenderWorld(void) {
     GL_SetState(GLSTATE_BLEND, 1);
     DL_ProcessDrawList(DLT_FLAT, ProcessFlats);
 
+    // -------------- Test sprite occlusion ----------------------
+
+    R_DrawOcclusionQueries();
+    GL_EndGPUPass();
+
     // -------------- Draw things (sprites) ----------------------
 
     if(devparm) {
@@ -348,7 +322,9 @@ void R_RenderWorld(void) {
     }
 
     dglDepthMask(GL_FALSE);
-    DL_ProcessDrawList(DLT_SPRITE, ProcessSprites);
+    GL_BeginGPUPass(GPU_SPRITES);
+    DL_ProcessSpriteList();
+    GL_EndGPUPass();
 
     // -------------- Restore states -----------------------------
 
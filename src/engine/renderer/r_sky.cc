@@ -65,9 +65,39 @@ static float sky_cloudpan2 = 0;
 
 extern cvar::BoolVar r_texturecombiner;
 extern cvar::BoolVar r_skybox;
+extern cvar::BoolVar r_drawtris;
 
 #define SKYVIEWPOS(angle, amount, x) x = -(angle / (float)ANG90 * amount); while(x < 1.0f) x += 1.0f
 
+#define NUM_SKY_DOME_FACES  32
+#define MAXSKYMESHVERTS     (NUM_SKY_DOME_FACES * 4)
+
+//
+// Sky geometry is built once per sky and kept in a vertex buffer.
+// Scrolling goes through the texture matrix and the vertices are
+// only rewritten when thunder changes the sky colors.
+//
+
+typedef enum {
+    SKYMESH_DOME,
+    SKYMESH_FIREDOME,
+    SKYMESH_BACKDROP,
+    SKYMESH_CLOUDBOX,
+    SKYMESH_CLOUDS,
+    NUMSKYMESHES
+} skymeshtype_t;
+
+typedef struct {
+    dboolean    built;
+    dboolean    colorsvalid;
+    rcolor      colors[3];
+    int         numverts;
+    rbuffer     buffer;
+    vtx_t       vtx[MAXSKYMESHVERTS];
+} skymesh_t;
+
+static skymesh_t skymeshes[NUMSKYMESHES];
+
 //
 // R_CloudThunder
 // Loosely based on subroutine at 0x80026418
@@ -141,63 +171,128 @@ static void R_TitleSkyTicker(void) {
 }
 
 //
-// R_DrawSkyDome
+// R_InitSkyMeshes
+// Called for every new sky, the meshes are built again on first use
 //
 
-static void R_DrawSkyDome(int tiles, float rows, int height,
-                          int radius, float offset, float topoffs,
-                          rcolor c1, rcolor c2) {
-    fixed_t x, y, z;
-    fixed_t lx, ly;
+void R_InitSkyMeshes(void) {
     int i;
-    angle_t an;
-    float tu1, tu2;
-    int r;
-    vtx_t *vtx;
-    int count;
 
-    lx = ly = count = 0;
+    for(i = 0; i < NUMSKYMESHES; i++) {
+        skymeshes[i].built = false;
+        skymeshes[i].colorsvalid = false;
+    }
+}
 
-#define NUM_SKY_DOME_FACES  32
+//
+// R_SkyMeshColorsChanged
+//
 
-    //
-    // hack to force ortho scale back to 1
-    //
-    GL_SetOrthoScale(1.0f);
+static dboolean R_SkyMeshColorsChanged(skymesh_t *mesh, rcolor c1, rcolor c2, rcolor c3) {
+    if(mesh->colorsvalid && mesh->colors[0] == c1 &&
+        mesh->colors[1] == c2 && mesh->colors[2] == c3) {
+        return false;
+    }
 
-    //
-    // setup view projection
-    //
-    dglMatrixMode(GL_PROJECTION);
+    mesh->colors[0] = c1;
+    mesh->colors[1] = c2;
+    mesh->colors[2] = c3;
+    mesh->colorsvalid = true;
+
+    return true;
+}
+
+//
+// R_UploadSkyMesh
+//
+
+static void R_UploadSkyMesh(skymesh_t *mesh) {
+    if(!GLAD_GL_ARB_vertex_buffer_object) {
+        return;
+    }
+
+    if(!mesh->buffer) {
+        dglGenBuffersARB(1, &mesh->buffer);
+    }
+
+    dglBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh->buffer);
+    dglBufferDataARB(GL_ARRAY_BUFFER_ARB, mesh->numverts * sizeof(vtx_t),
+                     mesh->vtx, GL_STATIC_DRAW_ARB);
+    dglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+}
+
+//
+// R_BindSkyMesh
+//
+
+static void R_BindSkyMesh(skymesh_t *mesh) {
+    if(mesh->buffer) {
+        dglSetVertexBuffer(mesh->buffer);
+    }
+    else {
+        dglSetVertex(mesh->vtx);
+    }
+}
+
+//
+// R_UnbindSkyMesh
+//
+
+static void R_UnbindSkyMesh(skymesh_t *mesh) {
+    if(mesh->buffer) {
+        dglSetVertexBuffer(0);
+    }
+}
+
+//
+// R_DrawSkyMesh
+// Draws the triangles added with dglTriangle
+//
+
+static void R_DrawSkyMesh(skymesh_t *mesh) {
+    dglDrawGeometry(mesh->numverts, mesh->vtx);
+
+    // wireframe overwrites the colors of the local copy
+    if(r_drawtris) {
+        mesh->colorsvalid = false;
+    }
+}
+
+//
+// R_SetSkyTextureOffset
+// Scrolls texture unit 0 without touching the vertices
+//
+
+static void R_SetSkyTextureOffset(float u, float v) {
+    dglMatrixMode(GL_TEXTURE);
     dglLoadIdentity();
-    dglViewFrustum(video_width, video_height, *r_fov, 0.1f);
+
+    if(u != 0.0f || v != 0.0f) {
+        dglTranslatef(u, v, 0.0f);
+    }
+
     dglMatrixMode(GL_MODELVIEW);
-    dglLoadIdentity();
-    dglPushMatrix();
-    dglRotatef(-TRUEANGLES(viewpitch), 1.0f, 0.0f, 0.0f);
-    dglRotatef(-TRUEANGLES(viewangle) + 90.0f, 0.0f, 0.0f, 1.0f);
+}
 
-    //
-    // try to center view to the dome
-    //
-    dglTranslated(
-        -((float)radius / ((float)NUM_SKY_DOME_FACES / 2.0f)),
-        -((float)radius / (M_PI / 2)),
-        -offset);
+//
+// R_BuildSkyDome
+//
 
-    //
-    // front faces are drawn here, so cull the back faces
-    //
-    dglCullFace(GL_BACK);
-    GL_SetState(GLSTATE_BLEND, 1);
+static void R_BuildSkyDome(skymesh_t *mesh, int tiles, float rows,
+                           int height, int radius, float topoffs) {
+    fixed_t x, y, z;
+    fixed_t lx, ly;
+    int i;
+    angle_t an;
+    float tu1, tu2;
+    int r;
+    vtx_t *vtx;
 
-    r = radius / (NUM_SKY_DOME_FACES / 4);
+    lx = ly = 0;
+    x = y = 0;
 
-    //
-    // set pointer for the main vertex list
-    //
-    dglSetVertex(drawVertex);
-    vtx = drawVertex;
+    r = radius / (NUM_SKY_DOME_FACES / 4);
+    vtx = mesh->vtx;
 
 #define SKYDOME_VERTEX() vtx->x = F2D3D(x); vtx->y = F2D3D(y); vtx->z = F2D3D(z)
 #define SKYDOME_UV(u, v) vtx->tu = u; vtx->tv = v
@@ -227,11 +322,6 @@ static void R_DrawSkyDome(int tiles, float rows, int height,
     for(i = 0; i < NUM_SKY_DOME_FACES; i++) {
         angle_t angle = an * i;
 
-        dglSetVertexColor(&vtx[0], c2, 1);
-        dglSetVertexColor(&vtx[1], c1, 1);
-        dglSetVertexColor(&vtx[2], c1, 1);
-        dglSetVertexColor(&vtx[3], c2, 1);
-
         SKYDOME_LEFT(rows, -height);
         SKYDOME_LEFT(topoffs, height);
         SKYDOME_RIGHT(topoffs, height);
@@ -240,41 +330,46 @@ static void R_DrawSkyDome(int tiles, float rows, int height,
         lx = x;
         ly = y;
 
-        dglTriangle(0+count, 1+count, 2+count);
-        dglTriangle(3+count, 0+count, 2+count);
-        count += 4;
-
         tu1 += tu2;
     }
 
-    //
-    // draw sky dome
-    //
-    dglDrawGeometry(count, drawVertex);
-
-    dglPopMatrix();
-    dglCullFace(GL_FRONT);
-
-    GL_SetState(GLSTATE_BLEND, 0);
+    mesh->numverts = NUM_SKY_DOME_FACES * 4;
+    mesh->built = true;
+    mesh->colorsvalid = false;
 
 #undef SKYDOME_RIGHT
 #undef SKYDOME_LEFT
 #undef SKYDOME_UV
 #undef SKYDOME_VERTEX
-#undef NUM_SKY_DOME_FACES
 }
 
 //
-// R_DrawSkyboxCloud
+// R_DrawSkyDome
 //
 
-static void R_DrawSkyboxCloud(void) {
-    rcolor color;
-    vtx_t v[4];
+static void R_DrawSkyDome(skymeshtype_t type, int tiles, float rows, int height,
+                          int radius, float offset, float topoffs,
+                          rcolor c1, rcolor c2) {
+    skymesh_t *mesh = &skymeshes[type];
+    int i;
 
-#define SKYBOX_SETALPHA(c, x)           \
-    c ^= (((c >> 24) & 0xff) << 24);    \
-    c |= (x << 24)
+    if(!mesh->built) {
+        R_BuildSkyDome(mesh, tiles, rows, height, radius, topoffs);
+    }
+
+    //
+    // thunder changes the colors of the fire sky dome
+    //
+    if(R_SkyMeshColorsChanged(mesh, c1, c2, 0)) {
+        for(i = 0; i < NUM_SKY_DOME_FACES; i++) {
+            dglSetVertexColor(&mesh->vtx[i * 4 + 0], c2, 1);
+            dglSetVertexColor(&mesh->vtx[i * 4 + 1], c1, 1);
+            dglSetVertexColor(&mesh->vtx[i * 4 + 2], c1, 1);
+            dglSetVertexColor(&mesh->vtx[i * 4 + 3], c2, 1);
+        }
+
+        R_UploadSkyMesh(mesh);
+    }
 
     //
     // hack to force ortho scale back to 1
@@ -291,63 +386,183 @@ static void R_DrawSkyboxCloud(void) {
     dglLoadIdentity();
     dglPushMatrix();
     dglRotatef(-TRUEANGLES(viewpitch), 1.0f, 0.0f, 0.0f);
+    dglRotatef(-TRUEANGLES(viewangle) + 90.0f, 0.0f, 0.0f, 1.0f);
 
     //
-    // set vertex pointer
+    // try to center view to the dome
     //
-    dglSetVertex(v);
+    dglTranslated(
+        -((float)radius / ((float)NUM_SKY_DOME_FACES / 2.0f)),
+        -((float)radius / (M_PI / 2)),
+        -offset);
 
     //
-    // disable textures for horizon effect
+    // front faces are drawn here, so cull the back faces
     //
-    dglDisable(GL_TEXTURE_2D);
+    dglCullFace(GL_BACK);
+    GL_SetState(GLSTATE_BLEND, 1);
+
+    R_BindSkyMesh(mesh);
+
+    for(i = 0; i < NUM_SKY_DOME_FACES; i++) {
+        dglTriangle(i * 4 + 0, i * 4 + 1, i * 4 + 2);
+        dglTriangle(i * 4 + 3, i * 4 + 0, i * 4 + 2);
+    }
 
     //
-    // draw horizon ceiling
+    // draw sky dome
     //
+    R_DrawSkyMesh(mesh);
+    R_UnbindSkyMesh(mesh);
+
+    dglPopMatrix();
+    dglCullFace(GL_FRONT);
+
+    GL_SetState(GLSTATE_BLEND, 0);
+}
+
+//
+// R_SetSkyboxPlane
+//
+
+static void R_SetSkyboxPlane(vtx_t *v, float z, float uv) {
     v[0].x = -MAX_COORD;
     v[0].y = -MAX_COORD;
-    v[0].z = 512;
     v[1].x = MAX_COORD;
     v[1].y = -MAX_COORD;
-    v[1].z = 512;
     v[2].x = MAX_COORD;
     v[2].y = MAX_COORD;
-    v[2].z = 512;
     v[3].x = -MAX_COORD;
     v[3].y = MAX_COORD;
-    v[3].z = 512;
+    v[0].z = v[1].z = v[2].z = v[3].z = z;
+
+    v[0].tu = 0;
+    v[0].tv = 0;
+    v[1].tu = uv;
+    v[1].tv = 0;
+    v[2].tu = uv;
+    v[2].tv = uv;
+    v[3].tu = 0;
+    v[3].tv = uv;
+}
+
+//
+// R_BuildSkyboxCloud
+// Horizon ceiling and wall, both cloud layers and the contrast plane
+//
+
+static void R_BuildSkyboxCloud(skymesh_t *mesh) {
+    vtx_t *v = mesh->vtx;
+
+    //
+    // horizon ceiling
+    //
+    R_SetSkyboxPlane(&v[0], 512, 0);
+
+    //
+    // horizon wall
+    //
+    v[4].x = -MAX_COORD;
+    v[4].y = 512;
+    v[4].z = 12;
+    v[5].x = -MAX_COORD;
+    v[5].y = 512;
+    v[5].z = 512;
+    v[6].x = MAX_COORD;
+    v[6].y = 512;
+    v[6].z = 512;
+    v[7].x = MAX_COORD;
+    v[7].y = 512;
+    v[7].z = 12;
+    v[4].tu = v[4].tv = v[5].tu = v[5].tv = 0;
+    v[6].tu = v[6].tv = v[7].tu = v[7].tv = 0;
+
+    //
+    // cloud layers, scrolled with the texture matrix
+    //
+    R_SetSkyboxPlane(&v[8], 768, 16);
+    R_SetSkyboxPlane(&v[12], 1024, 32);
+
+    //
+    // contrast plane over the top cloud layer
+    //
+    R_SetSkyboxPlane(&v[16], 1024, 0);
+
+    mesh->numverts = 20;
+    mesh->built = true;
+    mesh->colorsvalid = false;
+}
+
+//
+// R_DrawSkyboxCloud
+//
+
+static void R_DrawSkyboxCloud(void) {
+    skymesh_t *mesh = &skymeshes[SKYMESH_CLOUDBOX];
+
+#define SKYBOX_SETALPHA(c, x)           \
+    c ^= (((c >> 24) & 0xff) << 24);    \
+    c |= (x << 24)
+
+    if(!mesh->built) {
+        R_BuildSkyboxCloud(mesh);
+    }
 
-    dglSetVertexColor(&v[0], sky->skycolor[0], 4);
+    if(R_SkyMeshColorsChanged(mesh, sky->skycolor[0], sky->skycolor[1], sky->skycolor[2])) {
+        rcolor color;
 
+        dglSetVertexColor(&mesh->vtx[0], sky->skycolor[0], 4);
+        dglSetVertexColor(&mesh->vtx[4], sky->skycolor[1], 1);
+        dglSetVertexColor(&mesh->vtx[5], sky->skycolor[0], 1);
+        dglSetVertexColor(&mesh->vtx[6], sky->skycolor[0], 1);
+        dglSetVertexColor(&mesh->vtx[7], sky->skycolor[1], 1);
+
+        color = sky->skycolor[2];
+        SKYBOX_SETALPHA(color, 0x3f);
+        dglSetVertexColor(&mesh->vtx[8], color, 8);
+
+        SKYBOX_SETALPHA(color, 0x1f);
+        dglSetVertexColor(&mesh->vtx[16], color, 4);
+
+        R_UploadSkyMesh(mesh);
+    }
+
+    //
+    // hack to force ortho scale back to 1
+    //
+    GL_SetOrthoScale(1.0f);
+
+    //
+    // setup view projection
+    //
+    dglMatrixMode(GL_PROJECTION);
+    dglLoadIdentity();
+    dglViewFrustum(video_width, video_height, *r_fov, 0.1f);
+    dglMatrixMode(GL_MODELVIEW);
+    dglLoadIdentity();
+    dglPushMatrix();
+    dglRotatef(-TRUEANGLES(viewpitch), 1.0f, 0.0f, 0.0f);
+
+    R_BindSkyMesh(mesh);
+
+    //
+    // disable textures for horizon effect
+    //
+    dglDisable(GL_TEXTURE_2D);
+
+    //
+    // draw horizon ceiling
+    //
     dglTriangle(0, 1, 3);
     dglTriangle(2, 3, 1);
-    dglDrawGeometry(4, v);
+    R_DrawSkyMesh(mesh);
 
     //
     // draw horizon wall
     //
-    v[0].x = -MAX_COORD;
-    v[0].y = 512;
-    v[0].z = 12;
-    v[1].x = -MAX_COORD;
-    v[1].y = 512;
-    v[1].z = 512;
-    v[2].x = MAX_COORD;
-    v[2].y = 512;
-    v[2].z = 512;
-    v[3].x = MAX_COORD;
-    v[3].y = 512;
-    v[3].z = 12;
-
-    dglSetVertexColor(&v[0], sky->skycolor[1], 1);
-    dglSetVertexColor(&v[1], sky->skycolor[0], 1);
-    dglSetVertexColor(&v[2], sky->skycolor[0], 1);
-    dglSetVertexColor(&v[3], sky->skycolor[1], 1);
-
-    dglTriangle(0, 1, 2);
-    dglTriangle(3, 0, 2);
-    dglDrawGeometry(4, v);
+    dglTriangle(4, 5, 6);
+    dglTriangle(7, 4, 6);
+    R_DrawSkyMesh(mesh);
     dglEnable(GL_TEXTURE_2D);
     dglPopMatrix();
 
@@ -368,67 +583,32 @@ static void R_DrawSkyboxCloud(void) {
     //
     // draw first cloud layer
     //
-    v[0].tu = sky_cloudpan1;
-    v[0].tv = sky_cloudpan1;
-    v[1].tu = 16 + sky_cloudpan1;
-    v[1].tv = sky_cloudpan1;
-    v[2].tu = 16 + sky_cloudpan1;
-    v[2].tv = 16 + sky_cloudpan1;
-    v[3].tu = sky_cloudpan1;
-    v[3].tv = 16 + sky_cloudpan1;
-    v[0].x = -MAX_COORD;
-    v[0].y = -MAX_COORD;
-    v[0].z = 768;
-    v[1].x = MAX_COORD;
-    v[1].y = -MAX_COORD;
-    v[1].z = 768;
-    v[2].x = MAX_COORD;
-    v[2].y = MAX_COORD;
-    v[2].z = 768;
-    v[3].x = -MAX_COORD;
-    v[3].y = MAX_COORD;
-    v[3].z = 768;
-
-    color = sky->skycolor[2];
-    SKYBOX_SETALPHA(color, 0x3f);
-    dglSetVertexColor(&v[0], color, 4);
-
-    dglTriangle(0, 1, 3);
-    dglTriangle(2, 3, 1);
-    dglDrawGeometry(4, v);
+    R_SetSkyTextureOffset(sky_cloudpan1, sky_cloudpan1);
+    dglTriangle(8, 9, 11);
+    dglTriangle(10, 11, 9);
+    R_DrawSkyMesh(mesh);
 
     //
     // draw second cloud layer
     //
-    // preserve color and xy and just update
-    // uv coords and z height
-    //
-    v[0].tu = sky_cloudpan2;
-    v[0].tv = sky_cloudpan2;
-    v[1].tu = 32 + sky_cloudpan2;
-    v[1].tv = sky_cloudpan2;
-    v[2].tu = 32 + sky_cloudpan2;
-    v[2].tv = 32 + sky_cloudpan2;
-    v[3].tu = sky_cloudpan2;
-    v[3].tv = 32 + sky_cloudpan2;
-    v[0].z = v[1].z = v[2].z = v[3].z = 1024;
-
-    dglTriangle(0, 1, 3);
-    dglTriangle(2, 3, 1);
-    dglDrawGeometry(4, v);
+    R_SetSkyTextureOffset(sky_cloudpan2, sky_cloudpan2);
+    dglTriangle(12, 13, 15);
+    dglTriangle(14, 15, 13);
+    R_DrawSkyMesh(mesh);
+    R_SetSkyTextureOffset(0, 0);
 
     //
     // add more contrast to the top cloud layer
     // just draw a non-textured plane and blend it
     //
     dglDisable(GL_TEXTURE_2D);
-    SKYBOX_SETALPHA(color, 0x1f);
-    dglSetVertexColor(&v[0], color, 4);
-    dglTriangle(0, 1, 3);
-    dglTriangle(2, 3, 1);
-    dglDrawGeometry(4, v);
+    dglTriangle(16, 17, 19);
+    dglTriangle(18, 19, 17);
+    R_DrawSkyMesh(mesh);
     dglEnable(GL_TEXTURE_2D);
 
+    R_UnbindSkyMesh(mesh);
+
     dglPopMatrix();
     GL_SetState(GLSTATE_BLEND, 0);
 
@@ -494,7 +674,11 @@ static void R_DrawTitleSky(void) {
 //
 
 static void R_DrawClouds(void) {
+    skymesh_t *mesh = &skymeshes[SKYMESH_CLOUDS];
     rfloat pos = 0.0f;
+    rcolor top;
+    rcolor bottom;
+    dboolean combine;
     vtx_t v[4];
 
     GL_SetTextureUnit(0, true);
@@ -505,12 +689,46 @@ static void R_DrawClouds(void) {
     dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    dglSetVertex(v);
+    if(!mesh->built) {
+        mesh->vtx[3].x = mesh->vtx[1].x = 1.1025f;
+        mesh->vtx[0].x = mesh->vtx[2].x = -1.1025f;
+        mesh->vtx[2].y = mesh->vtx[3].y = 0;
+        mesh->vtx[0].y = mesh->vtx[1].y = 0.4315f;
+        mesh->vtx[0].z = mesh->vtx[1].z = 0;
+        mesh->vtx[2].z = mesh->vtx[3].z = -1.0f;
+        mesh->vtx[0].tu = mesh->vtx[2].tu = 0;
+        mesh->vtx[1].tu = mesh->vtx[3].tu = 1.5f;
+        mesh->vtx[0].tv = mesh->vtx[1].tv = 0;
+        mesh->vtx[2].tv = mesh->vtx[3].tv = 2.0f;
+
+        mesh->numverts = 4;
+        mesh->built = true;
+        mesh->colorsvalid = false;
+    }
 
-    if(r_texturecombiner && gl_max_texture_units > 2) {
-        dglSetVertexColor(&v[0], sky->skycolor[0], 2);
-        dglSetVertexColor(&v[2], sky->skycolor[1], 2);
+    //
+    // the cloud offsets are applied through the texture matrix
+    //
+    R_SetSkyTextureOffset(F2D3D(CloudOffsetX) - pos, F2D3D(CloudOffsetY));
+
+    combine = (r_texturecombiner && gl_max_texture_units > 2);
+
+    if(combine) {
+        top = sky->skycolor[0];
+        bottom = sky->skycolor[1];
+    }
+    else {
+        top = bottom = (sky->skycolor[2] & 0xffffff) | (0x60 << 24);
+    }
+
+    if(R_SkyMeshColorsChanged(mesh, top, bottom, 0)) {
+        dglSetVertexColor(&mesh->vtx[0], top, 2);
+        dglSetVertexColor(&mesh->vtx[2], bottom, 2);
 
+        R_UploadSkyMesh(mesh);
+    }
+
+    if(combine) {
         GL_UpdateEnvTexture(WHITE);
 
         // pass 1: texture * skycolor
@@ -539,22 +757,8 @@ static void R_DrawClouds(void) {
         GL_SetTextureMode(GL_ADD);
         GL_UpdateEnvTexture(sky->skycolor[1]);
         GL_SetTextureUnit(0, true);
-
-        dglSetVertexColor(&v[0], sky->skycolor[2], 4);
-        v[0].a = v[1].a = v[2].a = v[3].a = 0x60;
     }
 
-    v[3].x = v[1].x = 1.1025f;
-    v[0].x = v[2].x = -1.1025f;
-    v[2].y = v[3].y = 0;
-    v[0].y = v[1].y = 0.4315f;
-    v[0].z = v[1].z = 0;
-    v[2].z = v[3].z = -1.0f;
-    v[0].tu = v[2].tu = F2D3D(CloudOffsetX) - pos;
-    v[1].tu = v[3].tu = (F2D3D(CloudOffsetX) + 1.5f) - pos;
-    v[0].tv = v[1].tv = F2D3D(CloudOffsetY);
-    v[2].tv = v[3].tv = F2D3D(CloudOffsetY) + 2.0f;
-
     GL_SetOrthoScale(1.0f); // force ortho mode to be set
 
     dglMatrixMode(GL_PROJECTION);
@@ -564,111 +768,95 @@ static void R_DrawClouds(void) {
     dglEnable(GL_BLEND);
     dglPushMatrix();
     dglTranslated(0.0f, 0.0f, -1.0f);
+    R_BindSkyMesh(mesh);
     dglTriangle(0, 1, 2);
     dglTriangle(3, 2, 1);
-    dglDrawGeometry(4, v);
+    R_DrawSkyMesh(mesh);
+    R_UnbindSkyMesh(mesh);
     dglPopMatrix();
     dglDisable(GL_BLEND);
 
-    GL_SetDefaultCombiner();
-}
-
-//
-// R_SpreadFire
-//
-
-static void R_SpreadFire(char* src1, char* src2, int pixel, int counter, int* rand) {
-    int randIdx = 0;
-    char *tmpSrc;
-
-    if(pixel != 0) {
-        randIdx = rndtable[*rand];
-        *rand = ((*rand+2) & 0xff);
+    GL_SetTextureUnit(0, true);
+    R_SetSkyTextureOffset(0, 0);
 
-        tmpSrc = (src1 + (((counter - (randIdx & 3)) + 1) & (FIRESKY_WIDTH-1)));
-        *(char*)(tmpSrc - FIRESKY_WIDTH) = pixel - ((randIdx & 1));
-    }
-    else {
-        *(char*)(src2 - FIRESKY_WIDTH) = 0;
-    }
+    GL_SetDefaultCombiner();
 }
 
 //
 // R_Fire
+// Each burning pixel spreads to the row above it, drifting sideways
+// and cooling by the next entry of the random table. Pixels are kept
+// scaled to their gray level so the buffer can be uploaded as is.
+//
+// Columns are still walked left to right and bottom up within each,
+// since a pixel can drift into the next column before that column is
+// read, and the random table has to be consumed in the same order to
+// give the same fire.
 //
 
-static void R_Fire() {
-    int counter = 0;
-    int rand = 0;
-    int step = 0;
-    int pixel = 0;
-    char *src;
-    char *srcoffset;
+static void R_Fire(void) {
+    int spreadofs[128];
+    byte spreadcool[128];
+    byte *fire;
+    byte *src;
+    byte *dst;
+    byte pixel;
+    int rand;
+    int x;
+    int y;
+    int n;
 
+    //
+    // the table index steps by 2, so only 128 entries
+    // can come up in a tic. look them up once.
+    //
     rand = (M_Random() & 0xff);
-    src = fireImage.data_ptr();
-    counter = 0;
-    src += FIRESKY_WIDTH;
-
-    do {  // width
-        srcoffset = (src + counter);
-        pixel = *(byte*)srcoffset;
-
-        step = 2;
 
-        R_SpreadFire(src, srcoffset, pixel, counter, &rand);
+    for(n = 0; n < 128; n++) {
+        byte r = rndtable[(rand + (n << 1)) & 0xff];
 
-        src += FIRESKY_WIDTH;
-        srcoffset += FIRESKY_WIDTH;
+        spreadofs[n] = 1 - (r & 3);
+        spreadcool[n] = (r & 1) << 4;
+    }
 
-        do {  // height
-            pixel = *(byte*)srcoffset;
-            step += 2;
+    fire = reinterpret_cast<byte*>(fireImage.data_ptr());
+    n = 0;
 
-            R_SpreadFire(src, srcoffset, pixel, counter, &rand);
+    for(x = 0; x < FIRESKY_WIDTH; x++) {
+        src = fire + FIRESKY_WIDTH;
 
-            pixel = *(byte*)(srcoffset + FIRESKY_WIDTH);
+        for(y = 1; y < FIRESKY_HEIGHT; y++) {
+            dst = src - FIRESKY_WIDTH;
+            pixel = src[x];
 
-            src += FIRESKY_WIDTH;
-            srcoffset += FIRESKY_WIDTH;
-
-            R_SpreadFire(src, srcoffset, pixel, counter, &rand);
+            if(!pixel) {
+                dst[x] = 0;
+            }
+            else {
+                dst[(x + spreadofs[n]) & (FIRESKY_WIDTH - 1)] = pixel - spreadcool[n];
+                n = (n + 1) & 127;
+            }
 
             src += FIRESKY_WIDTH;
-            srcoffset += FIRESKY_WIDTH;
-
         }
-        while(step < FIRESKY_HEIGHT);
-
-        counter++;
-        src -= ((FIRESKY_WIDTH*FIRESKY_HEIGHT)-FIRESKY_WIDTH);
-
     }
-    while(counter < FIRESKY_WIDTH);
 }
 
 //
 // R_InitFire
 //
 
-static rcolor firetexture[FIRESKY_WIDTH * FIRESKY_HEIGHT];
-
 void R_InitFire(void) {
     auto lump = wad::open(wad::Section::graphics, "FIRE").value();
     fireLump = lump.section_index();
     fireImage = I_ReadImage(lump.lump_index(), true, true, false, 0);
 
+    //
+    // keep the 16 fire levels as gray values, 16 apart
+    //
     auto pixdata = reinterpret_cast<byte*>(fireImage.data_ptr());
-    for (int i = 0; i < 4096; i++)
-        pixdata[i] >>= 4;
-
-    uint8 j = 0;
-    RgbaPalette paldata { 16 };
-    for(auto& c : paldata) {
-        c = Rgba { j, j, j, 0xff };
-        j += 16;
-    }
-    fireImage.set_palette(std::move(paldata));
+    for (int i = 0; i < FIRESKY_WIDTH * FIRESKY_HEIGHT; i++)
+        pixdata[i] &= 0xf0;
 }
 
 //
@@ -689,32 +877,9 @@ static void R_DrawFire(void) {
     float pos1;
     vtx_t v[4];
     dtexture t = gfxptr[fireLump];
-    int i;
-    const byte *fireBuffer;
-    const byte *firePal16;
+    const char *fireBuffer;
 
-    /* I'm currently lazy as hell. All of this will eventually (well, hopefully) be ported
-       to C++. When that happens, we'll be able to easily and safely convert the fire
-       indexed image to a GL texture with no intermediary copies.
-       But right now I can't be arsed. Talk to me in 2030 when I still haven't done it.
-       -dotfloat
-       TODO: Rewrite this */
-    firePal16 = reinterpret_cast<byte*>(fireImage.palette().data_ptr());
-    fireBuffer = reinterpret_cast<byte*>(fireImage.data_ptr());
-
-    //
-    // copy fire pixel data to texture data array
-    //
-    dmemset(firetexture, 0, sizeof(int) * FIRESKY_WIDTH * FIRESKY_HEIGHT);
-    for(i = 0; i < FIRESKY_WIDTH * FIRESKY_HEIGHT; i++) {
-        byte rgb[3];
-
-        rgb[0] = firePal16[4 * fireBuffer[i] + 0];
-        rgb[1] = firePal16[4 * fireBuffer[i] + 1];
-        rgb[2] = firePal16[4 * fireBuffer[i] + 2];
-
-        firetexture[i] = D_RGBA(rgb[2], rgb[1], rgb[0], 0xff);
-    }
+    fireBuffer = fireImage.data_ptr();
 
     if(!t) {
         dglGenTextures(1, &gfxptr[fireLump]);
@@ -728,7 +893,10 @@ static void R_DrawFire(void) {
         glBindCalls++;
     }
 
-
+    //
+    // the fire levels are uploaded straight
+    // into a single channel gray texture
+    //
     if(!t) {
         //
         // copy data if it didn't exist before
@@ -736,13 +904,13 @@ static void R_DrawFire(void) {
         dglTexImage2D(
             GL_TEXTURE_2D,
             0,
-            GL_RGBA8,
+            GL_LUMINANCE8,
             FIRESKY_WIDTH,
             FIRESKY_HEIGHT,
             0,
-            GL_RGBA,
+            GL_LUMINANCE,
             GL_UNSIGNED_BYTE,
-            firetexture
+            fireBuffer
         );
     }
     else {
@@ -756,9 +924,9 @@ static void R_DrawFire(void) {
             0,
             FIRESKY_WIDTH,
             FIRESKY_HEIGHT,
-            GL_RGBA,
+            GL_LUMINANCE,
             GL_UNSIGNED_BYTE,
-            firetexture
+            fireBuffer
         );
     }
 
@@ -778,7 +946,7 @@ static void R_DrawFire(void) {
         GL_Draw2DQuad(v, 1);
     }
     else {
-        R_DrawSkyDome(16, 1, 1024, 4096, -896, 0.0075f,
+        R_DrawSkyDome(SKYMESH_FIREDOME, 16, 1, 1024, 4096, -896, 0.0075f,
                       sky->skycolor[0], sky->skycolor[1]);
     }
 }
@@ -816,7 +984,7 @@ void R_DrawSky(void) {
                 // drawer will assume that the texture's
                 // dimensions is already in powers of 2
                 //
-                R_DrawSkyDome(4, 2, 512, 1024,
+                R_DrawSkyDome(SKYMESH_DOME, 4, 2, 512, 1024,
                               0, 0, WHITE, WHITE);
             }
         }
@@ -856,7 +1024,7 @@ void R_DrawSky(void) {
                 domeheight = (int)(base / (origh / h));
                 offset = (float)domeheight - base - 16.0f;
 
-                R_DrawSkyDome(5, 1, domeheight, 768,
+                R_DrawSkyDome(SKYMESH_BACKDROP, 5, 1, domeheight, 768,
                               offset, 0.005f, WHITE, WHITE);
             }
         }
@@ -44,5 +44,6 @@ extern int          fireLump;
 void R_SkyTicker(void);
 void R_DrawSky(void);
 void R_InitFire(void);
+void R_InitSkyMeshes(void);
 
 #endif
@@ -36,6 +36,7 @@
 #include "r_drawlist.h"
 #include "p_local.h"
 #include "r_clipper.h"
+#include "r_occlusion.h"
 #include "m_misc.h"
 #include "con_console.h"
 
@@ -247,6 +248,11 @@ void R_InitSprites(const char** namelist) {
 void R_AddSprites(subsector_t *sub) {
     mobj_t* thing;
 
+    // hidden behind nearer walls the last time it was tested
+    if(R_SubsectorOccluded(sub)) {
+        return;
+    }
+
     // Handle all things in sector.
     for(thing = sub->sector->thinglist; thing; thing = thing->snext) {
         if(thing->subsector != sub) { // don't add sprite if it doesn't belong in this subsector
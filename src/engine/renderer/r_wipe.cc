@@ -22,6 +22,11 @@
 //-----------------------------------------------------------------------------
 //
 // DESCRIPTION: Endlevel wipe FX.
+//    Starting a wipe only captures the screen. The effect itself is
+//    advanced one step per tic by WIPE_Ticker and drawn by WIPE_Drawer
+//    from D_MiniLoop, so input, network and sound keep being updated
+//    while it plays. The melt renders back and forth between two
+//    framebuffer textures instead of copying the screen every step.
 //
 //-----------------------------------------------------------------------------
 
@@ -35,56 +40,139 @@
 #include "m_random.h"
 #include "gl_texture.h"
 #include "doomstat.h"
+#include "gl_gputimer.h"
 
 void M_ClearMenus(void);    // from m_menu.c
 
-static dtexture wipeMeltTexture = 0;
-static int wipeFadeAlpha        = 0;
+#define MELTSTEPS       80
+
+typedef enum {
+    WIPE_NONE,
+    WIPE_MELT,
+    WIPE_FADE
+} wipestate_t;
+
+static wipestate_t wipeState    = WIPE_NONE;
+static dtexture wipeTextures[2] = { 0, 0 };
+static GLuint   wipeBuffers[2]  = { 0, 0 };
+static int      wipeCurrent     = 0;
+static int      wipeTexWidth    = 0;
+static int      wipeTexHeight   = 0;
+static int      wipeFadeAlpha   = 0;
+static int      wipeFadeTics    = 0;
+static int      wipeMeltStep    = 0;
+static float    wipeMeltOffset  = 0;
+static int      wipeLastTic     = 0;
+static void     (*wipeFinishFunc)(void) = NULL;
 
 //
-// WIPE_DisplayScreen
+// WIPE_CreateTexture
 //
 
-static void WIPE_RefreshDelay(void) {
-    int starttime = I_GetTime();
-    int tics = 0;
+static void WIPE_CreateTexture(dtexture *tex) {
+    dglGenTextures(1, tex);
+    dglBindTexture(GL_TEXTURE_2D, *tex);
 
-    do {
-        tics = I_GetTime() - starttime;
-        //
-        // don't bash the CPU
-        //
-        I_Sleep(1);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, DGL_CLAMP);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, DGL_CLAMP);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    dglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    dglTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, wipeTexWidth, wipeTexHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+}
+
+//
+// WIPE_FreeBuffers
+//
+
+static void WIPE_FreeBuffers(void) {
+    if(wipeBuffers[0]) {
+        dglDeleteFramebuffersEXT(2, wipeBuffers);
+        wipeBuffers[0] = wipeBuffers[1] = 0;
     }
-    while(!tics);
+
+    GL_UnloadTexture(&wipeTextures[0]);
+    GL_UnloadTexture(&wipeTextures[1]);
+    GL_ResetTextures();
 }
 
 //
-// WIPE_FadeScreen
+// WIPE_CaptureScreen
 //
 
-void WIPE_FadeScreen(int fadetics) {
-    int padw, padh;
-    vtx_t v[4];
-    float left, right, top, bottom;
+static void WIPE_CaptureScreen(void) {
+    if(GLAD_GL_ARB_texture_non_power_of_two) {
+        wipeTexWidth = video_width;
+        wipeTexHeight = video_height;
+    }
+    else {
+        wipeTexWidth = GL_PadTextureDims(video_width);
+        wipeTexHeight = GL_PadTextureDims(video_height);
+    }
 
-    allowmenu = false;
+    GL_SetTextureUnit(0, true);
+    WIPE_CreateTexture(&wipeTextures[0]);
+    dglCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, video_width, video_height);
+    GL_ResetTextures();
 
-    wipeFadeAlpha = 0xff;
-    wipeMeltTexture = GL_ScreenToTexture();
+    wipeCurrent = 0;
+}
 
-    padw = GL_PadTextureDims(video_width);
-    padh = GL_PadTextureDims(video_height);
+//
+// WIPE_InitMeltBuffers
+// The melt draws the previous step into the next one,
+// which needs a second texture to draw into
+//
 
-    GL_SetState(GLSTATE_BLEND, 1);
-    dglEnable(GL_TEXTURE_2D);
+static dboolean WIPE_InitMeltBuffers(void) {
+    GLint prevfbo;
+    GLenum status = GL_FRAMEBUFFER_COMPLETE_EXT;
+    int i;
+
+    if(!GLAD_GL_EXT_framebuffer_object) {
+        return false;
+    }
+
+    WIPE_CreateTexture(&wipeTextures[1]);
+    GL_ResetTextures();
+
+    dglGenFramebuffersEXT(2, wipeBuffers);
+    dglGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prevfbo);
+
+    for(i = 0; i < 2 && status == GL_FRAMEBUFFER_COMPLETE_EXT; i++) {
+        dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, wipeBuffers[i]);
+        dglFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT,
+                                   GL_TEXTURE_2D, wipeTextures[i], 0);
+        status = dglCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+    }
+
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prevfbo);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+        dglDeleteFramebuffersEXT(2, wipeBuffers);
+        wipeBuffers[0] = wipeBuffers[1] = 0;
+        GL_UnloadTexture(&wipeTextures[1]);
+        return false;
+    }
+
+    return true;
+}
+
+//
+// WIPE_DrawScreen
+// Draws the captured screen, moved down by offset
+//
+
+static void WIPE_DrawScreen(float offset, rcolor color) {
+    vtx_t v[4];
+    float left, right, top, bottom;
 
     //
     // setup vertex coordinates for plane
     //
     left = (float)(ViewWindowX * ViewWidth / video_width);
     right = left + (SCREENWIDTH * ViewWidth / video_width);
-    top = (float)(ViewWindowY * ViewHeight / video_height);
+    top = (float)(ViewWindowY * ViewHeight / video_height) + offset;
     bottom = top + (SCREENHEIGHT * ViewHeight / video_height);
 
     v[0].x = v[2].x = left;
@@ -95,144 +183,202 @@ void WIPE_FadeScreen(int fadetics) {
     v[0].z = v[1].z = v[2].z = v[3].z = 0.0f;
 
     v[0].tu = v[2].tu = 0.0f;
-    v[1].tu = v[3].tu = (float)video_width / (float)padw;
-    v[0].tv = v[1].tv = (float)video_height / (float)padh;
+    v[1].tu = v[3].tu = (float)video_width / (float)wipeTexWidth;
+    v[0].tv = v[1].tv = (float)video_height / (float)wipeTexHeight;
     v[2].tv = v[3].tv = 0.0f;
 
-    dglBindTexture(GL_TEXTURE_2D, wipeMeltTexture);
+    dglBindTexture(GL_TEXTURE_2D, wipeTextures[wipeCurrent]);
+    dglSetVertexColor(v, color, 4);
+    GL_Draw2DQuad(v, 1);
+}
+
+//
+// WIPE_MeltStep
+//
+
+static void WIPE_MeltStep(void) {
+    GLint prevfbo;
+
+    dglGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &prevfbo);
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, wipeBuffers[wipeCurrent ^ 1]);
+
+    GL_ClearView(0xFF000000);
+    GL_SetTextureUnit(0, true);
+    GL_SetState(GLSTATE_BLEND, 1);
+    GL_SetTextureMode(GL_ADD);
+
+    WIPE_DrawScreen(0.0f, D_RGBA(1, 0, 0, 0xff));
 
     //
-    // begin fade out
+    // move screen down. without clearing the frame, we should
+    // get a nice melt effect using the HOM effect
     //
-    while(wipeFadeAlpha > 0) {
-        rcolor color;
+    WIPE_DrawScreen(wipeMeltOffset, D_RGBA(0, 0, 0, 0x10));
+
+    GL_SetTextureMode(GL_MODULATE);
+    GL_SetDefaultCombiner();
+    GL_SetState(GLSTATE_BLEND, 0);
+    GL_ResetTextures();
 
-        //
-        // clear frame
-        //
-        GL_ClearView(0xFF000000);
+    dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, prevfbo);
 
-        if(wipeFadeAlpha < 0) {
-            wipeFadeAlpha = 0;
-        }
+    wipeCurrent ^= 1;
+    wipeMeltOffset += 0.5f;
+}
 
-        //
-        // display screen overlay
-        //
-        color = D_RGBA(wipeFadeAlpha, wipeFadeAlpha, wipeFadeAlpha, 0xff);
+//
+// WIPE_Finish
+//
 
-        dglSetVertexColor(v, color, 4);
-        GL_Draw2DQuad(v, 1);
+static void WIPE_Finish(void) {
+    void (*func)(void) = wipeFinishFunc;
 
-        GL_SwapBuffers();
+    wipeState = WIPE_NONE;
+    WIPE_FreeBuffers();
 
-        WIPE_RefreshDelay();
+    allowmenu = true;
 
-        wipeFadeAlpha -= fadetics;
+    if(func) {
+        wipeFinishFunc = NULL;
+        func();
     }
+}
 
-    GL_SetState(GLSTATE_BLEND, 0);
-    GL_UnloadTexture(&wipeMeltTexture);
+//
+// WIPE_FadeScreen
+//
 
-    allowmenu = true;
+void WIPE_FadeScreen(int fadetics) {
+    // nothing to fade without a display
+    if(!usingGL) {
+        return;
+    }
+
+    allowmenu = false;
+
+    // a wipe that is still running is captured as it is now
+    WIPE_FreeBuffers();
+    WIPE_CaptureScreen();
+
+    wipeState = WIPE_FADE;
+    wipeFadeAlpha = 0xff;
+    wipeFadeTics = MAX(fadetics, 1);
+    wipeLastTic = I_GetTime();
 }
 
 //
 // WIPE_MeltScreen
+// Fades out once the melt is done. Without framebuffer
+// objects the screen only fades.
 //
 
 void WIPE_MeltScreen(void) {
-    int padw, padh;
-    vtx_t v[4];
-    vtx_t v2[4];
-    float left, right, top, bottom;
-    int i = 0;
+    if(!usingGL) {
+        return;
+    }
 
     M_ClearMenus();
-    allowmenu = false;
+    WIPE_FadeScreen(6);
 
-    wipeMeltTexture = GL_ScreenToTexture();
+    if(WIPE_InitMeltBuffers()) {
+        wipeState = WIPE_MELT;
+        wipeMeltStep = 0;
+        wipeMeltOffset = 0.0f;
+    }
+}
 
-    padw = GL_PadTextureDims(video_width);
-    padh = GL_PadTextureDims(video_height);
+//
+// WIPE_OnFinish
+// Calls func once the current wipe has played out,
+// or right away if there is none
+//
 
-    GL_SetState(GLSTATE_BLEND, 1);
-    dglEnable(GL_TEXTURE_2D);
+void WIPE_OnFinish(void (*func)(void)) {
+    if(wipeState == WIPE_NONE) {
+        func();
+        return;
+    }
 
-    //
-    // setup vertex coordinates for plane
-    //
-    left = (float)(ViewWindowX * ViewWidth / video_width);
-    right = left + (SCREENWIDTH * ViewWidth / video_width);
-    top = (float)(ViewWindowY * ViewHeight / video_height);
-    bottom = top + (SCREENHEIGHT * ViewHeight / video_height);
+    if(wipeFinishFunc && wipeFinishFunc != func) {
+        wipeFinishFunc();
+    }
 
-    v[0].x = v[2].x = left;
-    v[1].x = v[3].x = right;
-    v[0].y = v[1].y = top;
-    v[2].y = v[3].y = bottom;
+    wipeFinishFunc = func;
+}
 
-    v[0].z = v[1].z = v[2].z = v[3].z = 0.0f;
+//
+// WIPE_Active
+//
 
-    v[0].tu = v[2].tu = 0.0f;
-    v[1].tu = v[3].tu = (float)video_width / (float)padw;
-    v[0].tv = v[1].tv = (float)video_height / (float)padh;
-    v[2].tv = v[3].tv = 0.0f;
+dboolean WIPE_Active(void) {
+    return wipeState != WIPE_NONE;
+}
+
+//
+// WIPE_Ticker
+// Advances the wipe by one step every tic.
+// Returns true if anything changed.
+//
 
-    dmemcpy(v2, v, sizeof(vtx_t) * 4);
+dboolean WIPE_Ticker(void) {
+    int tic;
 
-    dglBindTexture(GL_TEXTURE_2D, wipeMeltTexture);
-    GL_SetTextureMode(GL_ADD);
+    if(wipeState == WIPE_NONE) {
+        return false;
+    }
+
+    tic = I_GetTime();
 
-    for(i = 0; i < 160; i += 2) {
-        int j;
+    if(tic == wipeLastTic) {
+        return false;
+    }
 
-        GL_ClearView(0xFF000000);
+    wipeLastTic = tic;
 
-        dglSetVertexColor(v2, D_RGBA(1, 0, 0, 0xff), 4);
-        GL_Draw2DQuad(v2, 1);
+    if(wipeState == WIPE_MELT) {
+        GL_BeginGPUPass(GPU_WIPE);
+        WIPE_MeltStep();
+        GL_EndGPUPass();
 
-        dglSetVertexColor(v, D_RGBA(0, 0, 0, 0x10), 4);
-        GL_Draw2DQuad(v, 1);
+        if(++wipeMeltStep >= MELTSTEPS) {
+            wipeState = WIPE_FADE;
+        }
+    }
+    else {
+        wipeFadeAlpha -= wipeFadeTics;
 
-        //
-        // move screen down. without clearing the frame, we should
-        // get a nice melt effect using the HOM effect
-        //
-        for(j = 0; j < 4; j++) {
-            v[j].y += 0.5f;
+        if(wipeFadeAlpha <= 0) {
+            WIPE_Finish();
         }
+    }
+
+    return true;
+}
+
+//
+// WIPE_Drawer
+//
+
+void WIPE_Drawer(void) {
+    rcolor color = WHITE;
 
-        //
-        // update screen buffer
-        //
-        dglCopyTexSubImage2D(
-            GL_TEXTURE_2D,
-            0,
-            0,
-            0,
-            0,
-            0,
-            padw,
-            padh
-        );
+    if(wipeState == WIPE_NONE) {
+        return;
+    }
 
-        GL_SwapBuffers();
+    GL_BeginGPUPass(GPU_WIPE);
+    GL_ClearView(0xFF000000);
 
-        WIPE_RefreshDelay();
+    if(wipeState == WIPE_FADE) {
+        color = D_RGBA(wipeFadeAlpha, wipeFadeAlpha, wipeFadeAlpha, 0xff);
     }
 
-    //
-    // reset combiners and blending
-    //
-    GL_SetTextureMode(GL_MODULATE);
-    GL_SetDefaultCombiner();
-    GL_SetState(GLSTATE_BLEND, 0);
-    GL_UnloadTexture(&wipeMeltTexture);
+    GL_SetTextureUnit(0, true);
+    GL_SetState(GLSTATE_BLEND, 1);
 
-    //
-    // fade screen out
-    //
-    WIPE_FadeScreen(6);
-}
+    WIPE_DrawScreen(0.0f, color);
 
+    GL_SetState(GLSTATE_BLEND, 0);
+    GL_ResetTextures();
+    GL_EndGPUPass();
+}
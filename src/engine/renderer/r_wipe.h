@@ -24,7 +24,13 @@
 #ifndef D3DF_WIPE_H
 #define D3DF_WIPE_H
 
+#include "doomtype.h"
+
 void WIPE_FadeScreen(int fadetics);
 void WIPE_MeltScreen(void);
+dboolean WIPE_Active(void);
+dboolean WIPE_Ticker(void);
+void WIPE_Drawer(void);
+void WIPE_OnFinish(void (*func)(void));
 
 #endif
\ No newline at end of file
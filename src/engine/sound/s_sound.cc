@@ -43,6 +43,8 @@
 #include "p_setup.h"
 #include "i_audio.h"
 #include "con_console.h"
+#include "g_simdemo.h"
+#include "m_profile.h"
 
 // Adjustable by menu.
 #define NORM_VOLUME     127
@@ -120,6 +122,10 @@ void S_Init(void) {
         CON_DPrintf("Music disabled\n");
     }
 
+    if(simdemo) {
+        nosound = nomusic = true;
+    }
+
     if(nosound && nomusic) {
         return;
     }
@@ -186,8 +192,6 @@ void S_StopMusic(void) {
 //
 
 void S_ResetSound(void) {
-    int i;
-
     if(nosound && nomusic) {
         return;
     }
@@ -196,6 +200,21 @@ void S_ResetSound(void) {
 
     // villsa 12282013 - make sure we clear all sound sources
     // during level transition
+    S_RemoveSoundSources();
+}
+
+//
+// S_RemoveSoundSources
+// Sounds keep playing but no longer follow their source
+//
+
+void S_RemoveSoundSources(void) {
+    int i;
+
+    if(nosound && nomusic) {
+        return;
+    }
+
     for(i = 0; i < I_GetMaxChannels(); i++) {
         I_RemoveSoundSource(i);
     }
@@ -265,6 +284,7 @@ void S_RemoveOrigin(mobj_t* origin) {
 //
 
 void S_UpdateSounds(void) {
+    PROFILE_ZONE("S_UpdateSounds");
     int     i;
     int     audible;
     int     volume;
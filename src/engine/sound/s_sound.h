@@ -45,6 +45,7 @@ void S_SetMusicVolume(float volume);
 void S_SetGainOutput(float db);
 
 void S_ResetSound(void);
+void S_RemoveSoundSources(void);
 void S_PauseSound(void);
 void S_ResumeSound(void);
 
@@ -0,0 +1,336 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+// 02111-1307, USA.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Video backends that don't need a window.
+//    "egl" creates an OpenGL context without a display server (Mesa's
+//    surfaceless platform, which runs on llvmpipe when there is no GPU)
+//    and renders into a framebuffer object. "null" has no OpenGL at
+//    all and nothing is drawn. Neither reads any input.
+//
+//-----------------------------------------------------------------------------
+
+#include "system/ivideo.hh"
+#include "config.hh"
+#include "doomdef.h"
+#include "m_misc.h"
+#include "opengl/gl_main.h"
+#include "opengl/dgl.h"
+#include "renderer/r_main.h"
+
+#ifdef USE_EGL
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+extern int video_width;
+extern int video_height;
+extern float video_ratio;
+
+namespace {
+  constexpr int s_default_width = 1280;
+  constexpr int s_default_height = 720;
+
+  /**
+   * Size from -width and -height, or a fixed default so that benchmark runs
+   * don't depend on the desktop resolution.
+   */
+  VideoMode s_headless_mode()
+  {
+      VideoMode mode { s_default_width, s_default_height };
+      int p;
+
+      if ((p = M_CheckParm("-width")) && p < myargc - 1)
+          mode.width = std::max(datoi(myargv[p + 1]), 320);
+
+      if ((p = M_CheckParm("-height")) && p < myargc - 1)
+          mode.height = std::max(datoi(myargv[p + 1]), 240);
+
+      return mode;
+  }
+
+  class NullVideo : public IVideo {
+  protected:
+      VideoMode m_mode;
+      Vector<VideoMode> m_modes {};
+
+  public:
+      NullVideo()
+      {
+          set_mode(s_headless_mode());
+      }
+
+      void set_mode(const VideoMode& mode) override
+      {
+          m_mode = mode;
+          m_mode.fullscreen = Fullscreen::none;
+          m_modes = { m_mode };
+
+          video_width = m_mode.width;
+          video_height = m_mode.height;
+          video_ratio = static_cast<float>(video_width) / video_height;
+          ViewWidth = video_width;
+          ViewHeight = video_height;
+      }
+
+      void set_vsync(bool) override
+      {}
+
+      VideoMode current_mode() override
+      { return m_mode; }
+
+      ArrayView<VideoMode> modes() override
+      { return m_modes; }
+
+      void grab(bool) override
+      {}
+
+      void begin_frame() override
+      {}
+
+      void end_frame() override
+      {}
+
+      bool have_controller() override
+      { return false; }
+
+      bool has_opengl() override
+      { return false; }
+
+      void* gl_proc_address(const char*) override
+      { return nullptr; }
+  };
+
+#ifdef USE_EGL
+  class EglVideo : public NullVideo {
+      EGLDisplay m_display { EGL_NO_DISPLAY };
+      EGLContext m_context { EGL_NO_CONTEXT };
+      EGLSurface m_surface { EGL_NO_SURFACE };
+      GLuint m_fbo {};
+      GLuint m_color {};
+      GLuint m_depth {};
+
+      void m_init_display();
+      void m_init_fbo();
+
+  public:
+      EglVideo();
+      ~EglVideo();
+
+      void set_mode(const VideoMode& mode) override;
+
+      void end_frame() override;
+
+      bool has_opengl() override
+      { return true; }
+
+      void* gl_proc_address(const char* name) override
+      { return reinterpret_cast<void*>(eglGetProcAddress(name)); }
+
+      void init_gl() override;
+  };
+
+  //
+  // EglVideo::m_init_display
+  //
+  void EglVideo::m_init_display()
+  {
+      auto client_exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+      // Mesa's surfaceless platform doesn't need X11, Wayland or a GPU
+      if (client_exts && strstr(client_exts, "EGL_MESA_platform_surfaceless")) {
+          auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+              eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+          if (get_platform_display)
+              m_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      }
+
+      if (m_display == EGL_NO_DISPLAY)
+          m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+      EGLint major, minor;
+      if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor)) {
+          throw std::runtime_error { fmt::format("Couldn't initialize EGL: 0x{:x}", eglGetError()) };
+      }
+
+      log::info("EGL {}.{}: {}", major, minor, eglQueryString(m_display, EGL_VENDOR));
+  }
+
+  //
+  // EglVideo::EglVideo
+  //
+  EglVideo::EglVideo()
+  {
+      m_init_display();
+
+      if (!eglBindAPI(EGL_OPENGL_API)) {
+          throw std::runtime_error { "EGL doesn't support desktop OpenGL" };
+      }
+
+      const EGLint pbuffer_attribs[] = {
+          EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+          EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+          EGL_NONE
+      };
+
+      const EGLint surfaceless_attribs[] = {
+          EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+          EGL_NONE
+      };
+
+      // Everything is drawn into our own framebuffer, so the surface only
+      // exists to make the context current where surfaceless isn't supported
+      EGLConfig config;
+      EGLint num_configs = 0;
+      bool have_pbuffer = eglChooseConfig(m_display, pbuffer_attribs, &config, 1, &num_configs) && num_configs > 0;
+
+      if (!have_pbuffer) {
+          if (!eglChooseConfig(m_display, surfaceless_attribs, &config, 1, &num_configs) || num_configs < 1) {
+              throw std::runtime_error { "No usable EGL config" };
+          }
+      }
+
+      m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, nullptr);
+      if (m_context == EGL_NO_CONTEXT) {
+          throw std::runtime_error { fmt::format("Couldn't create OpenGL Context: 0x{:x}", eglGetError()) };
+      }
+
+      if (have_pbuffer) {
+          const EGLint surface_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+          m_surface = eglCreatePbufferSurface(m_display, config, surface_attribs);
+      }
+
+      if (!eglMakeCurrent(m_display, m_surface, m_surface, m_context)) {
+          throw std::runtime_error { fmt::format("Couldn't make OpenGL Context current: 0x{:x}", eglGetError()) };
+      }
+  }
+
+  //
+  // EglVideo::~EglVideo
+  //
+  EglVideo::~EglVideo()
+  {
+      eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+      if (m_surface != EGL_NO_SURFACE)
+          eglDestroySurface(m_display, m_surface);
+
+      if (m_context != EGL_NO_CONTEXT)
+          eglDestroyContext(m_display, m_context);
+
+      eglTerminate(m_display);
+  }
+
+  //
+  // EglVideo::m_init_fbo
+  //
+  void EglVideo::m_init_fbo()
+  {
+      if (!m_fbo) {
+          dglGenFramebuffersEXT(1, &m_fbo);
+          dglGenRenderbuffersEXT(1, &m_color);
+          dglGenRenderbuffersEXT(1, &m_depth);
+      }
+
+      dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, m_color);
+      dglRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, video_width, video_height);
+      dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, m_depth);
+      dglRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, video_width, video_height);
+      dglBindRenderbufferEXT(GL_RENDERBUFFER_EXT, 0);
+
+      dglBindFramebufferEXT(GL_FRAMEBUFFER_EXT, m_fbo);
+      dglFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, m_color);
+      dglFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, m_depth);
+
+      auto status = dglCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+      if (status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+          throw std::runtime_error { fmt::format("Framebuffer is incomplete: 0x{:x}", status) };
+      }
+
+      // the framebuffer stands in for the window, so it stays bound
+      dglReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+      dglDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+
+      log::info("Rendering offscreen at {}x{}", video_width, video_height);
+  }
+
+  //
+  // EglVideo::init_gl
+  //
+  void EglVideo::init_gl()
+  {
+      if (!GLAD_GL_EXT_framebuffer_object) {
+          throw std::runtime_error { "Headless rendering needs GL_EXT_framebuffer_object" };
+      }
+
+      m_init_fbo();
+  }
+
+  //
+  // EglVideo::set_mode
+  //
+  void EglVideo::set_mode(const VideoMode& mode)
+  {
+      NullVideo::set_mode(mode);
+
+      if (m_fbo) {
+          m_init_fbo();
+          dglViewport(0, 0, video_width, video_height);
+          GL_CalcViewSize();
+          R_SetViewMatrix();
+      }
+  }
+
+  //
+  // EglVideo::end_frame
+  //
+  void EglVideo::end_frame()
+  {
+      // there is no swap to wait on, so make sure the frame actually finished
+      dglFinish();
+  }
+#endif
+}
+
+//
+// imp_init_headless
+//
+IVideo* imp_init_headless(const char* backend)
+{
+#ifdef USE_EGL
+    if (!backend || !strcmp(backend, "egl")) {
+        return new EglVideo;
+    }
+#else
+    if (!backend) {
+        backend = "null";
+    }
+#endif
+
+    if (!strcmp(backend, "null")) {
+        log::info("Using the null video backend, nothing will be drawn");
+        return new NullVideo;
+    }
+
+    throw std::runtime_error { fmt::format("Unknown headless video backend '{}'", backend) };
+}
@@ -44,6 +44,7 @@
 #include "platform/app.hh"
 #include "wad.hh"
 #include "core/cvar.hh"
+#include "m_profile.h"
 
 #include "SDL.h"
 
@@ -1137,6 +1138,8 @@ static int SDLCALL Thread_PlayerHandler(void *param) {
     dword count = 0;
     signalhandler signal;
 
+    M_ProfileThreadName("SynthPlayer");
+
     while(1) {
         //
         // check status of the sequencer
@@ -1161,7 +1164,10 @@ static int SDLCALL Thread_PlayerHandler(void *param) {
         //
         // play some songs
         //
-        Seq_RunSong(seq, SDL_GetTicks() - start);
+        {
+            PROFILE_ZONE("Seq_RunSong");
+            Seq_RunSong(seq, SDL_GetTicks() - start);
+        }
         count++;
 
         // try to avoid incremental time de-syncs
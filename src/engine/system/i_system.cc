@@ -27,6 +27,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -47,12 +48,15 @@
 #include "i_system.h"
 #include "i_audio.h"
 #include "gl_draw.h"
+#include "r_bench.h"
 
 #include "SDL.h"
 
 cvar::FloatVar i_gamma = 0.0;
 cvar::FloatVar i_brightness = 100.0;
 cvar::BoolVar i_interpolateframes = true;
+cvar::IntVar i_maxfps = 0;
+cvar::BoolVar i_renderahead = false;
 cvar::StringVar s_soundfont = ""s;
 
 namespace {
@@ -65,6 +69,13 @@ namespace {
       return duration_cast<milliseconds>(now - s_program_start).count();
 
   }
+
+  uint64 s_get_usecs()
+  {
+      using namespace std::chrono;
+      auto now = steady_clock::now();
+      return duration_cast<microseconds>(now - s_program_start).count();
+  }
 }
 
 static int basetime = 0;
@@ -94,6 +105,55 @@ static int I_GetTimeNormal(void)
     return (ticks * TICRATE) / 1000;
 }
 
+//
+// TIMEDEMO CLOCK
+// While a timedemo runs, game time only advances when a frame
+// has been drawn, so every recorded tic gets rendered no matter
+// how fast or slow the machine is. Only I_GetTime and
+// I_GetTimeFrac follow it, I_GetTimeMS stays on the real clock.
+//
+
+static int timedemoframes = 0;     // frames per tic, 0 when disabled
+static int timedemoclock;          // frames drawn since enabled
+static int timedemobase;           // tic the clock started at
+
+//
+// I_GetTimeDemo
+//
+
+static int I_GetTimeDemo(void)
+{
+    return timedemobase + timedemoclock / timedemoframes;
+}
+
+//
+// I_SetTimeDemo
+//
+
+void I_SetTimeDemo(int framespertic)
+{
+    if (framespertic > 0) {
+        timedemobase = I_GetTime();
+        timedemoclock = 0;
+        timedemoframes = framespertic;
+        I_GetTime = I_GetTimeDemo;
+    } else if (timedemoframes) {
+        timedemoframes = 0;
+        I_GetTime = I_GetTimeNormal;
+    }
+}
+
+//
+// I_TimeDemoFrame
+//
+
+void I_TimeDemoFrame(void)
+{
+    if (timedemoframes) {
+        timedemoclock++;
+    }
+}
+
 //
 // I_GetTime_Error
 //
@@ -117,8 +177,8 @@ void I_InitClockRate(void)
 // FRAME INTERPOLTATION
 //
 
-static unsigned int start_displaytime;
-static unsigned int displaytime;
+static uint64 start_displaytime;
+static uint64 displaytime;
 static dboolean InDisplay = false;
 
 dboolean realframe = false;
@@ -129,19 +189,111 @@ unsigned int rendertic_step;
 unsigned int rendertic_next;
 const float rendertic_msec = 100 * TICRATE / 100000.0f;
 
+//
+// FRAME PACING
+// With i_MaxFPS set, frames are started so they finish on a fixed
+// schedule. Waiting is done by sleeping until shortly before the
+// deadline and spinning the rest of the way; the spin window follows
+// how late the OS tends to wake us up, so it stays small on systems
+// with fine grained timers.
+//
+
+#define FRAMESTATS          128
+#define MINSPINUSECS        100
+#define MAXSPINUSECS        4000
+
+static uint64 framedeadline;            // when the next frame should be done
+static uint64 lastframeend;
+static float rendercost;                // smoothed time to draw a frame, usecs
+static float sleepovershoot = 1000;     // smoothed lateness of sleeps, usecs
+static float frameintervals[FRAMESTATS];
+static int numframeintervals;
+static int frameintervalhead;
+
+//
+// I_RenderAhead
+// How long before presenting the next frame it has to be started
+//
+
+static uint64 I_RenderAhead(void)
+{
+    if (i_renderahead) {
+        return (uint64) rendercost;
+    }
+
+    return displaytime;
+}
+
+//
+// I_WaitUntil
+//
+
+static void I_WaitUntil(uint64 deadline)
+{
+    uint64 now = s_get_usecs();
+    uint64 spin = (uint64) MAX(MIN(sleepovershoot + MINSPINUSECS, (float) MAXSPINUSECS), (float) MINSPINUSECS);
+
+    if (deadline > now + spin) {
+        uint64 request = deadline - now - spin;
+        uint64 slept;
+
+        I_Sleep((int) request);
+
+        slept = s_get_usecs() - now;
+        if (slept > request) {
+            sleepovershoot = sleepovershoot * 0.9f + (float) (slept - request) * 0.1f;
+        }
+    }
+
+    while (s_get_usecs() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+//
+// I_WaitFrame
+// Called while D_MiniLoop waits for the next tic
+//
+
+void I_WaitFrame(void)
+{
+    uint64 wake;
+    uint64 nexttic;
+
+    if (*i_maxfps <= 0 || timedemoframes || !*i_interpolateframes) {
+        I_Sleep(1);
+        return;
+    }
+
+    // don't sleep through the next tic either
+    nexttic = ((uint64) basetime * 1000) + ((uint64) (I_GetTime() + 1) * 1000000 / TICRATE);
+    wake = framedeadline - MIN(I_RenderAhead(), framedeadline);
+    wake = MIN(wake, nexttic);
+
+    I_WaitUntil(wake);
+}
+
 //
 // I_StartDisplay
 //
 
 dboolean I_StartDisplay(void)
 {
+    uint64 now;
+
     rendertic_frac = I_GetTimeFrac();
 
     if (InDisplay) {
         return false;
     }
 
-    start_displaytime = s_get_ticks();
+    now = s_get_usecs();
+
+    if (*i_maxfps > 0 && !timedemoframes && now + I_RenderAhead() < framedeadline) {
+        return false;
+    }
+
+    start_displaytime = now;
     InDisplay = true;
 
     return true;
@@ -153,8 +305,61 @@ dboolean I_StartDisplay(void)
 
 void I_EndDisplay(void)
 {
-    displaytime = s_get_ticks() - start_displaytime;
+    uint64 now = s_get_usecs();
+
+    displaytime = now - start_displaytime;
+    rendercost = rendercost ? rendercost * 0.9f + (float) displaytime * 0.1f : (float) displaytime;
     InDisplay = false;
+
+    if (*i_maxfps > 0) {
+        uint64 period = 1000000 / MIN(*i_maxfps, 1000);
+
+        // too far behind to catch up, start over from now
+        if (framedeadline + period < now) {
+            framedeadline = now;
+        }
+
+        framedeadline += period;
+    }
+
+    if (lastframeend) {
+        frameintervals[frameintervalhead] = (float) (now - lastframeend) / 1000.0f;
+        frameintervalhead = (frameintervalhead + 1) % FRAMESTATS;
+        numframeintervals = MIN(numframeintervals + 1, FRAMESTATS);
+    }
+
+    lastframeend = now;
+}
+
+//
+// I_GetFrameStats
+// Mean and standard deviation of recent frame times in ms
+//
+
+void I_GetFrameStats(float *mean, float *stddev)
+{
+    double sum = 0;
+    double sqsum = 0;
+    int i;
+
+    *mean = *stddev = 0;
+
+    if (!numframeintervals) {
+        return;
+    }
+
+    for (i = 0; i < numframeintervals; i++) {
+        sum += frameintervals[i];
+    }
+
+    *mean = (float) (sum / numframeintervals);
+
+    for (i = 0; i < numframeintervals; i++) {
+        double d = frameintervals[i] - *mean;
+        sqsum += d * d;
+    }
+
+    *stddev = (float) sqrt(sqsum / numframeintervals);
 }
 
 //
@@ -163,15 +368,20 @@ void I_EndDisplay(void)
 
 fixed_t I_GetTimeFrac(void)
 {
-    unsigned long now;
+    int64 now;
     fixed_t frac;
 
-    now = s_get_ticks();
+    if (timedemoframes) {
+        return ((timedemoclock % timedemoframes) + 1) * FRACUNIT / timedemoframes;
+    }
+
+    now = (int64) s_get_usecs();
 
     if (rendertic_step == 0) {
         return FRACUNIT;
     } else {
-        frac = (fixed_t) ((now - rendertic_start + displaytime) * FRACUNIT / rendertic_step);
+        // aim for the moment the frame will be shown
+        frac = (fixed_t) ((now - (int64) rendertic_start * 1000 + (int64) I_RenderAhead()) * FRACUNIT / ((int64) rendertic_step * 1000));
         if (frac < 0) {
             frac = 0;
         }
@@ -292,6 +502,8 @@ void I_Init(void)
         (i_gamma, "i_Gamma", "")
         (i_brightness, "i_Brightness", "Brightness")
         (i_interpolateframes, "i_InterpolateFrames", "TODO")
+        (i_maxfps, "i_MaxFPS", "Frame rate cap for interpolated frames (0 = uncapped)")
+        (i_renderahead, "i_RenderAhead", "Start frames early by the measured render time instead of the last frame's")
         (s_soundfont, "s_SoundFont", "Path to 'doomsnd.sf2'");
 
     i_gamma.set_callback([](const float &) {
@@ -321,6 +533,7 @@ void I_Quit(void)
     }
 
     M_SaveDefaults();
+    R_BenchStopRecording();
 
 #ifdef USESYSCONSOLE
     // I_DestroySysConsole();
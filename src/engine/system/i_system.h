@@ -60,8 +60,12 @@ int             I_GetTimeMS(void);
 void            I_Sleep(int usecs);
 dboolean        I_StartDisplay(void);
 void            I_EndDisplay(void);
+void            I_WaitFrame(void);
+void            I_GetFrameStats(float *mean, float *stddev);
 fixed_t         I_GetTimeFrac(void);
 void            I_GetTime_SaveMS(void);
+void            I_SetTimeDemo(int framespertic);
+void            I_TimeDemoFrame(void);
 unsigned long   I_GetRandomTimeSeed(void);
 
 // Asynchronous interrupt functions should maintain private queues
@@ -70,6 +70,23 @@ namespace imp {
        */
       virtual bool have_controller() = 0;
 
+      /**
+       * Does this backend have an OpenGL context?
+       */
+      virtual bool has_opengl()
+      { return true; }
+
+      /**
+       * Look up an OpenGL function in the backend's context
+       */
+      virtual void* gl_proc_address(const char* name) = 0;
+
+      /**
+       * Called by GL_Init once the OpenGL functions have been loaded.
+       */
+      virtual void init_gl()
+      {}
+
       bool is_windowed()
       { return current_mode().fullscreen == Fullscreen::none; }
   };
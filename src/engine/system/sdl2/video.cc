@@ -5,6 +5,8 @@
 #include "doom_main/d_main.h"
 #include "common/doomstat.h"
 #include "renderer/r_main.h"
+#include "game/g_simdemo.h"
+#include "misc/m_misc.h"
 
 #include "sdl2_private.hh"
 
@@ -78,6 +80,9 @@ namespace {
       void end_frame() override;
       bool have_controller() override;
 
+      void* gl_proc_address(const char* name) override
+      { return SDL_GL_GetProcAddress(name); }
+
       ArrayView<VideoMode> modes() override
       { return m_modes; }
   };
@@ -605,6 +610,8 @@ bool SdlVideo::have_controller()
     return s_controller;
 }
 
+IVideo* imp_init_headless(const char* backend);
+
 //
 // imp_init_sdl2
 //
@@ -630,7 +637,18 @@ void imp_init_sdl2()
         (i_rsticksensitivity, "i_RStickSensitivity", "")
         (i_rstickthreshold, "i_RStickThreshold", "");
 
-    Video = new SdlVideo { OpenGLVer::gl14 };
+    int p;
+
+    // the playsim benchmark never draws anything
+    if(simdemo) {
+        Video = imp_init_headless("null");
+    }
+    else if((p = M_CheckParm("-headless"))) {
+        Video = imp_init_headless(p < myargc - 1 && myargv[p + 1][0] != '-' ? myargv[p + 1] : nullptr);
+    }
+    else {
+        Video = new SdlVideo { OpenGLVer::gl14 };
+    }
 
     v_vsync.set_callback([](const bool& value){
         Video->set_vsync(value);
@@ -1,6 +1,7 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <mutex>
 #include "../idevice.hh"
 #include "../wad_loaders.hh"
 #include "map_lump.hh"
@@ -64,6 +65,7 @@ namespace {
 
   class DoomDevice : public IDevice {
       std::ifstream stream_;
+      std::mutex mutex_;
 
   public:
       DoomDevice(std::filesystem::path path):
@@ -156,6 +158,13 @@ namespace {
 
       std::istream& stream()
       { return stream_; }
+
+      /*!
+       * Guards the seek and read of a lump's directory range in the WAD
+       * file, which the texture streaming thread also reads from.
+       */
+      std::mutex& mutex()
+      { return mutex_; }
   };
 }
 
@@ -164,6 +173,7 @@ UniquePtr<std::istream> DoomLump::stream()
     auto iss = std::make_unique<std::istringstream>();
 
     if (info_.size) {
+        std::lock_guard<std::mutex> lock { device_.mutex() };
         auto& s = device_.stream();
         s.seekg(info_.filepos);
         String buff(info_.size, 0);
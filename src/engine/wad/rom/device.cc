@@ -1,6 +1,7 @@
 #include <fstream>
 #include <sstream>
 #include <utility>
+#include <mutex>
 #include <algorithm>
 #include <set>
 
@@ -104,6 +105,7 @@ namespace {
 
 class imp::wad::rom::Device : public IDevice {
     std::istringstream rom_ {};
+    std::mutex mutex_ {};
     WadHeader wad_header_ {};
     String palette_name {};
 
@@ -153,10 +155,10 @@ public:
             while (size < 8 && dir.name[size]) ++size;
             String name { dir.name, size };
 
-            // TODO: It'd be cool to actually be able to read and use the demo
-            // files
+            // Demos are raw controller input, G_PlayDemo converts them
             if (name.substr(0, 4) == "DEMO") {
-                log::debug("Ignoring lump '{}'", name);
+                Info lump_info { name, wad::Section::normal, lump_pos };
+                lumps.emplace_back(std::make_unique<NormalLump>(*this, lump_info));
                 continue;
             }
 
@@ -273,12 +275,15 @@ public:
     std::istringstream load(Info info)
     {
         std::istringstream iss, raw;
-        rom_.seekg(info.pos);
-
         WadDir dir;
-        read_into(rom_, dir);
 
         {
+            // rom_ is shared by every lump; decompression happens outside the lock
+            std::lock_guard<std::mutex> lock { mutex_ };
+
+            rom_.seekg(info.pos);
+            read_into(rom_, dir);
+
             String rawstr;
             rawstr.resize(dir.size);
             rom_.seekg(static_cast<std::streamoff>(dir.filepos));
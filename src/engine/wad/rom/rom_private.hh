@@ -24,6 +24,7 @@
 
 #include <string>
 #include <istream>
+#include <mutex>
 #include <sstream>
 
 #include "wad/wad.hh"
@@ -96,6 +97,7 @@ namespace imp {
           bool m_is_weapon;
           SpriteLump* m_palette_lump;
           SharedPtr<Palette> m_palette_ptr;
+          std::once_flag m_palette_once;
 
           SharedPtr<Palette> m_palette();
 
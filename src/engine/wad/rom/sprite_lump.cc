@@ -72,26 +72,25 @@ namespace {
 
 SharedPtr<Palette> SpriteLump::m_palette()
 {
-    if (m_palette_ptr) {
-        return m_palette_ptr;
-    }
-
     if (m_palette_lump) {
         return m_palette_lump->m_palette();
     }
 
-    auto s = p_stream();
-    auto header = read_header(s);
+    // Sprites are also decoded on the texture streaming threads
+    std::call_once(m_palette_once, [this] {
+        auto s = p_stream();
+        auto header = read_header(s);
 
-    assert(header.compressed < 0);
+        assert(header.compressed < 0);
 
-    /* Jump to palette, which comes after the bitmap */
-    auto image_size = pad<8>(header.width) * header.height;
+        /* Jump to palette, which comes after the bitmap */
+        auto image_size = pad<8>(header.width) * header.height;
 
-    s.seekg(image_size, s.cur);
+        s.seekg(image_size, s.cur);
 
-    auto palette = read_n64palette(s, 256);
-    m_palette_ptr = std::make_shared<Palette>(std::move(palette));
+        auto palette = read_n64palette(s, 256);
+        m_palette_ptr = std::make_shared<Palette>(std::move(palette));
+    });
 
     return m_palette_ptr;
 }
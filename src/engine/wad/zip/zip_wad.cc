@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <mutex>
 #include <zlib.h>
 
 #include "wad/idevice.hh"
@@ -160,6 +161,7 @@ namespace {
 
   class ZipDevice : public IDevice {
       std::ifstream stream_;
+      std::mutex mutex_;
       size_t central_dir_pos_ {};
 
   public:
@@ -230,6 +232,13 @@ namespace {
 
       std::istream& stream()
       { return stream_; }
+
+      /*!
+       * Held while an entry's local header is read and the entry is
+       * inflated from the archive, so two threads don't interleave seeks.
+       */
+      std::mutex& mutex()
+      { return mutex_; }
   };
 }
 
@@ -238,6 +247,7 @@ IDevice& ZipLump::device()
 
 UniquePtr<std::istream> ZipLump::stream()
 {
+        std::lock_guard<std::mutex> lock { device_.mutex() };
         auto& s = device_.stream();
 
         // Check file signature
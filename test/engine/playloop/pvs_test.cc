@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+#include <vector>
+
+#include "p_pvsbuild.h"
+
+namespace {
+    // A convex leaf, wound clockwise. solid[i] is the edge from v[i] to v[i + 1].
+    struct Leaf
+    {
+        std::vector<pvspoint_t> v;
+        std::vector<bool> solid;
+    };
+
+    class PvsMap
+    {
+        std::vector<Leaf> m_leafs;
+        std::vector<unsigned char> m_matrix;
+        int m_rowbytes {};
+
+    public:
+        void add(Leaf leaf)
+        {
+            m_leafs.push_back(std::move(leaf));
+        }
+
+        void build()
+        {
+            pvsleafs_t edges(m_leafs.size());
+
+            for (size_t i = 0; i < m_leafs.size(); i++)
+            {
+                const Leaf &leaf = m_leafs[i];
+
+                for (size_t j = 0; j < leaf.v.size(); j++)
+                {
+                    pvsedge_t edge;
+
+                    edge.p[0] = leaf.v[j];
+                    edge.p[1] = leaf.v[(j + 1) % leaf.v.size()];
+                    edge.solid = leaf.solid[j];
+                    edges[i].push_back(edge);
+                }
+            }
+
+            m_rowbytes = (int)(m_leafs.size() + 7) >> 3;
+            m_matrix.assign(m_leafs.size() * m_rowbytes, 0);
+
+            P_PVSMakePortals(edges);
+            P_PVSBuild(m_matrix.data(), m_rowbytes);
+            P_PVSFreePortals();
+        }
+
+        bool visible(int s1, int s2) const
+        {
+            return (m_matrix[s1 * m_rowbytes + (s2 >> 3)] & (1 << (s2 & 7))) != 0;
+        }
+
+        int size() const
+        {
+            return (int)m_leafs.size();
+        }
+
+        const std::vector<Leaf> &leafs() const
+        {
+            return m_leafs;
+        }
+    };
+
+    Leaf square(double x0, double y0, double x1, double y1, bool l, bool t, bool r, bool b)
+    {
+        return { { { x0, y0 }, { x0, y1 }, { x1, y1 }, { x1, y0 } }, { l, t, r, b } };
+    }
+
+    // 64x64 leafs at the given grid cells. Every edge not shared with
+    // another cell is a one-sided wall.
+    PvsMap grid(std::initializer_list<std::pair<int, int>> cells)
+    {
+        auto has_cell = [&](int x, int y) {
+            for (auto &c : cells)
+                if (c.first == x && c.second == y)
+                    return true;
+            return false;
+        };
+
+        PvsMap map;
+
+        for (auto &c : cells)
+        {
+            map.add(square(c.first * 64, c.second * 64, (c.first + 1) * 64, (c.second + 1) * 64,
+                           !has_cell(c.first - 1, c.second), !has_cell(c.first, c.second + 1),
+                           !has_cell(c.first + 1, c.second), !has_cell(c.first, c.second - 1)));
+        }
+
+        map.build();
+        return map;
+    }
+
+    // true if segment ab properly crosses segment cd
+    bool seg_cross(const pvspoint_t &a, const pvspoint_t &b, const pvspoint_t &c, const pvspoint_t &d)
+    {
+        auto cross = [](const pvspoint_t &o, const pvspoint_t &p, const pvspoint_t &q) {
+            return (p.x - o.x) * (q.y - o.y) - (p.y - o.y) * (q.x - o.x);
+        };
+        auto side = [](double v) {
+            return v > 0 ? 0 : (v < 0 ? 1 : 2);
+        };
+
+        return side(cross(a, b, c)) != side(cross(a, b, d)) &&
+               side(cross(c, d, a)) != side(cross(c, d, b));
+    }
+}
+
+TEST(PVS, staircase_visible)
+{
+    // (62,2) to (190,130) passes through all four portals, but only
+    // just: clipping against the separators of the first two must
+    // leave that line open
+    PvsMap map = grid({ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 2, 1 }, { 2, 2 } });
+
+    ASSERT_TRUE(map.visible(0, 4));
+    ASSERT_TRUE(map.visible(4, 0));
+
+    for (int i = 0; i < map.size(); i++)
+    {
+        for (int j = 0; j < map.size(); j++)
+        {
+            ASSERT_EQ(map.visible(i, j), map.visible(j, i));
+        }
+    }
+}
+
+TEST(PVS, corner_hidden)
+{
+    // a long leg then a long leg at right angles; no straight line
+    // gets from one end to the other
+    PvsMap map = grid({ { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 3, 1 }, { 3, 2 }, { 3, 3 } });
+
+    ASSERT_TRUE(map.visible(0, 3));
+    ASSERT_TRUE(map.visible(3, 6));
+    ASSERT_FALSE(map.visible(0, 6));
+    ASSERT_FALSE(map.visible(6, 0));
+}
+
+TEST(PVS, random_sight_lines)
+{
+    // Random grid maps with walls, diagonal splits and T-junctions. Any
+    // pair the PVS rejects must have no unobstructed line between them.
+    const int G = 8;
+    const double S = 64;
+
+    for (unsigned seed = 1; seed <= 8; seed++)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> U(0, 1);
+        bool hwall[G + 1][G];
+        bool vwall[G][G + 1];
+        PvsMap map;
+
+        // hwall[y][x] runs from (x,y) to (x+1,y), vwall[y][x] from (x,y) to (x,y+1)
+        for (int y = 0; y <= G; y++)
+            for (int x = 0; x < G; x++)
+                hwall[y][x] = y == 0 || y == G || U(rng) < 0.35;
+
+        for (int y = 0; y < G; y++)
+            for (int x = 0; x <= G; x++)
+                vwall[y][x] = x == 0 || x == G || U(rng) < 0.35;
+
+        for (int y = 0; y < G; y++)
+        {
+            for (int x = 0; x < G; x++)
+            {
+                double x0 = x * S, y0 = y * S, x1 = x0 + S, y1 = y0 + S, xm = x0 + S / 2;
+                bool l = vwall[y][x], t = hwall[y + 1][x], r = vwall[y][x + 1], b = hwall[y][x];
+
+                if (U(rng) < 0.2)
+                {
+                    map.add({ { { x0, y0 }, { x0, y1 }, { x1, y1 } }, { l, t, false } });
+                    map.add({ { { x0, y0 }, { x1, y1 }, { x1, y0 } }, { false, r, b } });
+                }
+                else if (U(rng) < 0.15)
+                {
+                    // the neighbours above and below see a T-junction
+                    map.add(square(x0, y0, xm, y1, l, t, false, b));
+                    map.add(square(xm, y0, x1, y1, false, t, r, b));
+                }
+                else
+                {
+                    map.add(square(x0, y0, x1, y1, l, t, r, b));
+                }
+            }
+        }
+
+        map.build();
+
+        std::vector<std::pair<pvspoint_t, pvspoint_t>> walls;
+        for (auto &leaf : map.leafs())
+            for (size_t j = 0; j < leaf.v.size(); j++)
+                if (leaf.solid[j])
+                    walls.emplace_back(leaf.v[j], leaf.v[(j + 1) % leaf.v.size()]);
+
+        // a random point inside the leaf, pulled 1% towards its center
+        // so it never sits exactly on a wall
+        auto random_point = [&](const Leaf &leaf) {
+            pvspoint_t p { 0, 0 }, c { 0, 0 };
+            std::vector<double> w(leaf.v.size());
+            double sum = 0;
+
+            for (auto &x : w)
+                sum += (x = pow(U(rng), 4));
+
+            for (size_t j = 0; j < leaf.v.size(); j++)
+            {
+                p.x += w[j] / sum * leaf.v[j].x;
+                p.y += w[j] / sum * leaf.v[j].y;
+                c.x += leaf.v[j].x / leaf.v.size();
+                c.y += leaf.v[j].y / leaf.v.size();
+            }
+
+            p.x += (c.x - p.x) * 0.01;
+            p.y += (c.y - p.y) * 0.01;
+            return p;
+        };
+
+        for (int s1 = 0; s1 < map.size(); s1++)
+        {
+            for (int s2 = 0; s2 < map.size(); s2++)
+            {
+                if (map.visible(s1, s2))
+                    continue;
+
+                for (int k = 0; k < 60; k++)
+                {
+                    pvspoint_t a = random_point(map.leafs()[s1]);
+                    pvspoint_t b = random_point(map.leafs()[s2]);
+                    bool blocked = false;
+
+                    for (auto &w : walls)
+                    {
+                        if (seg_cross(a, b, w.first, w.second))
+                        {
+                            blocked = true;
+                            break;
+                        }
+                    }
+
+                    ASSERT_TRUE(blocked) << "seed " << seed << ": " << s1 << " -> " << s2
+                                         << " rejected, but (" << a.x << "," << a.y << ")-("
+                                         << b.x << "," << b.y << ") is clear";
+                }
+            }
+        }
+    }
+}